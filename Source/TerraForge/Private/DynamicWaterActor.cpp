@@ -2,6 +2,7 @@
 // Dynamic Water Actor Implementation
 
 #include "DynamicWaterActor.h"
+#include "TerraForgeStats.h"
 
 ADynamicWaterActor::ADynamicWaterActor()
 {
@@ -22,6 +23,14 @@ void ADynamicWaterActor::BeginPlay()
 	GenerateWaterMesh();
 }
 
+void ADynamicWaterActor::BeginDestroy()
+{
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_WaterMemory, MeshMemoryBytes);
+	MeshMemoryBytes = 0;
+
+	Super::BeginDestroy();
+}
+
 void ADynamicWaterActor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
@@ -51,6 +60,9 @@ void ADynamicWaterActor::GenerateWaterMesh()
 		return;
 	}
 
+	TERRAFORGE_STAGE_SCOPE(GenerateWaterMesh);
+	LLM_SCOPE_BYTAG(TerraForge);
+
 	// Clear existing mesh
 	WaterMesh->ClearAllMeshSections();
 
@@ -76,7 +88,15 @@ void ADynamicWaterActor::GenerateWaterMesh()
 	}
 
 	// Create the mesh section
-	WaterMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, VertexColors, Tangents, false);
+	{
+		TERRAFORGE_STAGE_SCOPE(WaterMeshSection);
+		WaterMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, VertexColors, Tangents, false);
+	}
+
+	const int64 NewMemoryBytes = GetMeshSectionMemoryBytes(WaterMesh);
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_WaterMemory, MeshMemoryBytes);
+	INC_MEMORY_STAT_BY(STAT_TerraForge_WaterMemory, NewMemoryBytes);
+	MeshMemoryBytes = NewMemoryBytes;
 
 	// Apply material if set
 	if (WaterMaterial)
@@ -87,6 +107,8 @@ void ADynamicWaterActor::GenerateWaterMesh()
 
 void ADynamicWaterActor::GenerateWaterVertices(TArray<FVector>& Vertices, TArray<FVector>& Normals, TArray<FVector2D>& UVs)
 {
+	TERRAFORGE_STAGE_SCOPE(WaterVertices);
+
 	Vertices.Empty();
 	Normals.Empty();
 	UVs.Empty();
@@ -127,6 +149,8 @@ void ADynamicWaterActor::GenerateWaterVertices(TArray<FVector>& Vertices, TArray
 
 void ADynamicWaterActor::GenerateWaterTriangles(TArray<int32>& Triangles)
 {
+	TERRAFORGE_STAGE_SCOPE(WaterTriangles);
+
 	Triangles.Empty();
 
 	const int32 NumQuads = Subdivisions * Subdivisions;
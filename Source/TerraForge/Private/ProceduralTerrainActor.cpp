@@ -3,16 +3,45 @@
 
 #include "ProceduralTerrainActor.h"
 #include "KismetProceduralMeshLibrary.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "Kismet/GameplayStatics.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Misc/Paths.h"
+#include "TerraForgeStats.h"
+
+/** Progressive thermal erosion of the single-mesh terrain. Slices run one at a time, so only the slice in flight touches the buffers */
+struct FTerrainThermalErosionJob
+{
+	// Settings of the build being relaxed
+	FTerrainBuildSettings Settings;
+
+	// Padded source grid after the last slice, sampled by the first slice, and the stencil's second buffer
+	TArray<float> Source;
+	TArray<float> Scratch;
+
+	// Steps still to run
+	int32 RemainingIterations = 0;
+};
 
 AProceduralTerrainActor::AProceduralTerrainActor()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	// Only ticks in quadtree mode, to follow the camera, and while progressive erosion runs
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Create procedural mesh component
 	ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("ProceduralMesh"));
 	RootComponent = ProceduralMesh;
 	ProceduralMesh->bUseAsyncCooking = true;
 
+	// Collision-only mesh, never drawn
+	CollisionMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("CollisionMesh"));
+	CollisionMesh->SetupAttachment(ProceduralMesh);
+	CollisionMesh->bUseAsyncCooking = true;
+	CollisionMesh->SetVisibility(false);
+	CollisionMesh->SetCastShadow(false);
+
 	// Create noise generator
 	NoiseGenerator = CreateDefaultSubobject<UNoiseGenerator>(TEXT("NoiseGenerator"));
 }
@@ -20,195 +49,628 @@ AProceduralTerrainActor::AProceduralTerrainActor()
 void AProceduralTerrainActor::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	SetActorTickEnabled(bUseQuadtreeLOD || ThermalJob.IsValid());
+
 	if (bAutoGenerate)
 	{
-		GenerateTerrain();
+		if (bGenerateAsync)
+		{
+			GenerateTerrainAsync();
+		}
+		else
+		{
+			GenerateTerrain();
+		}
 	}
 }
 
 void AProceduralTerrainActor::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	
+
 	if (bAutoGenerate)
 	{
-		GenerateTerrain();
+		if (bGenerateAsync)
+		{
+			GenerateTerrainAsync();
+		}
+		else
+		{
+			GenerateTerrain();
+		}
 	}
 }
 
+void AProceduralTerrainActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelPendingBuild();
+	StopThermalErosion();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AProceduralTerrainActor::BeginDestroy()
+{
+	CancelPendingBuild();
+
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_TerrainMemory, MeshMemoryBytes);
+	MeshMemoryBytes = 0;
+
+	Super::BeginDestroy();
+}
+
 void AProceduralTerrainActor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	// Reselect patches once the camera has moved far enough and the previous selection is applied
+	FVector CameraLocation;
+	if (bUseQuadtreeLOD && LODSections.Num() > 0 && !IsGeneratingAsync() && GetLODCameraLocation(CameraLocation)
+		&& FVector::DistSquared(CameraLocation, LastLODCamera) > FMath::Square(LODReselectDistance))
+	{
+		UpdateLOD(bGenerateAsync);
+	}
+
+	// One slice at a time, each starting once the previous one is on screen
+	if (ThermalJob.IsValid() && !IsGeneratingAsync())
+	{
+		StepThermalErosion();
+	}
+}
+
+bool AProceduralTerrainActor::ShouldTickIfViewportsOnly() const
+{
+	// Let progressive erosion finish in the editor viewport too
+	return ThermalJob.IsValid();
 }
 
 void AProceduralTerrainActor::GenerateTerrain()
 {
+	TERRAFORGE_STAGE_SCOPE(GenerateTerrain);
+	LLM_SCOPE_BYTAG(TerraForge);
+
 	if (!NoiseGenerator || !ProceduralMesh)
 	{
 		return;
 	}
 
-	// Set the seed for reproducible generation
-	NoiseGenerator->SetSeed(RandomSeed);
+	// Relaxing the previous terrain is pointless once it is replaced
+	StopThermalErosion();
 
-	// Clear existing mesh
-	ProceduralMesh->ClearAllMeshSections();
+	if (bUseQuadtreeLOD)
+	{
+		bLODCollisionValid = false;
+		UpdateLOD(false);
+		return;
+	}
 
-	// Generate mesh data
-	TArray<FVector> Vertices;
-	TArray<int32> Triangles;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
-	TArray<FColor> VertexColors;
-	TArray<FProcMeshTangent> Tangents;
+	// A synchronous build supersedes any async build still running
+	CancelPendingBuild();
 
-	// Generate vertices and UVs
-	GenerateVertices(Vertices, Normals, UVs);
+	const FTerrainBuildSettings Settings = MakeBuildSettings();
+	const TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> MeshData = GetMeshArena().AcquireMeshData();
+	FTerrainMeshBuilder::Build(Settings, *MeshData);
+	ApplyMeshData(*MeshData);
+	StartThermalErosion(Settings);
+}
 
-	// Generate triangles
-	GenerateTriangles(Triangles);
+void AProceduralTerrainActor::GenerateTerrainAsync()
+{
+	if (!NoiseGenerator || !ProceduralMesh)
+	{
+		return;
+	}
 
-	// Calculate proper normals
-	CalculateNormals(Vertices, Triangles, Normals);
+	// Relaxing the previous terrain is pointless once it is replaced
+	StopThermalErosion();
 
-	// Generate vertex colors based on height
-	VertexColors.SetNum(Vertices.Num());
-	for (int32 i = 0; i < Vertices.Num(); i++)
+	if (bUseQuadtreeLOD)
 	{
-		float HeightRatio = Vertices[i].Z / MaxHeight;
-		uint8 ColorValue = FMath::Clamp(static_cast<uint8>(HeightRatio * 255), 0, 255);
-		VertexColors[i] = FColor(ColorValue, ColorValue, ColorValue, 255);
+		bLODCollisionValid = false;
+		UpdateLOD(true);
+		return;
 	}
 
-	// Create the mesh section
-	ProceduralMesh->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, VertexColors, Tangents, true);
+	const FTerrainBuildSettings Settings = MakeBuildSettings();
+	TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> MeshData = GetMeshArena().AcquireMeshData();
+	RunAsyncBuild(
+		[Settings, MeshData](const std::atomic<bool>& CancelFlag)
+		{
+			return FTerrainMeshBuilder::Build(Settings, *MeshData, &CancelFlag);
+		},
+		[Settings, MeshData](AProceduralTerrainActor& Terrain)
+		{
+			Terrain.ApplyMeshData(*MeshData);
+			Terrain.StartThermalErosion(Settings);
+		});
+}
+
+void AProceduralTerrainActor::StartThermalErosion(const FTerrainBuildSettings& Settings)
+{
+	StopThermalErosion();
 
-	// Enable collision
-	ProceduralMesh->ContainsPhysicsTriMeshData(true);
+	const FTerraThermalErosionParams& Params = Settings.ThermalErosion;
+	if (!Params.bEnabled || !Params.bProgressive || Params.Iterations <= 0 || !FTerrainErosion::CanApplyThermal(Settings))
+	{
+		return;
+	}
+
+	ThermalJob = MakeShared<FTerrainThermalErosionJob, ESPMode::ThreadSafe>();
+	ThermalJob->Settings = Settings;
+	ThermalJob->RemainingIterations = Params.Iterations;
+	SetActorTickEnabled(true);
 }
 
-void AProceduralTerrainActor::ClearTerrain()
+void AProceduralTerrainActor::StopThermalErosion()
 {
-	if (ProceduralMesh)
+	if (ThermalJob.IsValid())
 	{
-		ProceduralMesh->ClearAllMeshSections();
+		// While the job runs, the only async build is its slice. Cancelling discards the slice's result;
+		// the slice keeps its own reference to the job and finishes within its budget
+		if (IsGeneratingAsync())
+		{
+			CancelPendingBuild();
+		}
+		ThermalJob.Reset();
+		SetActorTickEnabled(bUseQuadtreeLOD);
 	}
 }
 
-void AProceduralTerrainActor::GenerateVertices(TArray<FVector>& Vertices, TArray<FVector>& Normals, TArray<FVector2D>& UVs)
+void AProceduralTerrainActor::StepThermalErosion()
 {
-	Vertices.Empty();
-	Normals.Empty();
-	UVs.Empty();
+	const TSharedRef<FTerrainThermalErosionJob, ESPMode::ThreadSafe> Job = ThermalJob.ToSharedRef();
+	TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> MeshData = GetMeshArena().AcquireMeshData();
+	RunAsyncBuild(
+		[Job, MeshData](const std::atomic<bool>& CancelFlag)
+		{
+			const FTerrainBuildSettings& Settings = Job->Settings;
+			if (Job->Source.Num() == 0)
+			{
+				FTerrainErosion::SampleThermalSource(Settings, Job->Source);
+			}
+			const int32 NumSteps = FTerrainErosion::ApplyThermal(FTerrainErosion::MakeThermalSourceSettings(Settings), Job->Source, Job->Scratch, Job->RemainingIterations,
+				Settings.ThermalErosion.SliceMilliseconds * 0.001);
+
+			// A slice that could not run a single step never will, so it ends the job instead of relaunching forever
+			Job->RemainingIterations = NumSteps > 0 ? Job->RemainingIterations - NumSteps : 0;
+			if (CancelFlag.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
 
-	const int32 NumVertices = (TerrainWidth + 1) * (TerrainHeight + 1);
-	Vertices.Reserve(NumVertices);
-	Normals.Reserve(NumVertices);
-	UVs.Reserve(NumVertices);
+			// Relaxed heights have no analytic gradient
+			FTerrainErosion::CopyThermalResult(Settings, Job->Source, MeshData->Heights);
+			MeshData->HeightGradientX.Reset();
+			MeshData->HeightGradientY.Reset();
+			FTerrainMeshBuilder::CalculateNormals(Settings, MeshData->Heights, MeshData->Normals, MeshData->Tangents);
 
-	for (int32 Y = 0; Y <= TerrainHeight; Y++)
-	{
-		for (int32 X = 0; X <= TerrainWidth; X++)
+			// Triangles never change and collision is only built for the last slice
+			if (Job->RemainingIterations > 0)
+			{
+				FTerrainMeshBuilder::GenerateVertices(Settings, MeshData->Heights, MeshData->Normals, MeshData->Vertices, MeshData->UVs, MeshData->VertexColors);
+				return true;
+			}
+			return FTerrainMeshBuilder::BuildFromHeightsAndNormals(Settings, *MeshData, &CancelFlag);
+		},
+		[Job, MeshData](AProceduralTerrainActor& Terrain)
 		{
-			// Calculate world position
-			float WorldX = X * GridSize;
-			float WorldY = Y * GridSize;
+			if (Job->RemainingIterations > 0)
+			{
+				Terrain.ApplyThermalSlice(*MeshData);
+				return;
+			}
 
-			// Generate height using noise
-			float Height = 0.0f;
-			if (bUseSimplexNoise)
+			Terrain.ApplyMeshData(*MeshData);
+			if (Terrain.ThermalJob == Job)
 			{
-				Height = NoiseGenerator->GenerateSimplexNoise2D(WorldX, WorldY, NoiseScale);
-				// Simplex noise returns -1 to 1, convert to 0 to 1
-				Height = (Height + 1.0f) * 0.5f;
+				Terrain.StopThermalErosion();
 			}
-			else
+		});
+}
+
+void AProceduralTerrainActor::ApplyThermalSlice(const FTerrainMeshData& MeshData)
+{
+	FProcMeshSection* Section = ProceduralMesh->GetProcMeshSection(0);
+	if (!Section || LODSections.Num() > 0 || Section->ProcVertexBuffer.Num() != MeshData.Vertices.Num())
+	{
+		return;
+	}
+
+	TERRAFORGE_STAGE_SCOPE(MeshSection);
+	LLM_SCOPE_BYTAG(TerraForge);
+
+	// UpdateMeshSection recooks a collision section whenever its positions move. Full-mesh collision is cooked once, by the last slice
+	const bool bCollision = Section->bEnableCollision;
+	Section->bEnableCollision = false;
+	static const TArray<FVector2D> KeepUVs;
+	ProceduralMesh->UpdateMeshSection(0, MeshData.Vertices, MeshData.Normals, KeepUVs, MeshData.VertexColors, MeshData.Tangents);
+	Section->bEnableCollision = bCollision;
+}
+
+void AProceduralTerrainActor::RunAsyncBuild(TUniqueFunction<bool(const std::atomic<bool>&)>&& Build, TUniqueFunction<void(AProceduralTerrainActor&)>&& Apply)
+{
+	CancelPendingBuild();
+
+	const uint32 Serial = BuildSerial;
+	TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+	PendingCancelFlag = CancelFlag;
+
+	TWeakObjectPtr<AProceduralTerrainActor> WeakThis(this);
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, CancelFlag, Serial, Build = MoveTemp(Build), Apply = MoveTemp(Apply)]() mutable
+	{
+		if (!Build(*CancelFlag))
+		{
+			return;
+		}
+
+		// Mesh components may only be touched on the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, CancelFlag, Serial, Apply = MoveTemp(Apply)]() mutable
+		{
+			AProceduralTerrainActor* Terrain = WeakThis.Get();
+			if (!Terrain || CancelFlag->load() || Terrain->BuildSerial != Serial)
 			{
-				Height = NoiseGenerator->GeneratePerlinNoise2D(WorldX, WorldY, NoiseScale, Octaves, Persistence, Lacunarity);
+				return;
 			}
 
-			// Apply height multiplier
-			float WorldZ = Height * MaxHeight;
+			Terrain->PendingCancelFlag.Reset();
+			Apply(*Terrain);
+		});
+	});
+}
 
-			// Add vertex
-			Vertices.Add(FVector(WorldX, WorldY, WorldZ));
+bool AProceduralTerrainActor::IsGeneratingAsync() const
+{
+	return PendingCancelFlag.IsValid();
+}
+
+void AProceduralTerrainActor::CancelPendingBuild()
+{
+	// Bumping the serial also discards a finished build whose apply is already queued
+	BuildSerial++;
+
+	if (PendingCancelFlag.IsValid())
+	{
+		PendingCancelFlag->store(true);
+		PendingCancelFlag.Reset();
+	}
+}
 
-			// Add temporary normal (will be recalculated)
-			Normals.Add(FVector::UpVector);
+FTerrainBuildSettings AProceduralTerrainActor::MakeBuildSettings()
+{
+	// Set the seed for reproducible generation
+	NoiseGenerator->SetHashMode(NoiseHashMode);
+	NoiseGenerator->SetSeed(RandomSeed);
 
-			// Add UV coordinates
-			float U = static_cast<float>(X) / TerrainWidth;
-			float V = static_cast<float>(Y) / TerrainHeight;
-			UVs.Add(FVector2D(U, V));
+	FTerrainBuildSettings Settings;
+	Settings.Width = TerrainWidth;
+	Settings.Height = TerrainHeight;
+	Settings.GridSize = GridSize;
+	Settings.MaxHeight = MaxHeight;
+	Settings.NoiseParams.NoiseType = bUseSimplexNoise ? ETerraNoiseType::Simplex : ETerraNoiseType::Perlin;
+	Settings.NoiseParams.Scale = NoiseScale;
+	Settings.NoiseParams.Octaves = Octaves;
+	Settings.NoiseParams.Persistence = Persistence;
+	Settings.NoiseParams.Lacunarity = Lacunarity;
+	Settings.NoiseParams.FractalMode = FractalMode;
+	Settings.NoiseParams.WarpStrength = WarpStrength;
+
+	// Snapshot of the seeded noise, safe to read from any thread
+	Settings.Sampler = NoiseGenerator->GetSampler();
+	Settings.bParallel = bParallelGeneration;
+	Settings.bAnalyticNormals = bAnalyticNormals;
+	Settings.HydraulicErosion = HydraulicErosion;
+	Settings.ThermalErosion = ThermalErosion;
+	Settings.Biome = Biome;
+	Settings.CollisionMode = CollisionMode;
+	Settings.CollisionGridStep = CollisionGridStep;
+
+	// Reopened only when the path changes, so decoded tiles survive regeneration
+	if (HeightmapFile.FilePath != OpenedHeightmapPath)
+	{
+		OpenedHeightmapPath = HeightmapFile.FilePath;
+		Heightmap.Reset();
+		if (!OpenedHeightmapPath.IsEmpty())
+		{
+			Heightmap = FTerrainHeightmapFile::Open(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), OpenedHeightmapPath));
 		}
 	}
+	Settings.Heightmap = Heightmap;
+
+	// Compiled per build so graph edits show up on the next regeneration
+	if (HeightGraph && !Heightmap.IsValid())
+	{
+		FString Error;
+		Settings.HeightProgram = HeightGraph->Compile(RandomSeed, NoiseHashMode, &Error);
+		if (!Settings.HeightProgram.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ProceduralTerrainActor: HeightGraph %s does not compile, using the built-in noise. %s"), *HeightGraph->GetName(), *Error);
+		}
+	}
+	return Settings;
+}
+
+void AProceduralTerrainActor::ApplyMeshData(const FTerrainMeshData& MeshData)
+{
+	// Switching from the quadtree path
+	if (LODSections.Num() > 0)
+	{
+		ClearMeshSections();
+	}
+
+	// Create the mesh section, or update it in place when only heights changed.
+	// Includes collision cooking unless bUseAsyncCooking moves it off the game thread
+	{
+		TERRAFORGE_STAGE_SCOPE(MeshSection);
+		LLM_SCOPE_BYTAG(TerraForge);
+		ApplySection(0, MeshData, false);
+	}
+	ApplyCollision(MeshData.CollisionVertices, MeshData.CollisionTriangles);
+	bLODCollisionValid = false;
+
+	OnTerrainGenerated.Broadcast(this);
 }
 
-void AProceduralTerrainActor::GenerateTriangles(TArray<int32>& Triangles)
+void AProceduralTerrainActor::ClearTerrain()
 {
-	Triangles.Empty();
+	CancelPendingBuild();
+	StopThermalErosion();
 
-	const int32 NumQuads = TerrainWidth * TerrainHeight;
-	Triangles.Reserve(NumQuads * 6); // 2 triangles per quad, 3 indices per triangle
+	if (ProceduralMesh)
+	{
+		ClearMeshSections();
+		ApplyCollision(TArray<FVector>(), TArray<int32>());
+	}
+	bLODCollisionValid = false;
+}
 
-	for (int32 Y = 0; Y < TerrainHeight; Y++)
+FTerrainLODSettings AProceduralTerrainActor::MakeLODSettings()
+{
+	FTerrainLODSettings Settings;
+	Settings.Base = MakeBuildSettings();
+	Settings.PatchQuads = FMath::RoundUpToPowerOfTwo(FMath::Clamp(LODPatchQuads, 4, 128));
+	Settings.NumLevels = FMath::Clamp(LODLevels, 1, 10);
+	Settings.LODDistance = LODDistance;
+	Settings.SkirtDepth = LODSkirtDepth;
+	Settings.bMorph = bLODMorph;
+	Settings.MorphStart = LODMorphStart;
+	return Settings;
+}
+
+bool AProceduralTerrainActor::GetLODCameraLocation(FVector& OutLocation) const
+{
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	if (!CameraManager)
 	{
-		for (int32 X = 0; X < TerrainWidth; X++)
+		return false;
+	}
+
+	OutLocation = GetActorTransform().InverseTransformPosition(CameraManager->GetCameraLocation());
+	return true;
+}
+
+void AProceduralTerrainActor::UpdateLOD(bool bAsync)
+{
+	FTerrainLODSettings Settings = MakeLODSettings();
+
+	// Without a player camera (e.g. in the editor) look from above the terrain centre
+	FVector CameraLocation;
+	if (!GetLODCameraLocation(CameraLocation))
+	{
+		CameraLocation = FVector(TerrainWidth * GridSize * 0.5, TerrainHeight * GridSize * 0.5, MaxHeight);
+	}
+	LastLODCamera = CameraLocation;
+
+	TArray<FTerrainQuadtreeNode> SelectedNodes;
+	FTerrainQuadtree::SelectNodes(Settings, CameraLocation, SelectedNodes);
+
+	// Unchanged patches keep their sections; morphed patches depend on the camera and are always rebuilt
+	TArray<FTerrainQuadtreeNode> BuildNodes;
+	for (const FTerrainQuadtreeNode& Node : SelectedNodes)
+	{
+		if (Settings.bMorph || !LODSections.Contains(Node))
 		{
-			// Calculate vertex indices for this quad
-			int32 BottomLeft = Y * (TerrainWidth + 1) + X;
-			int32 BottomRight = BottomLeft + 1;
-			int32 TopLeft = (Y + 1) * (TerrainWidth + 1) + X;
-			int32 TopRight = TopLeft + 1;
+			BuildNodes.Add(Node);
+		}
+	}
+
+	// Collision covers the whole terrain at one resolution, so it is only rebuilt with the terrain, not on reselection
+	const bool bBuildCollision = !bLODCollisionValid;
 
-			// First triangle (bottom-left, top-left, top-right)
-			Triangles.Add(BottomLeft);
-			Triangles.Add(TopLeft);
-			Triangles.Add(TopRight);
+	if (!bAsync)
+	{
+		CancelPendingBuild();
 
-			// Second triangle (bottom-left, top-right, bottom-right)
-			Triangles.Add(BottomLeft);
-			Triangles.Add(TopRight);
-			Triangles.Add(BottomRight);
+		TArray<FTerrainMeshData> Patches;
+		FTerrainQuadtree::BuildPatches(Settings, BuildNodes, CameraLocation, Patches);
+		ApplyLODPatches(SelectedNodes, BuildNodes, Patches);
+
+		if (bBuildCollision)
+		{
+			TArray<FVector> CollisionVertices;
+			TArray<int32> CollisionTriangles;
+			if (Settings.Base.CollisionMode == ETerraCollisionMode::Simplified)
+			{
+				FTerrainMeshBuilder::GenerateCollision(Settings.Base, CollisionVertices, CollisionTriangles);
+			}
+			ApplyCollision(CollisionVertices, CollisionTriangles);
+			bLODCollisionValid = true;
 		}
+		return;
 	}
+
+	struct FLODBuild
+	{
+		TArray<FTerrainQuadtreeNode> SelectedNodes;
+		TArray<FTerrainQuadtreeNode> BuildNodes;
+		TArray<FTerrainMeshData> Patches;
+		TArray<FVector> CollisionVertices;
+		TArray<int32> CollisionTriangles;
+	};
+	TSharedRef<FLODBuild, ESPMode::ThreadSafe> LODBuild = MakeShared<FLODBuild, ESPMode::ThreadSafe>();
+	LODBuild->SelectedNodes = MoveTemp(SelectedNodes);
+	LODBuild->BuildNodes = MoveTemp(BuildNodes);
+
+	RunAsyncBuild(
+		[Settings = MoveTemp(Settings), CameraLocation, LODBuild, bBuildCollision](const std::atomic<bool>& CancelFlag)
+		{
+			if (bBuildCollision && Settings.Base.CollisionMode == ETerraCollisionMode::Simplified)
+			{
+				FTerrainMeshBuilder::GenerateCollision(Settings.Base, LODBuild->CollisionVertices, LODBuild->CollisionTriangles);
+			}
+			return FTerrainQuadtree::BuildPatches(Settings, LODBuild->BuildNodes, CameraLocation, LODBuild->Patches, &CancelFlag);
+		},
+		[LODBuild, bBuildCollision](AProceduralTerrainActor& Terrain)
+		{
+			Terrain.ApplyLODPatches(LODBuild->SelectedNodes, LODBuild->BuildNodes, LODBuild->Patches);
+			if (bBuildCollision)
+			{
+				Terrain.ApplyCollision(LODBuild->CollisionVertices, LODBuild->CollisionTriangles);
+				Terrain.bLODCollisionValid = true;
+			}
+		});
+}
+
+void AProceduralTerrainActor::ApplyLODPatches(const TArray<FTerrainQuadtreeNode>& SelectedNodes, const TArray<FTerrainQuadtreeNode>& BuiltNodes, const TArray<FTerrainMeshData>& BuiltPatches)
+{
+	// Switching from the single-mesh path
+	if (LODSections.Num() == 0)
+	{
+		ClearMeshSections();
+	}
+
+	// Free the sections of patches that are no longer selected
+	const TSet<FTerrainQuadtreeNode> Selected(SelectedNodes);
+	for (auto It = LODSections.CreateIterator(); It; ++It)
+	{
+		if (!Selected.Contains(It.Key()))
+		{
+			ReleaseSectionBuffers(It.Value());
+			ProceduralMesh->ClearMeshSection(It.Value());
+			FreeLODSections.Add(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	// Sections beyond 0 have no material slot of their own, so reuse the first one
+	UMaterialInterface* Material = ProceduralMesh->GetMaterial(0);
+
+	TERRAFORGE_STAGE_SCOPE(MeshSection);
+	LLM_SCOPE_BYTAG(TerraForge);
+	for (int32 Index = 0; Index < BuiltNodes.Num(); Index++)
+	{
+		int32 SectionIndex;
+		if (const int32* ExistingSection = LODSections.Find(BuiltNodes[Index]))
+		{
+			SectionIndex = *ExistingSection;
+		}
+		else
+		{
+			SectionIndex = FreeLODSections.Num() > 0 ? FreeLODSections.Pop(EAllowShrinking::No) : NumLODSectionSlots++;
+			LODSections.Add(BuiltNodes[Index], SectionIndex);
+		}
+
+		// Patches rebuilt in place, e.g. for morphing, keep their section and only get new vertex data
+		if (ApplySection(SectionIndex, BuiltPatches[Index], true) && Material)
+		{
+			ProceduralMesh->SetMaterial(SectionIndex, Material);
+		}
+	}
+
+	UpdateMeshMemoryStat();
+	OnTerrainGenerated.Broadcast(this);
+}
+
+void AProceduralTerrainActor::ResetLODSections()
+{
+	LODSections.Reset();
+	FreeLODSections.Reset();
+	NumLODSectionSlots = 0;
 }
 
-void AProceduralTerrainActor::CalculateNormals(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, TArray<FVector>& Normals)
+void AProceduralTerrainActor::ClearMeshSections()
 {
-	// Reset normals
-	Normals.SetNum(Vertices.Num());
-	for (int32 i = 0; i < Normals.Num(); i++)
+	for (int32 SectionIndex = 0; SectionIndex < ProceduralMesh->GetNumSections(); SectionIndex++)
 	{
-		Normals[i] = FVector::ZeroVector;
+		ReleaseSectionBuffers(SectionIndex);
 	}
+	ProceduralMesh->ClearAllMeshSections();
+	ResetLODSections();
+	SectionTopologies.Reset();
+}
 
-	// Accumulate face normals
-	for (int32 i = 0; i < Triangles.Num(); i += 3)
+bool AProceduralTerrainActor::ApplySection(int32 SectionIndex, const FTerrainMeshData& MeshData, bool bUpdateUVs)
+{
+	// From the build's settings snapshot; the live property may have changed since the build started
+	const bool bCollision = MeshData.CollisionMode == ETerraCollisionMode::FullMesh;
+
+	// Same shared index buffer and vertex count: the GPU buffers and scene proxy can be kept
+	const FProcMeshSection* Section = ProceduralMesh->GetProcMeshSection(SectionIndex);
+	if (Section && MeshData.Topology.IsValid() && SectionTopologies.IsValidIndex(SectionIndex) && SectionTopologies[SectionIndex] == MeshData.Topology
+		&& Section->ProcVertexBuffer.Num() == MeshData.Vertices.Num() && Section->bEnableCollision == bCollision)
 	{
-		int32 Index0 = Triangles[i];
-		int32 Index1 = Triangles[i + 1];
-		int32 Index2 = Triangles[i + 2];
+		// An empty array leaves that attribute as it is
+		static const TArray<FVector2D> KeepUVs;
+		ProceduralMesh->UpdateMeshSection(SectionIndex, MeshData.Vertices, MeshData.Normals, bUpdateUVs ? MeshData.UVs : KeepUVs, MeshData.VertexColors, MeshData.Tangents);
+		return false;
+	}
 
-		FVector V0 = Vertices[Index0];
-		FVector V1 = Vertices[Index1];
-		FVector V2 = Vertices[Index2];
+	// Packed into pooled buffers and swapped into the component, instead of CreateMeshSection copying every attribute
+	FTerrainMeshArena& Arena = GetMeshArena();
+	FProcMeshSection Packed = Arena.AcquireSection();
+	FTerrainMeshBuilder::PackSection(MeshData, Packed);
+	Packed.bEnableCollision = bCollision;
+	FTerrainMeshArena::InstallSection(ProceduralMesh, SectionIndex, Packed);
+	Arena.ReleaseSection(MoveTemp(Packed));
 
-		// Calculate face normal
-		FVector Edge1 = V1 - V0;
-		FVector Edge2 = V2 - V0;
-		FVector FaceNormal = FVector::CrossProduct(Edge1, Edge2).GetSafeNormal();
+	if (SectionTopologies.Num() <= SectionIndex)
+	{
+		SectionTopologies.SetNum(SectionIndex + 1);
+	}
+	SectionTopologies[SectionIndex] = MeshData.Topology;
+	return true;
+}
 
-		// Accumulate to vertex normals
-		Normals[Index0] += FaceNormal;
-		Normals[Index1] += FaceNormal;
-		Normals[Index2] += FaceNormal;
+void AProceduralTerrainActor::ReleaseSectionBuffers(int32 SectionIndex)
+{
+	if (FProcMeshSection* Section = ProceduralMesh->GetProcMeshSection(SectionIndex))
+	{
+		GetMeshArena().ReleaseSection(MoveTemp(*Section));
+		*Section = FProcMeshSection();
 	}
+}
 
-	// Normalize accumulated normals
-	for (int32 i = 0; i < Normals.Num(); i++)
+FTerrainMeshArena& AProceduralTerrainActor::GetMeshArena()
+{
+	if (!MeshArena.IsValid())
 	{
-		Normals[i] = Normals[i].GetSafeNormal();
+		// Enough for the live build, the one being applied and a few freed patch sections
+		MeshArena = MakeShared<FTerrainMeshArena, ESPMode::ThreadSafe>(8);
 	}
+	return *MeshArena;
+}
+
+void AProceduralTerrainActor::ApplyCollision(const TArray<FVector>& Vertices, const TArray<int32>& Triangles)
+{
+	if (Vertices.Num() == 0)
+	{
+		CollisionMesh->ClearAllMeshSections();
+	}
+	else
+	{
+		TERRAFORGE_STAGE_SCOPE(MeshSection);
+		CollisionMesh->CreateMeshSection(0, Vertices, Triangles, TArray<FVector>(), TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+	}
+
+	UpdateMeshMemoryStat();
+}
+
+void AProceduralTerrainActor::UpdateMeshMemoryStat()
+{
+	const int64 NewBytes = GetMeshSectionMemoryBytes(ProceduralMesh) + GetMeshSectionMemoryBytes(CollisionMesh);
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_TerrainMemory, MeshMemoryBytes);
+	INC_MEMORY_STAT_BY(STAT_TerraForge_TerrainMemory, NewBytes);
+	MeshMemoryBytes = NewBytes;
+
+	CSV_CUSTOM_STAT(TerraForge, TerrainMemoryMB, static_cast<float>(NewBytes) / (1024.0f * 1024.0f), ECsvCustomStatOp::Set);
 }
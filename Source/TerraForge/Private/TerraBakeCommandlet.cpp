@@ -0,0 +1,344 @@
+// TerraForge - Procedural World Generator
+// Terra Bake Commandlet Implementation
+
+#include "TerraBakeCommandlet.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+// Name of the single file written with -format=Tiled
+static const TCHAR* TiledFileName = TEXT("World.tfheights");
+
+static double BytesToMB(uint64 Bytes)
+{
+	return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+}
+
+/** Read -Key=Name into an enum by its UENUM name, leaving Value alone when the argument is absent */
+template <typename EnumType>
+static bool ParseEnumValue(const FString& Params, const TCHAR* Key, EnumType& Value)
+{
+	FString Name;
+	if (!FParse::Value(*Params, Key, Name))
+	{
+		return true;
+	}
+
+	const int64 Parsed = StaticEnum<EnumType>()->GetValueByNameString(Name);
+	if (Parsed == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBake: unknown value %s for -%s"), *Name, Key);
+		return false;
+	}
+	Value = static_cast<EnumType>(Parsed);
+	return true;
+}
+
+/** Buffers one worker reuses for every tile it bakes */
+struct FTerraBakeTaskContext
+{
+	TArray<float> Heights;
+	TArray<float> GradientX;
+	TArray<float> GradientY;
+	TArray<uint16> Samples;
+
+	float MinHeight = TNumericLimits<float>::Max();
+	float MaxHeight = TNumericLimits<float>::Lowest();
+	int32 NumFailed = 0;
+};
+
+UTerraBakeCommandlet::UTerraBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Bakes a TerraForge world into tiled 16-bit heightmaps and a JSON manifest on all cores");
+	HelpUsage = TEXT("-run=TerraBake -nullrhi [-output=Dir] [-extent=16384] [-tilesize=512] [-seed=12345] [-noise=Perlin] [-fractal=FBM] [-hash=PermutationTable] [-scale=100] [-octaves=4] [-persistence=0.5] [-lacunarity=2] [-warp=1] [-gridsize=100] [-maxheight=2000] [-format=R16] [-codec=LZ4]");
+
+	// Same noise as a default AProceduralTerrainActor
+	NoiseParams.Scale = 100.0f;
+}
+
+bool UTerraBakeCommandlet::ParseSettings(const FString& Params)
+{
+	OutputDirectory = FPaths::ProjectSavedDir() / TEXT("TerraForge") / TEXT("Bake");
+	FParse::Value(*Params, TEXT("output="), OutputDirectory);
+	FParse::Value(*Params, TEXT("extent="), ExtentQuads);
+	FParse::Value(*Params, TEXT("tilesize="), TileQuads);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+	FParse::Value(*Params, TEXT("scale="), NoiseParams.Scale);
+	FParse::Value(*Params, TEXT("octaves="), NoiseParams.Octaves);
+	FParse::Value(*Params, TEXT("persistence="), NoiseParams.Persistence);
+	FParse::Value(*Params, TEXT("lacunarity="), NoiseParams.Lacunarity);
+	FParse::Value(*Params, TEXT("warp="), NoiseParams.WarpStrength);
+	FParse::Value(*Params, TEXT("gridsize="), GridSize);
+	FParse::Value(*Params, TEXT("maxheight="), MaxHeight);
+
+	if (!ParseEnumValue(Params, TEXT("noise="), NoiseParams.NoiseType)
+		|| !ParseEnumValue(Params, TEXT("fractal="), NoiseParams.FractalMode)
+		|| !ParseEnumValue(Params, TEXT("hash="), HashMode)
+		|| !ParseEnumValue(Params, TEXT("codec="), Codec))
+	{
+		return false;
+	}
+
+	FString Format = TEXT("R16");
+	FParse::Value(*Params, TEXT("format="), Format);
+	if (Format != TEXT("R16") && Format != TEXT("Tiled"))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBake: unknown value %s for -format=, expected R16 or Tiled"), *Format);
+		return false;
+	}
+	bTiledFile = Format == TEXT("Tiled");
+
+	TileQuads = FMath::Max(TileQuads, 1);
+	ExtentQuads = FMath::Max(ExtentQuads, 1);
+	NoiseParams.Octaves = FMath::Clamp(NoiseParams.Octaves, 1, TerraMaxNoiseOctaves);
+	GridSize = FMath::Max(GridSize, UE_KINDA_SMALL_NUMBER);
+	Sampler = FTerraNoiseSampler(Seed, HashMode);
+	return true;
+}
+
+FTerrainBuildSettings UTerraBakeCommandlet::MakeTileSettings(int32 TileX, int32 TileY) const
+{
+	const double TileSize = static_cast<double>(TileQuads) * GridSize;
+
+	FTerrainBuildSettings Settings;
+	Settings.Width = TileQuads;
+	Settings.Height = TileQuads;
+	Settings.GridSize = GridSize;
+	Settings.MaxHeight = MaxHeight;
+	Settings.NoiseOrigin = FVector2D(TileX * TileSize, TileY * TileSize);
+	Settings.NoiseParams = NoiseParams;
+	Settings.Sampler = Sampler;
+
+	// Tiles already run in parallel with each other, so each one stays on its own worker
+	Settings.bParallel = false;
+	Settings.CollisionMode = ETerraCollisionMode::None;
+	return Settings;
+}
+
+FString UTerraBakeCommandlet::GetTileFileName(int32 TileX, int32 TileY)
+{
+	return FString::Printf(TEXT("Tile_X%d_Y%d.r16"), TileX, TileY);
+}
+
+int32 UTerraBakeCommandlet::Main(const FString& Params)
+{
+	if (!ParseSettings(Params))
+	{
+		return 1;
+	}
+
+	if (!IFileManager::Get().MakeDirectory(*OutputDirectory, true))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBake: could not create %s"), *OutputDirectory);
+		return 1;
+	}
+
+	const int32 NumTilesPerAxis = FMath::DivideAndRoundUp(ExtentQuads, TileQuads);
+	const int32 NumTiles = NumTilesPerAxis * NumTilesPerAxis;
+	const int32 NumColumns = TileQuads + 1;
+	const int32 ProgressInterval = FMath::Max(NumTiles / 10, 1);
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBake: baking %d x %d tiles of %d quads into %s"), NumTilesPerAxis, NumTilesPerAxis, TileQuads, *FPaths::ConvertRelativePathToFull(OutputDirectory));
+
+	FTerrainHeightmapWriter TiledWriter;
+	if (bTiledFile)
+	{
+		FTerrainHeightmapLayout Layout;
+		Layout.TileQuads = TileQuads;
+		Layout.TilesX = NumTilesPerAxis;
+		Layout.TilesY = NumTilesPerAxis;
+		Layout.GridSize = GridSize;
+		if (!TiledWriter.Open(OutputDirectory / TiledFileName, Layout, Codec))
+		{
+			UE_LOG(LogTemp, Error, TEXT("TerraBake: could not create %s"), *(OutputDirectory / TiledFileName));
+			return 1;
+		}
+	}
+
+	TArray<FTerraBakeTaskContext> Contexts;
+	std::atomic<int32> NumCompleted{ 0 };
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelForWithTaskContext(Contexts, NumTiles, [&](FTerraBakeTaskContext& Context, int32 TileIndex)
+	{
+		const int32 TileX = TileIndex % NumTilesPerAxis;
+		const int32 TileY = TileIndex / NumTilesPerAxis;
+		const FTerrainBuildSettings Settings = MakeTileSettings(TileX, TileY);
+		FTerrainMeshBuilder::GenerateHeights(Settings, Context.Heights, Context.GradientX, Context.GradientY);
+
+		// Drop the halo ring; the shared border samples come from the same noise positions in both tiles, so they match exactly
+		Context.Samples.SetNumUninitialized(NumColumns * NumColumns, EAllowShrinking::No);
+		for (int32 Y = 0; Y < NumColumns; Y++)
+		{
+			const float* SourceRow = &Context.Heights[FTerrainMeshBuilder::GetHaloIndex(Settings, 0, Y)];
+			uint16* DestRow = &Context.Samples[Y * NumColumns];
+			for (int32 X = 0; X < NumColumns; X++)
+			{
+				const float Height = SourceRow[X];
+				Context.MinHeight = FMath::Min(Context.MinHeight, Height);
+				Context.MaxHeight = FMath::Max(Context.MaxHeight, Height);
+				DestRow[X] = static_cast<uint16>(FMath::RoundToInt(FMath::Clamp(Height, 0.0f, 1.0f) * MAX_uint16));
+			}
+		}
+
+		// Native byte order, which is little-endian on every platform the editor runs on
+		if (bTiledFile)
+		{
+			if (!TiledWriter.WriteTile(TileX, TileY, Context.Samples))
+			{
+				UE_LOG(LogTemp, Error, TEXT("TerraBake: could not write tile %d, %d"), TileX, TileY);
+				Context.NumFailed++;
+			}
+		}
+		else
+		{
+			const FString Path = OutputDirectory / GetTileFileName(TileX, TileY);
+			const TArrayView64<const uint8> Bytes(reinterpret_cast<const uint8*>(Context.Samples.GetData()), Context.Samples.Num() * sizeof(uint16));
+			if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+			{
+				UE_LOG(LogTemp, Error, TEXT("TerraBake: could not write %s"), *Path);
+				Context.NumFailed++;
+			}
+		}
+
+		const int32 Completed = ++NumCompleted;
+		if (Completed % ProgressInterval == 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("TerraBake: %d / %d tiles"), Completed, NumTiles);
+		}
+	});
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	const uint64 PeakUsedPhysical = FPlatformMemory::GetStats().PeakUsedPhysical;
+
+	int32 NumFailed = 0;
+	float MinHeight = TNumericLimits<float>::Max();
+	float MaxHeightSeen = TNumericLimits<float>::Lowest();
+	for (const FTerraBakeTaskContext& Context : Contexts)
+	{
+		NumFailed += Context.NumFailed;
+		MinHeight = FMath::Min(MinHeight, Context.MinHeight);
+		MaxHeightSeen = FMath::Max(MaxHeightSeen, Context.MaxHeight);
+	}
+
+	const double TilesPerSecond = NumTiles / FMath::Max(Seconds, UE_DOUBLE_SMALL_NUMBER);
+	UE_LOG(LogTemp, Display, TEXT("TerraBake: %d tiles in %.2f s, %.1f tiles/sec, %.1f Msamples/sec, peak %.1f MB"),
+		NumTiles, Seconds, TilesPerSecond, TilesPerSecond * NumColumns * NumColumns / 1.0e6, BytesToMB(PeakUsedPhysical));
+
+	if (NumFailed > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBake: %d tiles could not be written"), NumFailed);
+		return 1;
+	}
+
+	const int64 TiledBytes = TiledWriter.GetTileBytes();
+	if (bTiledFile)
+	{
+		if (!TiledWriter.Close())
+		{
+			UE_LOG(LogTemp, Error, TEXT("TerraBake: could not finish %s"), *(OutputDirectory / TiledFileName));
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("TerraBake: %s holds %.1f MB of tiles, %.1f%% of the raw samples"), TiledFileName, BytesToMB(TiledBytes),
+			100.0 * TiledBytes / (static_cast<double>(NumTiles) * NumColumns * NumColumns * sizeof(uint16)));
+	}
+
+	// Clamping to the 16-bit range loses anything outside [0, 1]
+	if (MinHeight < 0.0f || MaxHeightSeen > 1.0f)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerraBake: heights span [%f, %f] and were clamped to [0, 1]"), MinHeight, MaxHeightSeen);
+	}
+
+	TSharedRef<FJsonObject> Manifest = MakeManifest(Seconds, PeakUsedPhysical);
+	Manifest->SetNumberField(TEXT("MinNormalizedHeight"), MinHeight);
+	Manifest->SetNumberField(TEXT("MaxNormalizedHeight"), MaxHeightSeen);
+	if (bTiledFile)
+	{
+		Manifest->SetNumberField(TEXT("StoredMB"), BytesToMB(TiledBytes));
+	}
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Manifest, Writer);
+
+	const FString ManifestPath = OutputDirectory / TEXT("Manifest.json");
+	if (!FFileHelper::SaveStringToFile(Json, *ManifestPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBake: could not write %s"), *ManifestPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBake: manifest written to %s"), *FPaths::ConvertRelativePathToFull(ManifestPath));
+	return 0;
+}
+
+TSharedRef<FJsonObject> UTerraBakeCommandlet::MakeManifest(double Seconds, uint64 PeakUsedPhysical) const
+{
+	const int32 NumTilesPerAxis = FMath::DivideAndRoundUp(ExtentQuads, TileQuads);
+
+	TSharedRef<FJsonObject> Noise = MakeShared<FJsonObject>();
+	Noise->SetStringField(TEXT("NoiseType"), StaticEnum<ETerraNoiseType>()->GetNameStringByValue(static_cast<int64>(NoiseParams.NoiseType)));
+	Noise->SetStringField(TEXT("FractalMode"), StaticEnum<ETerraFractalMode>()->GetNameStringByValue(static_cast<int64>(NoiseParams.FractalMode)));
+	Noise->SetNumberField(TEXT("Scale"), NoiseParams.Scale);
+	Noise->SetNumberField(TEXT("Octaves"), NoiseParams.Octaves);
+	Noise->SetNumberField(TEXT("Persistence"), NoiseParams.Persistence);
+	Noise->SetNumberField(TEXT("Lacunarity"), NoiseParams.Lacunarity);
+	Noise->SetNumberField(TEXT("WarpStrength"), NoiseParams.WarpStrength);
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("Version"), 1);
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetNumberField(TEXT("Seed"), Seed);
+	Root->SetStringField(TEXT("HashMode"), StaticEnum<ETerraNoiseHash>()->GetNameStringByValue(static_cast<int64>(HashMode)));
+	Root->SetObjectField(TEXT("Noise"), Noise);
+	Root->SetNumberField(TEXT("GridSize"), GridSize);
+	Root->SetNumberField(TEXT("HeightScale"), MaxHeight);
+	Root->SetStringField(TEXT("Format"), bTiledFile ? TEXT("Tiled") : TEXT("R16"));
+	Root->SetNumberField(TEXT("ExtentQuads"), NumTilesPerAxis * TileQuads);
+	Root->SetNumberField(TEXT("TileQuads"), TileQuads);
+	Root->SetNumberField(TEXT("TileSamples"), TileQuads + 1);
+	Root->SetNumberField(TEXT("TilesX"), NumTilesPerAxis);
+	Root->SetNumberField(TEXT("TilesY"), NumTilesPerAxis);
+
+	// The tiled file carries its own index; loose tiles are listed here
+	if (bTiledFile)
+	{
+		Root->SetStringField(TEXT("File"), TiledFileName);
+		Root->SetStringField(TEXT("Codec"), StaticEnum<ETerraHeightmapCodec>()->GetNameStringByValue(static_cast<int64>(Codec)));
+	}
+	else
+	{
+		TArray<TSharedPtr<FJsonValue>> Tiles;
+		Tiles.Reserve(NumTilesPerAxis * NumTilesPerAxis);
+		for (int32 TileY = 0; TileY < NumTilesPerAxis; TileY++)
+		{
+			for (int32 TileX = 0; TileX < NumTilesPerAxis; TileX++)
+			{
+				TSharedRef<FJsonObject> Tile = MakeShared<FJsonObject>();
+				Tile->SetNumberField(TEXT("X"), TileX);
+				Tile->SetNumberField(TEXT("Y"), TileY);
+				Tile->SetStringField(TEXT("File"), GetTileFileName(TileX, TileY));
+				Tiles.Add(MakeShared<FJsonValueObject>(Tile));
+			}
+		}
+		Root->SetArrayField(TEXT("Tiles"), Tiles);
+	}
+
+	Root->SetNumberField(TEXT("BakeSeconds"), Seconds);
+	Root->SetNumberField(TEXT("TilesPerSecond"), NumTilesPerAxis * NumTilesPerAxis / FMath::Max(Seconds, UE_DOUBLE_SMALL_NUMBER));
+	Root->SetNumberField(TEXT("PeakUsedPhysicalMB"), BytesToMB(PeakUsedPhysical));
+	return Root;
+}
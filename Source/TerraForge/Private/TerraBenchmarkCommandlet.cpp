@@ -0,0 +1,303 @@
+// TerraForge - Procedural World Generator
+// Terra Benchmark Commandlet Implementation
+
+#include "TerraBenchmarkCommandlet.h"
+#include "NoiseGenerator.h"
+#include "ProceduralTerrainActor.h"
+#include "TerrainMeshBuilder.h"
+#include "TerrainErosion.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Grid sizes timed end to end through AProceduralTerrainActor::GenerateTerrain
+static const int32 BenchmarkGridSizes[] = { 100, 250, 500 };
+
+// Grid size eroded by the erosion benchmark, large enough to split into many erosion tiles
+static constexpr int32 ErosionBenchmarkGridQuads = 512;
+
+// Noise parameters matching the terrain actor defaults
+static constexpr float BenchmarkNoiseScale = 100.0f;
+static constexpr float BenchmarkGridStep = 100.0f;
+
+static double BytesToMB(uint64 Bytes)
+{
+	return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+}
+
+/** Best of NumRuns timed loops over NumSamples grid positions, in nanoseconds per sample */
+template <typename SampleFunc>
+static double MeasureNanosecondsPerSample(int32 NumSamples, int32 NumRuns, SampleFunc&& Sample)
+{
+	double BestSeconds = TNumericLimits<double>::Max();
+	float Sum = 0.0f;
+
+	for (int32 Run = 0; Run < NumRuns; Run++)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumSamples; Index++)
+		{
+			// Walk a 1024 wide grid like the terrain does, so results include the same cache behaviour
+			const float X = static_cast<float>(Index & 1023) * BenchmarkGridStep;
+			const float Y = static_cast<float>(Index >> 10) * BenchmarkGridStep;
+			Sum += Sample(X, Y);
+		}
+		BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+	}
+
+	// Keeps the loop from being optimized away
+	static volatile float Sink;
+	Sink = Sum;
+
+	return BestSeconds * 1.0e9 / NumSamples;
+}
+
+static TSharedPtr<FJsonValue> MakeNoiseResult(const TCHAR* Name, int32 Octaves, double NanosecondsPerSample)
+{
+	TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("Name"), Name);
+	Result->SetNumberField(TEXT("Octaves"), Octaves);
+	Result->SetNumberField(TEXT("NsPerSample"), NanosecondsPerSample);
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBenchmark: %s (%d octaves) %.2f ns/sample"), Name, Octaves, NanosecondsPerSample);
+	return MakeShared<FJsonValueObject>(Result);
+}
+
+UTerraBenchmarkCommandlet::UTerraBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Benchmarks TerraForge noise sampling and terrain generation and writes the results as JSON");
+	HelpUsage = TEXT("-run=TerraBenchmark -nullrhi [-output=Path.json] [-samples=1000000] [-runs=5] [-terrainruns=3]");
+}
+
+int32 UTerraBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("TerraBenchmark.json");
+	FParse::Value(*Params, TEXT("output="), OutputPath);
+	FParse::Value(*Params, TEXT("samples="), NumSamples);
+	FParse::Value(*Params, TEXT("runs="), NumRuns);
+	FParse::Value(*Params, TEXT("terrainruns="), NumTerrainRuns);
+	NumSamples = FMath::Max(NumSamples, 1);
+	NumRuns = FMath::Max(NumRuns, 1);
+	NumTerrainRuns = FMath::Max(NumTerrainRuns, 1);
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("Version"), 1);
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("CPU"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Root->SetNumberField(TEXT("NumSamples"), NumSamples);
+	Root->SetNumberField(TEXT("NumRuns"), NumRuns);
+	Root->SetArrayField(TEXT("Noise"), RunNoiseBenchmarks());
+
+	TArray<TSharedPtr<FJsonValue>> TerrainResults;
+	for (int32 GridQuads : BenchmarkGridSizes)
+	{
+		if (TSharedPtr<FJsonObject> Result = RunTerrainBenchmark(GridQuads))
+		{
+			TerrainResults.Add(MakeShared<FJsonValueObject>(Result));
+		}
+	}
+	Root->SetArrayField(TEXT("Terrain"), TerrainResults);
+	Root->SetObjectField(TEXT("Erosion"), RunErosionBenchmark(ErosionBenchmarkGridQuads));
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBenchmark: could not write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBenchmark: results written to %s"), *FPaths::ConvertRelativePathToFull(OutputPath));
+	return 0;
+}
+
+TArray<TSharedPtr<FJsonValue>> UTerraBenchmarkCommandlet::RunNoiseBenchmarks() const
+{
+	UNoiseGenerator* NoiseGenerator = NewObject<UNoiseGenerator>();
+	NoiseGenerator->SetSeed(12345);
+
+	TArray<TSharedPtr<FJsonValue>> Results;
+	for (int32 Octaves = 1; Octaves <= 8; Octaves++)
+	{
+		const double Nanoseconds = MeasureNanosecondsPerSample(NumSamples, NumRuns, [NoiseGenerator, Octaves](float X, float Y)
+		{
+			return NoiseGenerator->GeneratePerlinNoise2D(X, Y, BenchmarkNoiseScale, Octaves, 0.5f, 2.0f);
+		});
+		Results.Add(MakeNoiseResult(TEXT("Perlin2D"), Octaves, Nanoseconds));
+	}
+
+	const double Perlin3DNanoseconds = MeasureNanosecondsPerSample(NumSamples, NumRuns, [NoiseGenerator](float X, float Y)
+	{
+		return NoiseGenerator->GeneratePerlinNoise3D(X, Y, 0.5f * (X + Y), BenchmarkNoiseScale);
+	});
+	Results.Add(MakeNoiseResult(TEXT("Perlin3D"), 1, Perlin3DNanoseconds));
+
+	const double SimplexNanoseconds = MeasureNanosecondsPerSample(NumSamples, NumRuns, [NoiseGenerator](float X, float Y)
+	{
+		return NoiseGenerator->GenerateSimplexNoise2D(X, Y, BenchmarkNoiseScale);
+	});
+	Results.Add(MakeNoiseResult(TEXT("Simplex2D"), 1, SimplexNanoseconds));
+
+	return Results;
+}
+
+TSharedPtr<FJsonObject> UTerraBenchmarkCommandlet::RunTerrainBenchmark(int32 GridQuads) const
+{
+	// A bare game world is enough to spawn the actor and register its mesh component under -nullrhi
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TerraBenchmarkWorld"));
+	if (!World)
+	{
+		UE_LOG(LogTemp, Error, TEXT("TerraBenchmark: could not create a world for the terrain benchmark"));
+		return nullptr;
+	}
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	// Deferred so the actor does not auto-generate with default settings before the sizes are set
+	AProceduralTerrainActor* Terrain = World->SpawnActorDeferred<AProceduralTerrainActor>(AProceduralTerrainActor::StaticClass(), FTransform::Identity);
+	Terrain->bAutoGenerate = false;
+	Terrain->TerrainWidth = GridQuads;
+	Terrain->TerrainHeight = GridQuads;
+	Terrain->FinishSpawning(FTransform::Identity);
+
+	const uint64 UsedPhysicalBefore = FPlatformMemory::GetStats().UsedPhysical;
+	double BestSeconds = TNumericLimits<double>::Max();
+	double TotalSeconds = 0.0;
+	for (int32 Run = 0; Run < NumTerrainRuns; Run++)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Terrain->GenerateTerrain();
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		BestSeconds = FMath::Min(BestSeconds, Seconds);
+		TotalSeconds += Seconds;
+	}
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	// Buffers the mesh component holds on to after the build
+	int64 MeshSectionBytes = 0;
+	int32 NumVertices = 0;
+	if (const FProcMeshSection* Section = Terrain->ProceduralMesh->GetProcMeshSection(0))
+	{
+		NumVertices = Section->ProcVertexBuffer.Num();
+		MeshSectionBytes = NumVertices * static_cast<int64>(sizeof(FProcMeshVertex)) + Section->ProcIndexBuffer.Num() * static_cast<int64>(sizeof(uint32));
+	}
+
+	TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetNumberField(TEXT("GridSize"), GridQuads);
+	Result->SetNumberField(TEXT("NumVertices"), NumVertices);
+	Result->SetNumberField(TEXT("NumRuns"), NumTerrainRuns);
+	Result->SetNumberField(TEXT("BestMs"), BestSeconds * 1000.0);
+	Result->SetNumberField(TEXT("MeanMs"), TotalSeconds * 1000.0 / NumTerrainRuns);
+	Result->SetNumberField(TEXT("MeshSectionMB"), MeshSectionBytes / (1024.0 * 1024.0));
+	Result->SetNumberField(TEXT("UsedPhysicalDeltaMB"), BytesToMB(MemoryStats.UsedPhysical) - BytesToMB(UsedPhysicalBefore));
+
+	// Process-wide high water mark; sizes run smallest first, so each entry includes its own peak
+	Result->SetNumberField(TEXT("PeakUsedPhysicalMB"), BytesToMB(MemoryStats.PeakUsedPhysical));
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBenchmark: GenerateTerrain %dx%d best %.2f ms, peak %.1f MB"), GridQuads, GridQuads, BestSeconds * 1000.0, BytesToMB(MemoryStats.PeakUsedPhysical));
+
+	Terrain->Destroy();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return Result;
+}
+
+TSharedPtr<FJsonObject> UTerraBenchmarkCommandlet::RunErosionBenchmark(int32 GridQuads) const
+{
+	FTerrainBuildSettings Settings;
+	Settings.Width = GridQuads;
+	Settings.Height = GridQuads;
+	Settings.NoiseParams.Scale = BenchmarkNoiseScale * 10.0f;
+	Settings.NoiseParams.Octaves = 6;
+	Settings.Sampler = FTerraNoiseSampler(12345);
+	Settings.HydraulicErosion.bEnabled = true;
+
+	TArray<float> SourceHeights;
+	TArray<float> GradientX;
+	TArray<float> GradientY;
+	FTerrainMeshBuilder::GenerateHeights(Settings, SourceHeights, GradientX, GradientY);
+
+	// Best of NumTerrainRuns passes over fresh copies of the same heights, each from an empty tile cache. Timed end to end,
+	// including the tiles reaching past the grid and the heights they sample, so the rate is in grid cells rather than droplets
+	auto Measure = [this, &Settings, &SourceHeights](bool bParallel, TArray<float>& OutHeights, int32& OutDroplets)
+	{
+		FTerrainBuildSettings RunSettings = Settings;
+		RunSettings.bParallel = bParallel;
+		double BestSeconds = TNumericLimits<double>::Max();
+		for (int32 Run = 0; Run < NumTerrainRuns; Run++)
+		{
+			OutHeights = SourceHeights;
+			FTerrainErosion::EmptyTileCache();
+			const double StartTime = FPlatformTime::Seconds();
+			OutDroplets = FTerrainErosion::ApplyHydraulic(RunSettings, OutHeights);
+			BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+		}
+		return static_cast<double>(SourceHeights.Num()) / FMath::Max(BestSeconds, UE_DOUBLE_SMALL_NUMBER);
+	};
+
+	TArray<float> SerialHeights;
+	TArray<float> ParallelHeights;
+	int32 NumDroplets = 0;
+	const double SerialCellsPerSecond = Measure(false, SerialHeights, NumDroplets);
+	const double ParallelCellsPerSecond = Measure(true, ParallelHeights, NumDroplets);
+	FTerrainErosion::EmptyTileCache();
+
+	// Thermal steps over the same heights, counted in cell updates
+	auto MeasureThermal = [this, &Settings, &SourceHeights](bool bParallel, TArray<float>& OutHeights)
+	{
+		FTerrainBuildSettings RunSettings = Settings;
+		RunSettings.bParallel = bParallel;
+		RunSettings.ThermalErosion.bEnabled = true;
+		TArray<float> Scratch;
+		double BestSeconds = TNumericLimits<double>::Max();
+		int32 NumIterations = 0;
+		for (int32 Run = 0; Run < NumTerrainRuns; Run++)
+		{
+			OutHeights = SourceHeights;
+			const double StartTime = FPlatformTime::Seconds();
+			NumIterations = FTerrainErosion::ApplyThermal(RunSettings, OutHeights, Scratch, RunSettings.ThermalErosion.Iterations);
+			BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+		}
+		return static_cast<double>(NumIterations) * SourceHeights.Num() / FMath::Max(BestSeconds, UE_DOUBLE_SMALL_NUMBER);
+	};
+
+	TArray<float> SerialThermalHeights;
+	TArray<float> ParallelThermalHeights;
+	const double SerialThermalCellsPerSecond = MeasureThermal(false, SerialThermalHeights);
+	const double ParallelThermalCellsPerSecond = MeasureThermal(true, ParallelThermalHeights);
+
+	// Erosion must not depend on the thread count
+	const bool bDeterministic = SerialHeights == ParallelHeights && SerialThermalHeights == ParallelThermalHeights;
+
+	TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetNumberField(TEXT("GridSize"), GridQuads);
+	Result->SetNumberField(TEXT("NumDroplets"), NumDroplets);
+	Result->SetNumberField(TEXT("DropletsPerGridCell"), static_cast<double>(NumDroplets) / SourceHeights.Num());
+	Result->SetNumberField(TEXT("SerialCellsPerSecond"), SerialCellsPerSecond);
+	Result->SetNumberField(TEXT("ParallelCellsPerSecond"), ParallelCellsPerSecond);
+	Result->SetNumberField(TEXT("SerialThermalCellsPerSecond"), SerialThermalCellsPerSecond);
+	Result->SetNumberField(TEXT("ParallelThermalCellsPerSecond"), ParallelThermalCellsPerSecond);
+	Result->SetBoolField(TEXT("Deterministic"), bDeterministic);
+
+	UE_LOG(LogTemp, Display, TEXT("TerraBenchmark: hydraulic erosion %dx%d %.2f M cells/sec serial, %.2f M cells/sec parallel, %.2f droplets per cell%s"), GridQuads, GridQuads,
+		SerialCellsPerSecond / 1.0e6, ParallelCellsPerSecond / 1.0e6, static_cast<double>(NumDroplets) / SourceHeights.Num(),
+		bDeterministic ? TEXT("") : TEXT(", results differ between thread counts"));
+	UE_LOG(LogTemp, Display, TEXT("TerraBenchmark: thermal erosion %dx%d %.1f M cells/sec serial, %.1f M cells/sec parallel"), GridQuads, GridQuads,
+		SerialThermalCellsPerSecond / 1.0e6, ParallelThermalCellsPerSecond / 1.0e6);
+	return Result;
+}
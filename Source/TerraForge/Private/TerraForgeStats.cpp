@@ -0,0 +1,48 @@
+// TerraForge - Procedural World Generator
+// TerraForge Stats Implementation
+
+#include "TerraForgeStats.h"
+#include "ProceduralMeshComponent.h"
+
+DEFINE_STAT(STAT_TerraForge_GenerateTerrain);
+DEFINE_STAT(STAT_TerraForge_Heights);
+DEFINE_STAT(STAT_TerraForge_Vertices);
+DEFINE_STAT(STAT_TerraForge_Triangles);
+DEFINE_STAT(STAT_TerraForge_HydraulicErosion);
+DEFINE_STAT(STAT_TerraForge_ThermalErosion);
+DEFINE_STAT(STAT_TerraForge_Normals);
+DEFINE_STAT(STAT_TerraForge_Collision);
+DEFINE_STAT(STAT_TerraForge_PackSection);
+DEFINE_STAT(STAT_TerraForge_LODPatches);
+DEFINE_STAT(STAT_TerraForge_MeshSection);
+DEFINE_STAT(STAT_TerraForge_ChunkCacheLoad);
+DEFINE_STAT(STAT_TerraForge_ChunkCacheSave);
+DEFINE_STAT(STAT_TerraForge_HeightmapTileLoad);
+DEFINE_STAT(STAT_TerraForge_ApplyChunks);
+DEFINE_STAT(STAT_TerraForge_GenerateWaterMesh);
+DEFINE_STAT(STAT_TerraForge_WaterVertices);
+DEFINE_STAT(STAT_TerraForge_WaterTriangles);
+DEFINE_STAT(STAT_TerraForge_WaterMeshSection);
+
+DEFINE_STAT(STAT_TerraForge_TerrainMemory);
+DEFINE_STAT(STAT_TerraForge_ChunkMemory);
+DEFINE_STAT(STAT_TerraForge_ArenaMemory);
+DEFINE_STAT(STAT_TerraForge_WaterMemory);
+DEFINE_STAT(STAT_TerraForge_ErosionDroplets);
+DEFINE_STAT(STAT_TerraForge_ErosionTilesReused);
+DEFINE_STAT(STAT_TerraForge_NumChunks);
+
+CSV_DEFINE_CATEGORY_MODULE(TERRAFORGE_API, TerraForge, true);
+
+LLM_DEFINE_TAG(TerraForge);
+
+int64 GetMeshSectionMemoryBytes(const UProceduralMeshComponent* Mesh)
+{
+	int64 Bytes = 0;
+	for (int32 SectionIndex = 0; SectionIndex < Mesh->GetNumSections(); SectionIndex++)
+	{
+		const FProcMeshSection* Section = const_cast<UProceduralMeshComponent*>(Mesh)->GetProcMeshSection(SectionIndex);
+		Bytes += Section->ProcVertexBuffer.Num() * static_cast<int64>(sizeof(FProcMeshVertex)) + Section->ProcIndexBuffer.Num() * static_cast<int64>(sizeof(uint32));
+	}
+	return Bytes;
+}
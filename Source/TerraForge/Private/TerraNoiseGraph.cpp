@@ -0,0 +1,407 @@
+// TerraForge - Procedural World Generator
+// Terra Noise Graph Implementation
+
+#include "TerraNoiseGraph.h"
+#if WITH_EDITOR
+#include "Misc/DataValidation.h"
+#endif
+
+/** Inputs an op reads. Noise nodes read InputA and InputB only when they are set */
+static int32 GetNumRequiredInputs(ETerraNoiseNodeOp Op)
+{
+	switch (Op)
+	{
+	case ETerraNoiseNodeOp::Noise:
+	case ETerraNoiseNodeOp::Constant:
+		return 0;
+	case ETerraNoiseNodeOp::Abs:
+	case ETerraNoiseNodeOp::Power:
+	case ETerraNoiseNodeOp::Remap:
+	case ETerraNoiseNodeOp::Clamp:
+		return 1;
+	case ETerraNoiseNodeOp::Lerp:
+	case ETerraNoiseNodeOp::Select:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+/** Node indices read by a node, -1 where unused */
+static void GetNodeInputs(const FTerraNoiseGraphNode& Node, int32 OutInputs[3])
+{
+	const int32 NumRequired = GetNumRequiredInputs(Node.Op);
+	const int32 Inputs[3] = { Node.InputA, Node.InputB, Node.InputC };
+	for (int32 Slot = 0; Slot < 3; Slot++)
+	{
+		const bool bUsed = (Node.Op == ETerraNoiseNodeOp::Noise) ? Slot < 2 : Slot < NumRequired;
+		OutInputs[Slot] = bUsed ? Inputs[Slot] : -1;
+	}
+}
+
+static FString DescribeNode(const TArray<FTerraNoiseGraphNode>& Nodes, int32 Index)
+{
+	return Nodes[Index].Name.IsNone() ? FString::Printf(TEXT("node %d"), Index) : FString::Printf(TEXT("node %d (%s)"), Index, *Nodes[Index].Name.ToString());
+}
+
+/** Depth-first walk from Index appending nodes after their inputs. State is 0 unvisited, 1 on the stack, 2 done */
+static bool OrderNodes(const TArray<FTerraNoiseGraphNode>& Nodes, int32 Index, TArray<uint8>& State, TArray<int32>& Order, FString& OutError)
+{
+	if (State[Index] == 2)
+	{
+		return true;
+	}
+	if (State[Index] == 1)
+	{
+		OutError = FString::Printf(TEXT("Noise graph has a cycle through %s"), *DescribeNode(Nodes, Index));
+		return false;
+	}
+	State[Index] = 1;
+
+	const FTerraNoiseGraphNode& Node = Nodes[Index];
+	const int32 NumRequired = GetNumRequiredInputs(Node.Op);
+	int32 Inputs[3];
+	GetNodeInputs(Node, Inputs);
+	for (int32 Slot = 0; Slot < 3; Slot++)
+	{
+		if (Inputs[Slot] == -1 && Slot >= NumRequired)
+		{
+			continue;
+		}
+		if (!Nodes.IsValidIndex(Inputs[Slot]))
+		{
+			OutError = FString::Printf(TEXT("Noise graph %s has missing or invalid input %c (%d)"), *DescribeNode(Nodes, Index), TEXT('A') + Slot, Inputs[Slot]);
+			return false;
+		}
+		if (!OrderNodes(Nodes, Inputs[Slot], State, Order, OutError))
+		{
+			return false;
+		}
+	}
+
+	State[Index] = 2;
+	Order.Add(Index);
+	return true;
+}
+
+TSharedPtr<const FTerraNoiseProgram, ESPMode::ThreadSafe> UTerraNoiseGraph::Compile(int32 Seed, ETerraNoiseHash HashMode, FString* OutError) const
+{
+	FString Error;
+	auto Fail = [&Error, OutError]()
+	{
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+		return TSharedPtr<const FTerraNoiseProgram, ESPMode::ThreadSafe>();
+	};
+
+	if (!Nodes.IsValidIndex(OutputNode))
+	{
+		Error = FString::Printf(TEXT("Noise graph output node %d does not exist"), OutputNode);
+		return Fail();
+	}
+
+	// Evaluation order: every node after its inputs, unreachable nodes dropped
+	TArray<uint8> State;
+	State.SetNumZeroed(Nodes.Num());
+	TArray<int32> Order;
+	if (!OrderNodes(Nodes, OutputNode, State, Order, Error))
+	{
+		return Fail();
+	}
+
+	// Position of the last instruction reading each node, so its register can be reused afterwards
+	TArray<int32> LastUse;
+	LastUse.Init(-1, Nodes.Num());
+	for (int32 Position = 0; Position < Order.Num(); Position++)
+	{
+		int32 Inputs[3];
+		GetNodeInputs(Nodes[Order[Position]], Inputs);
+		for (int32 Input : Inputs)
+		{
+			if (Input != -1)
+			{
+				LastUse[Input] = Position;
+			}
+		}
+	}
+	LastUse[OutputNode] = MAX_int32;
+
+	TSharedRef<FTerraNoiseProgram, ESPMode::ThreadSafe> Program = MakeShared<FTerraNoiseProgram, ESPMode::ThreadSafe>();
+	TArray<int32> NodeRegisters;
+	NodeRegisters.Init(-1, Nodes.Num());
+	TArray<int32> FreeRegisters;
+
+	for (int32 Position = 0; Position < Order.Num(); Position++)
+	{
+		const int32 NodeIndex = Order[Position];
+		const FTerraNoiseGraphNode& Node = Nodes[NodeIndex];
+
+		FTerraNoiseProgram::FInstruction Instruction;
+		Instruction.Op = Node.Op;
+		Instruction.Output = FreeRegisters.Num() > 0 ? FreeRegisters.Pop(EAllowShrinking::No) : Program->NumRegisters++;
+		Instruction.NoiseIndex = INDEX_NONE;
+		FMemory::Memzero(Instruction.Params);
+
+		int32 Inputs[3];
+		GetNodeInputs(Node, Inputs);
+		for (int32 Slot = 0; Slot < 3; Slot++)
+		{
+			Instruction.Inputs[Slot] = (Inputs[Slot] != -1) ? NodeRegisters[Inputs[Slot]] : -1;
+		}
+
+		switch (Node.Op)
+		{
+		case ETerraNoiseNodeOp::Noise:
+			Instruction.Params[0] = Node.WarpStrength;
+			Instruction.NoiseIndex = Program->Samplers.Add(FTerraNoiseSampler(Seed + Node.SeedOffset, HashMode));
+			Program->NoiseParams.Add(Node.Noise);
+			break;
+		case ETerraNoiseNodeOp::Constant:
+			Instruction.Params[0] = Node.Value;
+			break;
+		case ETerraNoiseNodeOp::Power:
+			Instruction.Params[0] = Node.Exponent;
+			break;
+		case ETerraNoiseNodeOp::Remap:
+		{
+			// Folded into Value * Scale + Offset
+			const double InputSize = Node.InputRange.Y - Node.InputRange.X;
+			const double Scale = FMath::IsNearlyZero(InputSize) ? 0.0 : (Node.OutputRange.Y - Node.OutputRange.X) / InputSize;
+			Instruction.Params[0] = static_cast<float>(Scale);
+			Instruction.Params[1] = static_cast<float>(Node.OutputRange.X - Node.InputRange.X * Scale);
+			break;
+		}
+		case ETerraNoiseNodeOp::Clamp:
+			Instruction.Params[0] = static_cast<float>(FMath::Min(Node.OutputRange.X, Node.OutputRange.Y));
+			Instruction.Params[1] = static_cast<float>(FMath::Max(Node.OutputRange.X, Node.OutputRange.Y));
+			break;
+		case ETerraNoiseNodeOp::Select:
+			Instruction.Params[0] = Node.Threshold;
+			Instruction.Params[1] = FMath::Max(Node.Falloff, 0.0f);
+			break;
+		default:
+			break;
+		}
+
+		Program->Instructions.Add(Instruction);
+		NodeRegisters[NodeIndex] = Instruction.Output;
+
+		// Inputs read for the last time can hold later results. The output was allocated first, so it never aliases them
+		for (int32 Slot = 0; Slot < 3; Slot++)
+		{
+			const int32 Input = Inputs[Slot];
+			const bool bRepeated = (Slot > 0 && Inputs[0] == Input) || (Slot > 1 && Inputs[1] == Input);
+			if (Input != -1 && !bRepeated && LastUse[Input] == Position)
+			{
+				FreeRegisters.Add(NodeRegisters[Input]);
+			}
+		}
+	}
+
+	Program->OutputRegister = NodeRegisters[OutputNode];
+	return Program;
+}
+
+float UTerraNoiseGraph::EvaluateAt(FVector2D Position, int32 Seed) const
+{
+	const TSharedPtr<const FTerraNoiseProgram, ESPMode::ThreadSafe> Program = Compile(Seed, ETerraNoiseHash::PermutationTable);
+	if (!Program.IsValid())
+	{
+		return 0.0f;
+	}
+
+	const float X = static_cast<float>(Position.X);
+	const float Y = static_cast<float>(Position.Y);
+	float Value;
+	Program->Evaluate(&X, &Y, 1, &Value);
+	return Value;
+}
+
+#if WITH_EDITOR
+EDataValidationResult UTerraNoiseGraph::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = Super::IsDataValid(Context);
+
+	FString Error;
+	if (!Compile(0, ETerraNoiseHash::PermutationTable, &Error).IsValid())
+	{
+		Context.AddError(FText::FromString(Error));
+		Result = EDataValidationResult::Invalid;
+	}
+	return Result;
+}
+#endif
+
+const float* FTerraNoiseProgram::EvaluateBlock(const float* X, const float* Y, int32 Count, float* Registers) const
+{
+	// Two registers past the program's own hold warped positions
+	float* WarpedX = Registers + NumRegisters * BlockSize;
+	float* WarpedY = WarpedX + BlockSize;
+
+	for (const FInstruction& Instruction : Instructions)
+	{
+		float* Out = Registers + Instruction.Output * BlockSize;
+		const float* A = (Instruction.Inputs[0] != -1) ? Registers + Instruction.Inputs[0] * BlockSize : nullptr;
+		const float* B = (Instruction.Inputs[1] != -1) ? Registers + Instruction.Inputs[1] * BlockSize : nullptr;
+		const float* C = (Instruction.Inputs[2] != -1) ? Registers + Instruction.Inputs[2] * BlockSize : nullptr;
+
+		switch (Instruction.Op)
+		{
+		case ETerraNoiseNodeOp::Noise:
+		{
+			const float* SampleX = X;
+			const float* SampleY = Y;
+			if (A || B)
+			{
+				const float Strength = Instruction.Params[0];
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					WarpedX[Index] = X[Index] + (A ? A[Index] * Strength : 0.0f);
+					WarpedY[Index] = Y[Index] + (B ? B[Index] * Strength : 0.0f);
+				}
+				SampleX = WarpedX;
+				SampleY = WarpedY;
+			}
+			Samplers[Instruction.NoiseIndex].FractalPoints(NoiseParams[Instruction.NoiseIndex], SampleX, SampleY, Count, Out);
+			break;
+		}
+		case ETerraNoiseNodeOp::Constant:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = Instruction.Params[0];
+			}
+			break;
+		case ETerraNoiseNodeOp::Add:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = A[Index] + B[Index];
+			}
+			break;
+		case ETerraNoiseNodeOp::Subtract:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = A[Index] - B[Index];
+			}
+			break;
+		case ETerraNoiseNodeOp::Multiply:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = A[Index] * B[Index];
+			}
+			break;
+		case ETerraNoiseNodeOp::Min:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = FMath::Min(A[Index], B[Index]);
+			}
+			break;
+		case ETerraNoiseNodeOp::Max:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = FMath::Max(A[Index], B[Index]);
+			}
+			break;
+		case ETerraNoiseNodeOp::Abs:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = FMath::Abs(A[Index]);
+			}
+			break;
+		case ETerraNoiseNodeOp::Power:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				const float Magnitude = FMath::Pow(FMath::Abs(A[Index]), Instruction.Params[0]);
+				Out[Index] = (A[Index] < 0.0f) ? -Magnitude : Magnitude;
+			}
+			break;
+		case ETerraNoiseNodeOp::Lerp:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = A[Index] + C[Index] * (B[Index] - A[Index]);
+			}
+			break;
+		case ETerraNoiseNodeOp::Remap:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = A[Index] * Instruction.Params[0] + Instruction.Params[1];
+			}
+			break;
+		case ETerraNoiseNodeOp::Clamp:
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Out[Index] = FMath::Clamp(A[Index], Instruction.Params[0], Instruction.Params[1]);
+			}
+			break;
+		case ETerraNoiseNodeOp::Select:
+		{
+			const float Threshold = Instruction.Params[0];
+			const float Falloff = Instruction.Params[1];
+			if (Falloff <= 0.0f)
+			{
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					Out[Index] = (C[Index] < Threshold) ? A[Index] : B[Index];
+				}
+			}
+			else
+			{
+				// Smoothstep across [Threshold - Falloff / 2, Threshold + Falloff / 2]
+				const float Start = Threshold - 0.5f * Falloff;
+				const float InvFalloff = 1.0f / Falloff;
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					const float Alpha = FMath::Clamp((C[Index] - Start) * InvFalloff, 0.0f, 1.0f);
+					const float Blend = Alpha * Alpha * (3.0f - 2.0f * Alpha);
+					Out[Index] = A[Index] + Blend * (B[Index] - A[Index]);
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	return Registers + OutputRegister * BlockSize;
+}
+
+void FTerraNoiseProgram::Evaluate(const float* X, const float* Y, int32 Count, float* Out) const
+{
+	check(IsValid());
+
+	TArray<float, TInlineAllocator<16 * BlockSize>> Registers;
+	Registers.SetNumUninitialized((NumRegisters + 2) * BlockSize);
+
+	for (int32 Start = 0; Start < Count; Start += BlockSize)
+	{
+		const int32 BlockCount = FMath::Min(BlockSize, Count - Start);
+		const float* Result = EvaluateBlock(X + Start, Y + Start, BlockCount, Registers.GetData());
+		FMemory::Memcpy(Out + Start, Result, BlockCount * sizeof(float));
+	}
+}
+
+void FTerraNoiseProgram::EvaluateGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, TArrayView<float> Out) const
+{
+	check(Out.Num() >= Width * NumRows);
+
+	// Positions computed the same way as FTerraNoiseSampler::NoiseGridRows, so a single noise node reproduces it exactly
+	TArray<float, TInlineAllocator<2 * 512>> Positions;
+	Positions.SetNumUninitialized(Width * 2);
+	float* ColumnX = Positions.GetData();
+	float* RowY = ColumnX + Width;
+
+	for (int32 Column = 0; Column < Width; Column++)
+	{
+		ColumnX[Column] = static_cast<float>(Origin.X + Column * Step.X);
+	}
+
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		const float Y = static_cast<float>(Origin.Y + (FirstRow + Row) * Step.Y);
+		for (int32 Column = 0; Column < Width; Column++)
+		{
+			RowY[Column] = Y;
+		}
+		Evaluate(ColumnX, RowY, Width, Out.GetData() + Row * Width);
+	}
+}
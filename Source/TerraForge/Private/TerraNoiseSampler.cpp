@@ -0,0 +1,1730 @@
+// TerraForge - Procedural World Generator
+// Thread-safe noise sampler implementation
+
+#include "TerraNoiseSampler.h"
+#include "Math/UnrealMathUtility.h"
+#include "Math/VectorRegister.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarTerraNoiseSIMD(
+	TEXT("TerraForge.Noise.SIMD"),
+	1,
+	TEXT("Kernels used by grid and batch noise evaluation.\n")
+	TEXT("0: scalar reference kernels\n")
+	TEXT("1: 4-wide vector kernels (default)"),
+	ECVF_Default);
+
+FTerraNoiseSampler::FTerraNoiseSampler()
+	: Seed(0)
+	, HashMode(ETerraNoiseHash::PermutationTable)
+{
+	// Standard Perlin noise permutation table
+	static const uint8 StandardPermutation[256] = {
+		151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
+		8,99,37,240,21,10,23,190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,
+		35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,74,165,71,
+		134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,
+		55,46,245,40,244,102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,
+		18,169,200,196,135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,
+		250,124,123,5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,
+		189,28,42,223,183,170,213,119,248,152,2,44,154,163,70,221,153,101,155,167,43,
+		172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,218,246,97,
+		228,251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,
+		107,49,192,214,31,181,199,106,157,184,84,204,176,115,121,50,45,127,4,150,254,
+		138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180
+	};
+
+	for (int32 i = 0; i < 256; i++)
+	{
+		Permutation[i] = StandardPermutation[i];
+		Permutation[256 + i] = StandardPermutation[i];
+	}
+}
+
+FTerraNoiseSampler::FTerraNoiseSampler(int32 InSeed, ETerraNoiseHash InHashMode)
+	: Seed(InSeed)
+	, HashMode(InHashMode)
+{
+	// Shuffle the permutation with the seed
+	FRandomStream RandomStream(Seed);
+	uint8 TempPerm[256];
+	
+	for (int32 i = 0; i < 256; i++)
+	{
+		TempPerm[i] = static_cast<uint8>(i);
+	}
+	
+	// Shuffle using Fisher-Yates algorithm
+	for (int32 i = 255; i > 0; i--)
+	{
+		int32 j = RandomStream.RandRange(0, i);
+		Swap(TempPerm[i], TempPerm[j]);
+	}
+	
+	// Duplicate for wrapping
+	for (int32 i = 0; i < 256; i++)
+	{
+		Permutation[i] = TempPerm[i];
+		Permutation[256 + i] = TempPerm[i];
+	}
+}
+
+FTerraNoiseSampler FTerraNoiseSampler::WithHashMode(ETerraNoiseHash InHashMode) const
+{
+	FTerraNoiseSampler Result(*this);
+	Result.HashMode = InHashMode;
+	return Result;
+}
+
+namespace TerraNoiseKernels
+{
+	/**
+	 * Hashes cell coordinates through the 512-entry permutation table.
+	 * Coordinates wrap every 256 cells; lookups match the original per-sample code exactly.
+	 */
+	struct FPermutationTable
+	{
+		const uint8* Perm;
+
+		FORCEINLINE void Perlin2DCorners(int32 X, int32 Y, int32& AA, int32& AB, int32& BA, int32& BB) const
+		{
+			const int32 Xi = X & 255;
+			const int32 Yi = Y & 255;
+			const int32 A = Perm[Xi] + Yi;
+			const int32 B = Perm[Xi + 1] + Yi;
+			AA = Perm[A];
+			AB = Perm[A + 1];
+			BA = Perm[B];
+			BB = Perm[B + 1];
+		}
+
+		/** Corner hashes indexed by corner bits (x | y << 1 | z << 2) */
+		FORCEINLINE void Perlin3DCorners(int32 X, int32 Y, int32 Z, int32 Out[8]) const
+		{
+			const int32 Xi = X & 255;
+			const int32 Yi = Y & 255;
+			const int32 Zi = Z & 255;
+			const int32 A = Perm[Xi] + Yi;
+			const int32 AA = Perm[A] + Zi;
+			const int32 AB = Perm[A + 1] + Zi;
+			const int32 B = Perm[Xi + 1] + Yi;
+			const int32 BA = Perm[B] + Zi;
+			const int32 BB = Perm[B + 1] + Zi;
+			Out[0] = Perm[AA];
+			Out[1] = Perm[BA];
+			Out[2] = Perm[AB];
+			Out[3] = Perm[BB];
+			Out[4] = Perm[AA + 1];
+			Out[5] = Perm[BA + 1];
+			Out[6] = Perm[AB + 1];
+			Out[7] = Perm[BB + 1];
+		}
+
+		FORCEINLINE int32 SimplexCorner(int32 X, int32 Y) const
+		{
+			return Perm[(X & 255) + Perm[Y & 255]];
+		}
+
+		// The table has no vector gather, so the vector versions hash each lane in turn
+
+		FORCEINLINE void Perlin2DCorners(const VectorRegister4Int& X, const VectorRegister4Int& Y, VectorRegister4Int& AA, VectorRegister4Int& AB, VectorRegister4Int& BA, VectorRegister4Int& BB) const
+		{
+			alignas(16) int32 XLanes[4];
+			alignas(16) int32 YLanes[4];
+			alignas(16) int32 Hashes[4][4];
+			VectorIntStoreAligned(X, XLanes);
+			VectorIntStoreAligned(Y, YLanes);
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				Perlin2DCorners(XLanes[Lane], YLanes[Lane], Hashes[0][Lane], Hashes[1][Lane], Hashes[2][Lane], Hashes[3][Lane]);
+			}
+			AA = VectorIntLoadAligned(Hashes[0]);
+			AB = VectorIntLoadAligned(Hashes[1]);
+			BA = VectorIntLoadAligned(Hashes[2]);
+			BB = VectorIntLoadAligned(Hashes[3]);
+		}
+
+		FORCEINLINE void Perlin3DCorners(const VectorRegister4Int& X, const VectorRegister4Int& Y, const VectorRegister4Int& Z, VectorRegister4Int Out[8]) const
+		{
+			alignas(16) int32 XLanes[4];
+			alignas(16) int32 YLanes[4];
+			alignas(16) int32 ZLanes[4];
+			alignas(16) int32 Hashes[8][4];
+			VectorIntStoreAligned(X, XLanes);
+			VectorIntStoreAligned(Y, YLanes);
+			VectorIntStoreAligned(Z, ZLanes);
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				int32 LaneHashes[8];
+				Perlin3DCorners(XLanes[Lane], YLanes[Lane], ZLanes[Lane], LaneHashes);
+				for (int32 Corner = 0; Corner < 8; Corner++)
+				{
+					Hashes[Corner][Lane] = LaneHashes[Corner];
+				}
+			}
+			for (int32 Corner = 0; Corner < 8; Corner++)
+			{
+				Out[Corner] = VectorIntLoadAligned(Hashes[Corner]);
+			}
+		}
+
+		FORCEINLINE VectorRegister4Int SimplexCorner(const VectorRegister4Int& X, const VectorRegister4Int& Y) const
+		{
+			alignas(16) int32 XLanes[4];
+			alignas(16) int32 YLanes[4];
+			alignas(16) int32 Hashes[4];
+			VectorIntStoreAligned(X, XLanes);
+			VectorIntStoreAligned(Y, YLanes);
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				Hashes[Lane] = SimplexCorner(XLanes[Lane], YLanes[Lane]);
+			}
+			return VectorIntLoadAligned(Hashes);
+		}
+	};
+
+	/**
+	 * Seeded arithmetic hash of the cell coordinates.
+	 * Needs no table and does not repeat, and vectorizes without gathers.
+	 */
+	struct FIntegerHash
+	{
+		uint32 Seed;
+
+		// Large odd multipliers spread neighbouring cells across the full 32 bits
+		static constexpr uint32 PrimeX = 0x8DA6B343u;
+		static constexpr uint32 PrimeY = 0xD8163841u;
+		static constexpr uint32 PrimeZ = 0xCB1AB31Fu;
+
+		/** Avalanche so the low bits used for gradient selection depend on every input bit */
+		static FORCEINLINE int32 Finalize(uint32 H)
+		{
+			H ^= H >> 16;
+			H *= 0x7FEB352Du;
+			H ^= H >> 15;
+			H *= 0x846CA68Bu;
+			H ^= H >> 16;
+			return static_cast<int32>(H);
+		}
+
+		static FORCEINLINE VectorRegister4Int Finalize(VectorRegister4Int H)
+		{
+			const VectorRegister4Int Mul0 = MakeVectorRegisterInt(0x7FEB352D, 0x7FEB352D, 0x7FEB352D, 0x7FEB352D);
+			const VectorRegister4Int Mul1 = MakeVectorRegisterInt(static_cast<int32>(0x846CA68Bu), static_cast<int32>(0x846CA68Bu), static_cast<int32>(0x846CA68Bu), static_cast<int32>(0x846CA68Bu));
+			H = VectorIntXor(H, VectorShiftRightImmLogical(H, 16));
+			H = VectorIntMultiply(H, Mul0);
+			H = VectorIntXor(H, VectorShiftRightImmLogical(H, 15));
+			H = VectorIntMultiply(H, Mul1);
+			H = VectorIntXor(H, VectorShiftRightImmLogical(H, 16));
+			return H;
+		}
+
+		static FORCEINLINE VectorRegister4Int Splat(uint32 Value)
+		{
+			const int32 Signed = static_cast<int32>(Value);
+			return MakeVectorRegisterInt(Signed, Signed, Signed, Signed);
+		}
+
+		FORCEINLINE int32 Hash2D(int32 X, int32 Y) const
+		{
+			return Finalize(Seed ^ (static_cast<uint32>(X) * PrimeX) ^ (static_cast<uint32>(Y) * PrimeY));
+		}
+
+		FORCEINLINE void Perlin2DCorners(int32 X, int32 Y, int32& AA, int32& AB, int32& BA, int32& BB) const
+		{
+			AA = Hash2D(X, Y);
+			AB = Hash2D(X, Y + 1);
+			BA = Hash2D(X + 1, Y);
+			BB = Hash2D(X + 1, Y + 1);
+		}
+
+		FORCEINLINE void Perlin3DCorners(int32 X, int32 Y, int32 Z, int32 Out[8]) const
+		{
+			for (int32 Corner = 0; Corner < 8; Corner++)
+			{
+				const uint32 CX = static_cast<uint32>(X + (Corner & 1));
+				const uint32 CY = static_cast<uint32>(Y + ((Corner >> 1) & 1));
+				const uint32 CZ = static_cast<uint32>(Z + ((Corner >> 2) & 1));
+				Out[Corner] = Finalize(Seed ^ (CX * PrimeX) ^ (CY * PrimeY) ^ (CZ * PrimeZ));
+			}
+		}
+
+		FORCEINLINE int32 SimplexCorner(int32 X, int32 Y) const
+		{
+			return Hash2D(X, Y);
+		}
+
+		FORCEINLINE void Perlin2DCorners(const VectorRegister4Int& X, const VectorRegister4Int& Y, VectorRegister4Int& AA, VectorRegister4Int& AB, VectorRegister4Int& BA, VectorRegister4Int& BB) const
+		{
+			// (X + 1) * Prime == X * Prime + Prime, so each axis needs one multiply
+			const VectorRegister4Int X0 = VectorIntXor(Splat(Seed), VectorIntMultiply(X, Splat(PrimeX)));
+			const VectorRegister4Int X1 = VectorIntXor(Splat(Seed), VectorIntAdd(VectorIntMultiply(X, Splat(PrimeX)), Splat(PrimeX)));
+			const VectorRegister4Int Y0 = VectorIntMultiply(Y, Splat(PrimeY));
+			const VectorRegister4Int Y1 = VectorIntAdd(Y0, Splat(PrimeY));
+			AA = Finalize(VectorIntXor(X0, Y0));
+			AB = Finalize(VectorIntXor(X0, Y1));
+			BA = Finalize(VectorIntXor(X1, Y0));
+			BB = Finalize(VectorIntXor(X1, Y1));
+		}
+
+		FORCEINLINE void Perlin3DCorners(const VectorRegister4Int& X, const VectorRegister4Int& Y, const VectorRegister4Int& Z, VectorRegister4Int Out[8]) const
+		{
+			const VectorRegister4Int XP[2] = { VectorIntMultiply(X, Splat(PrimeX)), VectorIntAdd(VectorIntMultiply(X, Splat(PrimeX)), Splat(PrimeX)) };
+			const VectorRegister4Int YP[2] = { VectorIntMultiply(Y, Splat(PrimeY)), VectorIntAdd(VectorIntMultiply(Y, Splat(PrimeY)), Splat(PrimeY)) };
+			const VectorRegister4Int ZP[2] = { VectorIntMultiply(Z, Splat(PrimeZ)), VectorIntAdd(VectorIntMultiply(Z, Splat(PrimeZ)), Splat(PrimeZ)) };
+			for (int32 Corner = 0; Corner < 8; Corner++)
+			{
+				const VectorRegister4Int H = VectorIntXor(VectorIntXor(Splat(Seed), XP[Corner & 1]), VectorIntXor(YP[(Corner >> 1) & 1], ZP[(Corner >> 2) & 1]));
+				Out[Corner] = Finalize(H);
+			}
+		}
+
+		FORCEINLINE VectorRegister4Int SimplexCorner(const VectorRegister4Int& X, const VectorRegister4Int& Y) const
+		{
+			return Finalize(VectorIntXor(Splat(Seed), VectorIntXor(VectorIntMultiply(X, Splat(PrimeX)), VectorIntMultiply(Y, Splat(PrimeY)))));
+		}
+	};
+
+	FORCEINLINE float Fade(float T)
+	{
+		// 6t^5 - 15t^4 + 10t^3
+		return T * T * T * (T * (T * 6.0f - 15.0f) + 10.0f);
+	}
+
+	FORCEINLINE float FadeDerivative(float T)
+	{
+		// 30t^4 - 60t^3 + 30t^2
+		return 30.0f * T * T * (T * (T - 2.0f) + 1.0f);
+	}
+
+	FORCEINLINE float Lerp(float T, float A, float B)
+	{
+		return A + T * (B - A);
+	}
+
+	FORCEINLINE float Gradient(int32 Hash, float X, float Y)
+	{
+		int32 H = Hash & 3;
+		float U = (H < 2) ? X : Y;
+		float V = (H < 2) ? Y : X;
+		return ((H & 1) ? -U : U) + ((H & 2) ? -V : V);
+	}
+
+	FORCEINLINE float Gradient3D(int32 Hash, float X, float Y, float Z)
+	{
+		int32 H = Hash & 15;
+		float U = (H < 8) ? X : Y;
+		float V = (H < 4) ? Y : ((H == 12 || H == 14) ? X : Z);
+		return ((H & 1) ? -U : U) + ((H & 2) ? -V : V);
+	}
+
+	FORCEINLINE float SimplexGradient(int32 Hash, float X, float Y)
+	{
+		int32 H = Hash & 7;
+		float U = (H < 4) ? X : Y;
+		float V = (H < 4) ? Y : X;
+		return ((H & 1) ? -U : U) + ((H & 2) ? -2.0f * V : 2.0f * V);
+	}
+
+	namespace Simd
+	{
+		// The vector helpers follow the scalar helpers' operation order so both kernels agree to within TerraNoiseVectorTolerance
+
+		FORCEINLINE VectorRegister4Float Fade(const VectorRegister4Float& T)
+		{
+			// 6t^5 - 15t^4 + 10t^3
+			const VectorRegister4Float Inner = VectorAdd(VectorMultiply(T, VectorSubtract(VectorMultiply(T, VectorSetFloat1(6.0f)), VectorSetFloat1(15.0f))), VectorSetFloat1(10.0f));
+			return VectorMultiply(VectorMultiply(VectorMultiply(T, T), T), Inner);
+		}
+
+		FORCEINLINE VectorRegister4Float FadeDerivative(const VectorRegister4Float& T)
+		{
+			// 30t^4 - 60t^3 + 30t^2
+			const VectorRegister4Float Inner = VectorAdd(VectorMultiply(T, VectorSubtract(T, VectorSetFloat1(2.0f))), VectorSetFloat1(1.0f));
+			return VectorMultiply(VectorMultiply(VectorSetFloat1(30.0f), VectorMultiply(T, T)), Inner);
+		}
+
+		FORCEINLINE VectorRegister4Float Lerp(const VectorRegister4Float& T, const VectorRegister4Float& A, const VectorRegister4Float& B)
+		{
+			return VectorAdd(A, VectorMultiply(T, VectorSubtract(B, A)));
+		}
+
+		/** All bits set in lanes where (Hash & Bits) != 0 */
+		FORCEINLINE VectorRegister4Float BitMask(const VectorRegister4Int& Hash, int32 Bits)
+		{
+			const VectorRegister4Int BitsVector = MakeVectorRegisterInt(Bits, Bits, Bits, Bits);
+			return VectorCastIntToFloat(VectorIntCompareEQ(VectorIntAnd(Hash, BitsVector), BitsVector));
+		}
+
+		/** Negate lanes where (Hash & Bit) != 0, Bit must be a single bit */
+		FORCEINLINE VectorRegister4Float NegateIf(const VectorRegister4Float& Value, const VectorRegister4Int& Hash, int32 Bit)
+		{
+			const VectorRegister4Float SignBit = VectorCastIntToFloat(MakeVectorRegisterInt(MIN_int32, MIN_int32, MIN_int32, MIN_int32));
+			return VectorBitwiseXor(Value, VectorBitwiseAnd(BitMask(Hash, Bit), SignBit));
+		}
+
+		/** Branch-free Gradient */
+		FORCEINLINE VectorRegister4Float Gradient(const VectorRegister4Int& Hash, const VectorRegister4Float& X, const VectorRegister4Float& Y)
+		{
+			// H & 2 swaps the axes; the second term is then negated as well
+			const VectorRegister4Float Swap = BitMask(Hash, 2);
+			const VectorRegister4Float U = VectorSelect(Swap, Y, X);
+			const VectorRegister4Float V = VectorSelect(Swap, VectorNegate(X), Y);
+			return VectorAdd(NegateIf(U, Hash, 1), V);
+		}
+
+		/** Branch-free Gradient3D */
+		FORCEINLINE VectorRegister4Float Gradient3D(const VectorRegister4Int& Hash, const VectorRegister4Float& X, const VectorRegister4Float& Y, const VectorRegister4Float& Z)
+		{
+			const VectorRegister4Int H = VectorIntAnd(Hash, MakeVectorRegisterInt(15, 15, 15, 15));
+			const VectorRegister4Float Below8 = VectorCastIntToFloat(VectorIntCompareEQ(VectorIntAnd(H, MakeVectorRegisterInt(8, 8, 8, 8)), MakeVectorRegisterInt(0, 0, 0, 0)));
+			const VectorRegister4Float Below4 = VectorCastIntToFloat(VectorIntCompareEQ(VectorIntAnd(H, MakeVectorRegisterInt(12, 12, 12, 12)), MakeVectorRegisterInt(0, 0, 0, 0)));
+			// H == 12 || H == 14 is the same as (H & 13) == 12
+			const VectorRegister4Float UseX = VectorCastIntToFloat(VectorIntCompareEQ(VectorIntAnd(H, MakeVectorRegisterInt(13, 13, 13, 13)), MakeVectorRegisterInt(12, 12, 12, 12)));
+
+			const VectorRegister4Float U = VectorSelect(Below8, X, Y);
+			const VectorRegister4Float V = VectorSelect(Below4, Y, VectorSelect(UseX, X, Z));
+			return VectorAdd(NegateIf(U, Hash, 1), NegateIf(V, Hash, 2));
+		}
+
+		/** Branch-free SimplexGradient */
+		FORCEINLINE VectorRegister4Float SimplexGradient(const VectorRegister4Int& Hash, const VectorRegister4Float& X, const VectorRegister4Float& Y)
+		{
+			const VectorRegister4Float Swap = BitMask(Hash, 4);
+			const VectorRegister4Float U = VectorSelect(Swap, Y, X);
+			const VectorRegister4Float V = VectorSelect(Swap, X, Y);
+			return VectorAdd(NegateIf(U, Hash, 1), NegateIf(VectorMultiply(VectorSetFloat1(2.0f), V), Hash, 2));
+		}
+
+		/** Attenuated contribution of one simplex corner, zero outside the corner's radius */
+		FORCEINLINE VectorRegister4Float SimplexCorner(const VectorRegister4Int& Hash, const VectorRegister4Float& X, const VectorRegister4Float& Y)
+		{
+			VectorRegister4Float T = VectorSubtract(VectorSubtract(VectorSetFloat1(0.5f), VectorMultiply(X, X)), VectorMultiply(Y, Y));
+			T = VectorMax(T, VectorZeroFloat());
+			T = VectorMultiply(T, T);
+			return VectorMultiply(VectorMultiply(T, T), SimplexGradient(Hash, X, Y));
+		}
+
+		/** SimplexCorner that also adds the contribution's derivatives to DX and DY */
+		FORCEINLINE VectorRegister4Float SimplexCornerWithDerivatives(const VectorRegister4Int& Hash, const VectorRegister4Float& X, const VectorRegister4Float& Y, VectorRegister4Float& DX, VectorRegister4Float& DY)
+		{
+			const VectorRegister4Float One = VectorSetFloat1(1.0f);
+			const VectorRegister4Float Zero = VectorZeroFloat();
+
+			VectorRegister4Float T = VectorSubtract(VectorSubtract(VectorSetFloat1(0.5f), VectorMultiply(X, X)), VectorMultiply(Y, Y));
+			T = VectorMax(T, Zero);
+			const VectorRegister4Float T2 = VectorMultiply(T, T);
+			const VectorRegister4Float T4 = VectorMultiply(T2, T2);
+			const VectorRegister4Float Gradient = SimplexGradient(Hash, X, Y);
+
+			// d/dx (t^4 * g) = t^4 * gx - 8 t^3 x g
+			const VectorRegister4Float Falloff = VectorMultiply(VectorMultiply(VectorSetFloat1(-8.0f), VectorMultiply(T2, T)), Gradient);
+			DX = VectorAdd(DX, VectorAdd(VectorMultiply(T4, SimplexGradient(Hash, One, Zero)), VectorMultiply(Falloff, X)));
+			DY = VectorAdd(DY, VectorAdd(VectorMultiply(T4, SimplexGradient(Hash, Zero, One)), VectorMultiply(Falloff, Y)));
+			return VectorMultiply(T4, Gradient);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluatePerlinPoints(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			// Calculate grid cell coordinates
+			const float FloorX = FMath::FloorToFloat(X[Index]);
+			const float FloorY = FMath::FloorToFloat(Y[Index]);
+
+			// Calculate relative position within grid cell
+			const float Xf = X[Index] - FloorX;
+			const float Yf = Y[Index] - FloorY;
+
+			// Fade curves
+			const float U = Fade(Xf);
+			const float V = Fade(Yf);
+
+			// Hash coordinates of the 4 square corners
+			int32 AA, AB, BA, BB;
+			Hash.Perlin2DCorners(static_cast<int32>(FloorX), static_cast<int32>(FloorY), AA, AB, BA, BB);
+
+			// Blend results from the 4 corners
+			const float X1 = Lerp(U, Gradient(AA, Xf, Yf), Gradient(BA, Xf - 1.0f, Yf));
+			const float X2 = Lerp(U, Gradient(AB, Xf, Yf - 1.0f), Gradient(BB, Xf - 1.0f, Yf - 1.0f));
+			Out[Index] = Lerp(V, X1, X2);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluatePerlin3DPoints(const HashType& Hash, const float* X, const float* Y, const float* Z, int32 Count, float* Out)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			// Calculate grid cell coordinates
+			const float FloorX = FMath::FloorToFloat(X[Index]);
+			const float FloorY = FMath::FloorToFloat(Y[Index]);
+			const float FloorZ = FMath::FloorToFloat(Z[Index]);
+
+			// Calculate relative position within grid cell
+			const float Xf = X[Index] - FloorX;
+			const float Yf = Y[Index] - FloorY;
+			const float Zf = Z[Index] - FloorZ;
+
+			// Fade curves
+			const float U = Fade(Xf);
+			const float V = Fade(Yf);
+			const float W = Fade(Zf);
+
+			// Hash coordinates of the 8 cube corners
+			int32 H[8];
+			Hash.Perlin3DCorners(static_cast<int32>(FloorX), static_cast<int32>(FloorY), static_cast<int32>(FloorZ), H);
+
+			// Blend results from the 8 corners
+			float X1 = Lerp(U, Gradient3D(H[0], Xf, Yf, Zf), Gradient3D(H[1], Xf - 1.0f, Yf, Zf));
+			float X2 = Lerp(U, Gradient3D(H[2], Xf, Yf - 1.0f, Zf), Gradient3D(H[3], Xf - 1.0f, Yf - 1.0f, Zf));
+			const float Y1 = Lerp(V, X1, X2);
+
+			X1 = Lerp(U, Gradient3D(H[4], Xf, Yf, Zf - 1.0f), Gradient3D(H[5], Xf - 1.0f, Yf, Zf - 1.0f));
+			X2 = Lerp(U, Gradient3D(H[6], Xf, Yf - 1.0f, Zf - 1.0f), Gradient3D(H[7], Xf - 1.0f, Yf - 1.0f, Zf - 1.0f));
+			const float Y2 = Lerp(V, X1, X2);
+
+			Out[Index] = Lerp(W, Y1, Y2);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluateSimplexPoints(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out)
+	{
+		// Skew factors for 2D
+		const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+		const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			// Skew the input space
+			const float S = (X[Index] + Y[Index]) * F2;
+			const int32 I = FMath::FloorToInt(X[Index] + S);
+			const int32 J = FMath::FloorToInt(Y[Index] + S);
+
+			const float T = (I + J) * G2;
+			const float X0 = X[Index] - (I - T);
+			const float Y0 = Y[Index] - (J - T);
+
+			// Determine which simplex we're in
+			const int32 I1 = (X0 > Y0) ? 1 : 0;
+			const int32 J1 = 1 - I1;
+
+			// Offsets for middle and last corners
+			const float X1 = X0 - I1 + G2;
+			const float Y1 = Y0 - J1 + G2;
+			const float X2 = X0 - 1.0f + 2.0f * G2;
+			const float Y2 = Y0 - 1.0f + 2.0f * G2;
+
+			// Calculate contribution from three corners
+			float Total = 0.0f;
+
+			float T0 = 0.5f - X0 * X0 - Y0 * Y0;
+			if (T0 >= 0.0f)
+			{
+				T0 *= T0;
+				Total += T0 * T0 * SimplexGradient(Hash.SimplexCorner(I, J), X0, Y0);
+			}
+
+			float T1 = 0.5f - X1 * X1 - Y1 * Y1;
+			if (T1 >= 0.0f)
+			{
+				T1 *= T1;
+				Total += T1 * T1 * SimplexGradient(Hash.SimplexCorner(I + I1, J + J1), X1, Y1);
+			}
+
+			float T2 = 0.5f - X2 * X2 - Y2 * Y2;
+			if (T2 >= 0.0f)
+			{
+				T2 *= T2;
+				Total += T2 * T2 * SimplexGradient(Hash.SimplexCorner(I + 1, J + 1), X2, Y2);
+			}
+
+			// Sum contributions and scale to [-1, 1]
+			Out[Index] = 70.0f * Total;
+		}
+	}
+
+	template<typename HashType>
+	void EvaluatePerlinPointsVector(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out)
+	{
+		const VectorRegister4Float One = VectorSetFloat1(1.0f);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float PX = VectorLoad(X + Index);
+			const VectorRegister4Float PY = VectorLoad(Y + Index);
+			const VectorRegister4Float FloorX = VectorFloor(PX);
+			const VectorRegister4Float FloorY = VectorFloor(PY);
+			const VectorRegister4Float Xf = VectorSubtract(PX, FloorX);
+			const VectorRegister4Float Yf = VectorSubtract(PY, FloorY);
+
+			VectorRegister4Int AA, AB, BA, BB;
+			Hash.Perlin2DCorners(VectorFloatToInt(FloorX), VectorFloatToInt(FloorY), AA, AB, BA, BB);
+
+			const VectorRegister4Float Xf1 = VectorSubtract(Xf, One);
+			const VectorRegister4Float Yf1 = VectorSubtract(Yf, One);
+			const VectorRegister4Float U = Simd::Fade(Xf);
+			const VectorRegister4Float V = Simd::Fade(Yf);
+
+			const VectorRegister4Float X1 = Simd::Lerp(U, Simd::Gradient(AA, Xf, Yf), Simd::Gradient(BA, Xf1, Yf));
+			const VectorRegister4Float X2 = Simd::Lerp(U, Simd::Gradient(AB, Xf, Yf1), Simd::Gradient(BB, Xf1, Yf1));
+			VectorStore(Simd::Lerp(V, X1, X2), Out + Index);
+		}
+
+		if (Index < Count)
+		{
+			EvaluatePerlinPoints(Hash, X + Index, Y + Index, Count - Index, Out + Index);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluatePerlin3DPointsVector(const HashType& Hash, const float* X, const float* Y, const float* Z, int32 Count, float* Out)
+	{
+		const VectorRegister4Float One = VectorSetFloat1(1.0f);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float PX = VectorLoad(X + Index);
+			const VectorRegister4Float PY = VectorLoad(Y + Index);
+			const VectorRegister4Float PZ = VectorLoad(Z + Index);
+			const VectorRegister4Float FloorX = VectorFloor(PX);
+			const VectorRegister4Float FloorY = VectorFloor(PY);
+			const VectorRegister4Float FloorZ = VectorFloor(PZ);
+			const VectorRegister4Float Xf = VectorSubtract(PX, FloorX);
+			const VectorRegister4Float Yf = VectorSubtract(PY, FloorY);
+			const VectorRegister4Float Zf = VectorSubtract(PZ, FloorZ);
+
+			VectorRegister4Int H[8];
+			Hash.Perlin3DCorners(VectorFloatToInt(FloorX), VectorFloatToInt(FloorY), VectorFloatToInt(FloorZ), H);
+
+			const VectorRegister4Float Xf1 = VectorSubtract(Xf, One);
+			const VectorRegister4Float Yf1 = VectorSubtract(Yf, One);
+			const VectorRegister4Float Zf1 = VectorSubtract(Zf, One);
+			const VectorRegister4Float U = Simd::Fade(Xf);
+			const VectorRegister4Float V = Simd::Fade(Yf);
+			const VectorRegister4Float W = Simd::Fade(Zf);
+
+			VectorRegister4Float X1 = Simd::Lerp(U, Simd::Gradient3D(H[0], Xf, Yf, Zf), Simd::Gradient3D(H[1], Xf1, Yf, Zf));
+			VectorRegister4Float X2 = Simd::Lerp(U, Simd::Gradient3D(H[2], Xf, Yf1, Zf), Simd::Gradient3D(H[3], Xf1, Yf1, Zf));
+			const VectorRegister4Float Y1 = Simd::Lerp(V, X1, X2);
+
+			X1 = Simd::Lerp(U, Simd::Gradient3D(H[4], Xf, Yf, Zf1), Simd::Gradient3D(H[5], Xf1, Yf, Zf1));
+			X2 = Simd::Lerp(U, Simd::Gradient3D(H[6], Xf, Yf1, Zf1), Simd::Gradient3D(H[7], Xf1, Yf1, Zf1));
+			const VectorRegister4Float Y2 = Simd::Lerp(V, X1, X2);
+
+			VectorStore(Simd::Lerp(W, Y1, Y2), Out + Index);
+		}
+
+		if (Index < Count)
+		{
+			EvaluatePerlin3DPoints(Hash, X + Index, Y + Index, Z + Index, Count - Index, Out + Index);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluateSimplexPointsVector(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out)
+	{
+		const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+		const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+		const VectorRegister4Float F2Vector = VectorSetFloat1(F2);
+		const VectorRegister4Float G2Vector = VectorSetFloat1(G2);
+		const VectorRegister4Float TwoG2Vector = VectorSetFloat1(2.0f * G2);
+		const VectorRegister4Float One = VectorSetFloat1(1.0f);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Int IntOne = MakeVectorRegisterInt(1, 1, 1, 1);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float PX = VectorLoad(X + Index);
+			const VectorRegister4Float PY = VectorLoad(Y + Index);
+
+			// Skew the input space
+			const VectorRegister4Float S = VectorMultiply(VectorAdd(PX, PY), F2Vector);
+			const VectorRegister4Float I = VectorFloor(VectorAdd(PX, S));
+			const VectorRegister4Float J = VectorFloor(VectorAdd(PY, S));
+
+			const VectorRegister4Float T = VectorMultiply(VectorAdd(I, J), G2Vector);
+			const VectorRegister4Float X0 = VectorSubtract(PX, VectorSubtract(I, T));
+			const VectorRegister4Float Y0 = VectorSubtract(PY, VectorSubtract(J, T));
+
+			// Lower or upper triangle of the skewed cell
+			const VectorRegister4Float Lower = VectorCompareGT(X0, Y0);
+			const VectorRegister4Float I1 = VectorSelect(Lower, One, Zero);
+			const VectorRegister4Float J1 = VectorSelect(Lower, Zero, One);
+
+			const VectorRegister4Float X1 = VectorAdd(VectorSubtract(X0, I1), G2Vector);
+			const VectorRegister4Float Y1 = VectorAdd(VectorSubtract(Y0, J1), G2Vector);
+			const VectorRegister4Float X2 = VectorAdd(VectorSubtract(X0, One), TwoG2Vector);
+			const VectorRegister4Float Y2 = VectorAdd(VectorSubtract(Y0, One), TwoG2Vector);
+
+			const VectorRegister4Int CellI = VectorFloatToInt(I);
+			const VectorRegister4Int CellJ = VectorFloatToInt(J);
+			const VectorRegister4Int Hash0 = Hash.SimplexCorner(CellI, CellJ);
+			const VectorRegister4Int Hash1 = Hash.SimplexCorner(VectorIntAdd(CellI, VectorFloatToInt(I1)), VectorIntAdd(CellJ, VectorFloatToInt(J1)));
+			const VectorRegister4Int Hash2 = Hash.SimplexCorner(VectorIntAdd(CellI, IntOne), VectorIntAdd(CellJ, IntOne));
+
+			const VectorRegister4Float N0 = Simd::SimplexCorner(Hash0, X0, Y0);
+			const VectorRegister4Float N1 = Simd::SimplexCorner(Hash1, X1, Y1);
+			const VectorRegister4Float N2 = Simd::SimplexCorner(Hash2, X2, Y2);
+
+			VectorStore(VectorMultiply(VectorSetFloat1(70.0f), VectorAdd(VectorAdd(N0, N1), N2)), Out + Index);
+		}
+
+		if (Index < Count)
+		{
+			EvaluateSimplexPoints(Hash, X + Index, Y + Index, Count - Index, Out + Index);
+		}
+	}
+
+	// Derivative kernels. Gradients are linear in the offset, so a corner's gradient vector is Gradient(Hash, 1, 0), Gradient(Hash, 0, 1)
+
+	template<typename HashType>
+	void EvaluatePerlinPointsWithDerivatives(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			const float FloorX = FMath::FloorToFloat(X[Index]);
+			const float FloorY = FMath::FloorToFloat(Y[Index]);
+			const float Xf = X[Index] - FloorX;
+			const float Yf = Y[Index] - FloorY;
+			const float U = Fade(Xf);
+			const float V = Fade(Yf);
+
+			int32 AA, AB, BA, BB;
+			Hash.Perlin2DCorners(static_cast<int32>(FloorX), static_cast<int32>(FloorY), AA, AB, BA, BB);
+
+			const float A = Gradient(AA, Xf, Yf);
+			const float B = Gradient(BA, Xf - 1.0f, Yf);
+			const float C = Gradient(AB, Xf, Yf - 1.0f);
+			const float D = Gradient(BB, Xf - 1.0f, Yf - 1.0f);
+			Out[Index] = Lerp(V, Lerp(U, A, B), Lerp(U, C, D));
+
+			// Value is A + U(B - A) + V(C - A) + UV(A - B - C + D); differentiate both the corner gradients and the fade curves
+			const float Cross = A - B - C + D;
+			const float GAX = Gradient(AA, 1.0f, 0.0f), GAY = Gradient(AA, 0.0f, 1.0f);
+			const float GBX = Gradient(BA, 1.0f, 0.0f), GBY = Gradient(BA, 0.0f, 1.0f);
+			const float GCX = Gradient(AB, 1.0f, 0.0f), GCY = Gradient(AB, 0.0f, 1.0f);
+			const float GDX = Gradient(BB, 1.0f, 0.0f), GDY = Gradient(BB, 0.0f, 1.0f);
+			OutDX[Index] = GAX + U * (GBX - GAX) + V * (GCX - GAX) + U * V * (GAX - GBX - GCX + GDX) + FadeDerivative(Xf) * ((B - A) + V * Cross);
+			OutDY[Index] = GAY + U * (GBY - GAY) + V * (GCY - GAY) + U * V * (GAY - GBY - GCY + GDY) + FadeDerivative(Yf) * ((C - A) + U * Cross);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluateSimplexPointsWithDerivatives(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+	{
+		const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+		const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+
+		// Adds one corner's attenuated contribution; the cell offsets are constant inside a simplex, so d(offset)/dx is 1
+		auto AddCorner = [](int32 CornerHash, float CX, float CY, float& Total, float& DX, float& DY)
+		{
+			float T = 0.5f - CX * CX - CY * CY;
+			if (T >= 0.0f)
+			{
+				const float T2 = T * T;
+				const float Value = SimplexGradient(CornerHash, CX, CY);
+				const float Falloff = -8.0f * T2 * T * Value;
+				Total += T2 * T2 * Value;
+				DX += T2 * T2 * SimplexGradient(CornerHash, 1.0f, 0.0f) + Falloff * CX;
+				DY += T2 * T2 * SimplexGradient(CornerHash, 0.0f, 1.0f) + Falloff * CY;
+			}
+		};
+
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			const float S = (X[Index] + Y[Index]) * F2;
+			const int32 I = FMath::FloorToInt(X[Index] + S);
+			const int32 J = FMath::FloorToInt(Y[Index] + S);
+
+			const float T = (I + J) * G2;
+			const float X0 = X[Index] - (I - T);
+			const float Y0 = Y[Index] - (J - T);
+
+			const int32 I1 = (X0 > Y0) ? 1 : 0;
+			const int32 J1 = 1 - I1;
+
+			const float X1 = X0 - I1 + G2;
+			const float Y1 = Y0 - J1 + G2;
+			const float X2 = X0 - 1.0f + 2.0f * G2;
+			const float Y2 = Y0 - 1.0f + 2.0f * G2;
+
+			float Total = 0.0f;
+			float DX = 0.0f;
+			float DY = 0.0f;
+			AddCorner(Hash.SimplexCorner(I, J), X0, Y0, Total, DX, DY);
+			AddCorner(Hash.SimplexCorner(I + I1, J + J1), X1, Y1, Total, DX, DY);
+			AddCorner(Hash.SimplexCorner(I + 1, J + 1), X2, Y2, Total, DX, DY);
+
+			Out[Index] = 70.0f * Total;
+			OutDX[Index] = 70.0f * DX;
+			OutDY[Index] = 70.0f * DY;
+		}
+	}
+
+	template<typename HashType>
+	void EvaluatePerlinPointsWithDerivativesVector(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+	{
+		const VectorRegister4Float One = VectorSetFloat1(1.0f);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float PX = VectorLoad(X + Index);
+			const VectorRegister4Float PY = VectorLoad(Y + Index);
+			const VectorRegister4Float FloorX = VectorFloor(PX);
+			const VectorRegister4Float FloorY = VectorFloor(PY);
+			const VectorRegister4Float Xf = VectorSubtract(PX, FloorX);
+			const VectorRegister4Float Yf = VectorSubtract(PY, FloorY);
+
+			VectorRegister4Int AA, AB, BA, BB;
+			Hash.Perlin2DCorners(VectorFloatToInt(FloorX), VectorFloatToInt(FloorY), AA, AB, BA, BB);
+
+			const VectorRegister4Float Xf1 = VectorSubtract(Xf, One);
+			const VectorRegister4Float Yf1 = VectorSubtract(Yf, One);
+			const VectorRegister4Float U = Simd::Fade(Xf);
+			const VectorRegister4Float V = Simd::Fade(Yf);
+
+			const VectorRegister4Float A = Simd::Gradient(AA, Xf, Yf);
+			const VectorRegister4Float B = Simd::Gradient(BA, Xf1, Yf);
+			const VectorRegister4Float C = Simd::Gradient(AB, Xf, Yf1);
+			const VectorRegister4Float D = Simd::Gradient(BB, Xf1, Yf1);
+			VectorStore(Simd::Lerp(V, Simd::Lerp(U, A, B), Simd::Lerp(U, C, D)), Out + Index);
+
+			const VectorRegister4Float Cross = VectorAdd(VectorSubtract(VectorSubtract(A, B), C), D);
+			const VectorRegister4Float UV = VectorMultiply(U, V);
+
+			// Same expansion as the scalar kernel, once per axis
+			auto Derivative = [&](const VectorRegister4Float& AxisX, const VectorRegister4Float& AxisY, const VectorRegister4Float& FadeSlope, const VectorRegister4Float& Edge, const VectorRegister4Float& Other)
+			{
+				const VectorRegister4Float GA = Simd::Gradient(AA, AxisX, AxisY);
+				const VectorRegister4Float GB = Simd::Gradient(BA, AxisX, AxisY);
+				const VectorRegister4Float GC = Simd::Gradient(AB, AxisX, AxisY);
+				const VectorRegister4Float GD = Simd::Gradient(BB, AxisX, AxisY);
+				VectorRegister4Float Result = VectorAdd(GA, VectorMultiply(U, VectorSubtract(GB, GA)));
+				Result = VectorAdd(Result, VectorMultiply(V, VectorSubtract(GC, GA)));
+				Result = VectorAdd(Result, VectorMultiply(UV, VectorAdd(VectorSubtract(VectorSubtract(GA, GB), GC), GD)));
+				return VectorAdd(Result, VectorMultiply(FadeSlope, VectorAdd(Edge, VectorMultiply(Other, Cross))));
+			};
+			VectorStore(Derivative(One, Zero, Simd::FadeDerivative(Xf), VectorSubtract(B, A), V), OutDX + Index);
+			VectorStore(Derivative(Zero, One, Simd::FadeDerivative(Yf), VectorSubtract(C, A), U), OutDY + Index);
+		}
+
+		if (Index < Count)
+		{
+			EvaluatePerlinPointsWithDerivatives(Hash, X + Index, Y + Index, Count - Index, Out + Index, OutDX + Index, OutDY + Index);
+		}
+	}
+
+	template<typename HashType>
+	void EvaluateSimplexPointsWithDerivativesVector(const HashType& Hash, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+	{
+		const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+		const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+		const VectorRegister4Float F2Vector = VectorSetFloat1(F2);
+		const VectorRegister4Float G2Vector = VectorSetFloat1(G2);
+		const VectorRegister4Float TwoG2Vector = VectorSetFloat1(2.0f * G2);
+		const VectorRegister4Float One = VectorSetFloat1(1.0f);
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Float Seventy = VectorSetFloat1(70.0f);
+		const VectorRegister4Int IntOne = MakeVectorRegisterInt(1, 1, 1, 1);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const VectorRegister4Float PX = VectorLoad(X + Index);
+			const VectorRegister4Float PY = VectorLoad(Y + Index);
+
+			const VectorRegister4Float S = VectorMultiply(VectorAdd(PX, PY), F2Vector);
+			const VectorRegister4Float I = VectorFloor(VectorAdd(PX, S));
+			const VectorRegister4Float J = VectorFloor(VectorAdd(PY, S));
+
+			const VectorRegister4Float T = VectorMultiply(VectorAdd(I, J), G2Vector);
+			const VectorRegister4Float X0 = VectorSubtract(PX, VectorSubtract(I, T));
+			const VectorRegister4Float Y0 = VectorSubtract(PY, VectorSubtract(J, T));
+
+			const VectorRegister4Float Lower = VectorCompareGT(X0, Y0);
+			const VectorRegister4Float I1 = VectorSelect(Lower, One, Zero);
+			const VectorRegister4Float J1 = VectorSelect(Lower, Zero, One);
+
+			const VectorRegister4Float X1 = VectorAdd(VectorSubtract(X0, I1), G2Vector);
+			const VectorRegister4Float Y1 = VectorAdd(VectorSubtract(Y0, J1), G2Vector);
+			const VectorRegister4Float X2 = VectorAdd(VectorSubtract(X0, One), TwoG2Vector);
+			const VectorRegister4Float Y2 = VectorAdd(VectorSubtract(Y0, One), TwoG2Vector);
+
+			const VectorRegister4Int CellI = VectorFloatToInt(I);
+			const VectorRegister4Int CellJ = VectorFloatToInt(J);
+			const VectorRegister4Int Hash0 = Hash.SimplexCorner(CellI, CellJ);
+			const VectorRegister4Int Hash1 = Hash.SimplexCorner(VectorIntAdd(CellI, VectorFloatToInt(I1)), VectorIntAdd(CellJ, VectorFloatToInt(J1)));
+			const VectorRegister4Int Hash2 = Hash.SimplexCorner(VectorIntAdd(CellI, IntOne), VectorIntAdd(CellJ, IntOne));
+
+			VectorRegister4Float DX = Zero;
+			VectorRegister4Float DY = Zero;
+			const VectorRegister4Float N0 = Simd::SimplexCornerWithDerivatives(Hash0, X0, Y0, DX, DY);
+			const VectorRegister4Float N1 = Simd::SimplexCornerWithDerivatives(Hash1, X1, Y1, DX, DY);
+			const VectorRegister4Float N2 = Simd::SimplexCornerWithDerivatives(Hash2, X2, Y2, DX, DY);
+
+			VectorStore(VectorMultiply(Seventy, VectorAdd(VectorAdd(N0, N1), N2)), Out + Index);
+			VectorStore(VectorMultiply(Seventy, DX), OutDX + Index);
+			VectorStore(VectorMultiply(Seventy, DY), OutDY + Index);
+		}
+
+		if (Index < Count)
+		{
+			EvaluateSimplexPointsWithDerivatives(Hash, X + Index, Y + Index, Count - Index, Out + Index, OutDX + Index, OutDY + Index);
+		}
+	}
+
+	/** Octave tables and scale for one grid, built once and shared by every row */
+	struct FFractalSetup
+	{
+		int32 NumOctaves;
+		float InvScale;
+		float InvMaxValue;
+		float WarpStrength;
+		float Frequency[TerraMaxNoiseOctaves];
+		float Multiplier[TerraMaxNoiseOctaves]; // InvScale * Frequency
+		float Amplitude[TerraMaxNoiseOctaves];
+	};
+
+	/** Row-sized scratch buffers used by TFractal::Row */
+	static constexpr int32 FractalScratchRows = 14;
+
+	/** Samples handed to TFractal::Row at a time, so its scratch fits on the stack at any grid width. A multiple of four keeps vector lanes on the same samples */
+	static constexpr int32 FractalSpanSamples = 128;
+	static_assert(FractalSpanSamples % 4 == 0, "Spans must not change which samples share a vector");
+
+	struct FPerlinPolicy
+	{
+		template<typename HashType>
+		static FORCEINLINE void Evaluate(const HashType& Hash, bool bVector, const float* X, const float* Y, int32 Count, float* Out)
+		{
+			if (bVector)
+			{
+				EvaluatePerlinPointsVector(Hash, X, Y, Count, Out);
+			}
+			else
+			{
+				EvaluatePerlinPoints(Hash, X, Y, Count, Out);
+			}
+		}
+
+		template<typename HashType>
+		static FORCEINLINE void EvaluateWithDerivatives(const HashType& Hash, bool bVector, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+		{
+			if (bVector)
+			{
+				EvaluatePerlinPointsWithDerivativesVector(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+			else
+			{
+				EvaluatePerlinPointsWithDerivatives(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+		}
+	};
+
+	struct FSimplexPolicy
+	{
+		template<typename HashType>
+		static FORCEINLINE void Evaluate(const HashType& Hash, bool bVector, const float* X, const float* Y, int32 Count, float* Out)
+		{
+			if (bVector)
+			{
+				EvaluateSimplexPointsVector(Hash, X, Y, Count, Out);
+			}
+			else
+			{
+				EvaluateSimplexPoints(Hash, X, Y, Count, Out);
+			}
+		}
+
+		template<typename HashType>
+		static FORCEINLINE void EvaluateWithDerivatives(const HashType& Hash, bool bVector, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY)
+		{
+			if (bVector)
+			{
+				EvaluateSimplexPointsWithDerivativesVector(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+			else
+			{
+				EvaluateSimplexPointsWithDerivatives(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+		}
+	};
+
+	/**
+	 * Fractal noise over a row of positions with the noise type, octave count and combine mode fixed at compile time.
+	 * Octaves of 0 reads the count from the setup, for counts above TerraMaxSpecializedOctaves.
+	 * Each octave is evaluated for the whole row at once, so the per-sample work is only the kernel and the combine step.
+	 */
+	template<typename NoisePolicy, int32 Octaves, ETerraFractalMode Mode>
+	struct TFractal
+	{
+		template<typename HashType>
+		static void Row(const HashType& Hash, bool bVector, const FFractalSetup& Setup, const float* PositionX, const float* PositionY, int32 Width, float* Scratch, float* Out, float* OutDX, float* OutDY)
+		{
+			const int32 NumOctaves = (Octaves > 0) ? Octaves : Setup.NumOctaves;
+			const bool bDerivatives = OutDX != nullptr;
+
+			float* SampleX = Scratch;
+			float* SampleY = SampleX + Width;
+			float* Noise = SampleY + Width;
+			float* NoiseDX = Noise + Width;
+			float* NoiseDY = NoiseDX + Width;
+			float* WarpX = NoiseDY + Width;
+			float* WarpY = WarpX + Width;
+			float* WarpXDX = WarpY + Width;
+			float* WarpXDY = WarpXDX + Width;
+			float* WarpYDX = WarpXDY + Width;
+			float* WarpYDY = WarpYDX + Width;
+			float* Weight = WarpYDY + Width;
+			float* WeightDX = Weight + Width;
+			float* WeightDY = WeightDX + Width;
+
+			FMemory::Memzero(Out, Width * sizeof(float));
+			if (bDerivatives)
+			{
+				FMemory::Memzero(OutDX, Width * sizeof(float));
+				FMemory::Memzero(OutDY, Width * sizeof(float));
+			}
+
+			if constexpr (Mode == ETerraFractalMode::DomainWarp)
+			{
+				// Two decorrelated fBm fields give the offset; the second is shifted by an arbitrary constant
+				WarpField(Hash, bVector, Setup, PositionX, PositionY, Width, 0.0f, 0.0f, SampleX, SampleY, Noise, NoiseDX, NoiseDY, WarpX, bDerivatives ? WarpXDX : nullptr, WarpXDY);
+				WarpField(Hash, bVector, Setup, PositionX, PositionY, Width, 5.2f, 1.3f, SampleX, SampleY, Noise, NoiseDX, NoiseDY, WarpY, bDerivatives ? WarpYDX : nullptr, WarpYDY);
+			}
+			if constexpr (Mode == ETerraFractalMode::Ridged)
+			{
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					Weight[Column] = 1.0f;
+					WeightDX[Column] = 0.0f;
+					WeightDY[Column] = 0.0f;
+				}
+			}
+
+			for (int32 Octave = 0; Octave < NumOctaves; Octave++)
+			{
+				if constexpr (Mode == ETerraFractalMode::DomainWarp)
+				{
+					const float Frequency = Setup.Frequency[Octave];
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						SampleX[Column] = (PositionX[Column] * Setup.InvScale + WarpX[Column]) * Frequency;
+						SampleY[Column] = (PositionY[Column] * Setup.InvScale + WarpY[Column]) * Frequency;
+					}
+				}
+				else
+				{
+					const float Multiplier = Setup.Multiplier[Octave];
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						SampleX[Column] = PositionX[Column] * Multiplier;
+						SampleY[Column] = PositionY[Column] * Multiplier;
+					}
+				}
+
+				if (bDerivatives)
+				{
+					NoisePolicy::EvaluateWithDerivatives(Hash, bVector, SampleX, SampleY, Width, Noise, NoiseDX, NoiseDY);
+				}
+				else
+				{
+					NoisePolicy::Evaluate(Hash, bVector, SampleX, SampleY, Width, Noise);
+				}
+
+				const float Amplitude = Setup.Amplitude[Octave];
+
+				// Chain rule: octave derivatives are per sample coordinate. Warped samples get the warp Jacobian at the end
+				const float SlopeScale = (Mode == ETerraFractalMode::DomainWarp) ? Setup.Frequency[Octave] : Setup.Multiplier[Octave];
+				const float SlopeAmplitude = Amplitude * SlopeScale;
+
+				if constexpr (Mode == ETerraFractalMode::FBM || Mode == ETerraFractalMode::DomainWarp)
+				{
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						Out[Column] += Noise[Column] * Amplitude;
+					}
+					if (bDerivatives)
+					{
+						for (int32 Column = 0; Column < Width; Column++)
+						{
+							OutDX[Column] += NoiseDX[Column] * SlopeAmplitude;
+							OutDY[Column] += NoiseDY[Column] * SlopeAmplitude;
+						}
+					}
+				}
+				else if constexpr (Mode == ETerraFractalMode::Billow)
+				{
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						Out[Column] += (2.0f * FMath::Abs(Noise[Column]) - 1.0f) * Amplitude;
+					}
+					if (bDerivatives)
+					{
+						for (int32 Column = 0; Column < Width; Column++)
+						{
+							const float Sign = (Noise[Column] >= 0.0f) ? 2.0f : -2.0f;
+							OutDX[Column] += Sign * NoiseDX[Column] * SlopeAmplitude;
+							OutDY[Column] += Sign * NoiseDY[Column] * SlopeAmplitude;
+						}
+					}
+				}
+				else
+				{
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						const float Ridge = 1.0f - FMath::Abs(Noise[Column]);
+						const float Signal = Ridge * Ridge * Weight[Column];
+						Out[Column] += Signal * Amplitude;
+
+						// Each octave is weighted by the previous signal, so the weight carries a derivative too
+						const float NextWeight = 2.0f * Signal;
+						if (bDerivatives)
+						{
+							const float RidgeSlope = (Noise[Column] >= 0.0f) ? -2.0f * Ridge : 2.0f * Ridge;
+							const float SignalDX = RidgeSlope * NoiseDX[Column] * Weight[Column] * SlopeScale + Ridge * Ridge * WeightDX[Column];
+							const float SignalDY = RidgeSlope * NoiseDY[Column] * Weight[Column] * SlopeScale + Ridge * Ridge * WeightDY[Column];
+							OutDX[Column] += SignalDX * Amplitude;
+							OutDY[Column] += SignalDY * Amplitude;
+
+							const bool bWeightClamped = NextWeight <= 0.0f || NextWeight >= 1.0f;
+							WeightDX[Column] = bWeightClamped ? 0.0f : 2.0f * SignalDX;
+							WeightDY[Column] = bWeightClamped ? 0.0f : 2.0f * SignalDY;
+						}
+						Weight[Column] = FMath::Clamp(NextWeight, 0.0f, 1.0f);
+					}
+				}
+			}
+
+			if constexpr (Mode == ETerraFractalMode::Ridged)
+			{
+				// Ridged output is already positive
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					Out[Column] *= Setup.InvMaxValue;
+				}
+				if (bDerivatives)
+				{
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						OutDX[Column] *= Setup.InvMaxValue;
+						OutDY[Column] *= Setup.InvMaxValue;
+					}
+				}
+				return;
+			}
+
+			// Normalize to 0-1 range
+			for (int32 Column = 0; Column < Width; Column++)
+			{
+				Out[Column] = (Out[Column] * Setup.InvMaxValue + 1.0f) * 0.5f;
+			}
+
+			if (bDerivatives)
+			{
+				const float SlopeScale = 0.5f * Setup.InvMaxValue;
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					float DX = OutDX[Column];
+					float DY = OutDY[Column];
+					if constexpr (Mode == ETerraFractalMode::DomainWarp)
+					{
+						// Sample position is Position * InvScale + Warp(Position); apply its Jacobian
+						const float WarpedDX = DX * (Setup.InvScale + WarpXDX[Column]) + DY * WarpYDX[Column];
+						const float WarpedDY = DX * WarpXDY[Column] + DY * (Setup.InvScale + WarpYDY[Column]);
+						DX = WarpedDX;
+						DY = WarpedDY;
+					}
+					OutDX[Column] = DX * SlopeScale;
+					OutDY[Column] = DY * SlopeScale;
+				}
+			}
+		}
+
+		/**
+		 * fBm in [-1, 1] scaled by WarpStrength, in noise cells, sampled at Offset cells from each position
+		 * @param OutDX - Derivatives per world unit, skipped when null
+		 */
+		template<typename HashType>
+		static void WarpField(const HashType& Hash, bool bVector, const FFractalSetup& Setup, const float* PositionX, const float* PositionY, int32 Width, float OffsetX, float OffsetY,
+			float* SampleX, float* SampleY, float* Noise, float* NoiseDX, float* NoiseDY, float* Out, float* OutDX, float* OutDY)
+		{
+			const int32 NumOctaves = (Octaves > 0) ? Octaves : Setup.NumOctaves;
+			FMemory::Memzero(Out, Width * sizeof(float));
+			if (OutDX)
+			{
+				FMemory::Memzero(OutDX, Width * sizeof(float));
+				FMemory::Memzero(OutDY, Width * sizeof(float));
+			}
+
+			for (int32 Octave = 0; Octave < NumOctaves; Octave++)
+			{
+				const float Multiplier = Setup.Multiplier[Octave];
+				const float Frequency = Setup.Frequency[Octave];
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					SampleX[Column] = PositionX[Column] * Multiplier + OffsetX * Frequency;
+					SampleY[Column] = PositionY[Column] * Multiplier + OffsetY * Frequency;
+				}
+
+				const float Amplitude = Setup.Amplitude[Octave];
+				if (OutDX)
+				{
+					NoisePolicy::EvaluateWithDerivatives(Hash, bVector, SampleX, SampleY, Width, Noise, NoiseDX, NoiseDY);
+					for (int32 Column = 0; Column < Width; Column++)
+					{
+						OutDX[Column] += NoiseDX[Column] * Amplitude * Multiplier;
+						OutDY[Column] += NoiseDY[Column] * Amplitude * Multiplier;
+					}
+				}
+				else
+				{
+					NoisePolicy::Evaluate(Hash, bVector, SampleX, SampleY, Width, Noise);
+				}
+
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					Out[Column] += Noise[Column] * Amplitude;
+				}
+			}
+
+			const float WarpScale = Setup.WarpStrength * Setup.InvMaxValue;
+			for (int32 Column = 0; Column < Width; Column++)
+			{
+				Out[Column] *= WarpScale;
+			}
+			if (OutDX)
+			{
+				for (int32 Column = 0; Column < Width; Column++)
+				{
+					OutDX[Column] *= WarpScale;
+					OutDY[Column] *= WarpScale;
+				}
+			}
+		}
+	};
+
+	static FFractalSetup MakeFractalSetup(const FTerraNoiseParams& Params)
+	{
+		FFractalSetup Setup;
+		Setup.NumOctaves = FMath::Clamp(Params.Octaves, 1, TerraMaxNoiseOctaves);
+		Setup.InvScale = 1.0f / ((Params.Scale > 0.0f) ? Params.Scale : 0.0001f);
+		Setup.WarpStrength = Params.WarpStrength;
+
+		float Frequency = 1.0f;
+		float Amplitude = 1.0f;
+		float MaxValue = 0.0f;
+		for (int32 Octave = 0; Octave < Setup.NumOctaves; Octave++)
+		{
+			Setup.Frequency[Octave] = Frequency;
+			Setup.Multiplier[Octave] = Setup.InvScale * Frequency;
+			Setup.Amplitude[Octave] = Amplitude;
+			MaxValue += Amplitude;
+
+			Amplitude *= Params.Persistence;
+			Frequency *= Params.Lacunarity;
+		}
+		Setup.InvMaxValue = 1.0f / MaxValue;
+		return Setup;
+	}
+
+	template<typename HashType>
+	using TFractalRowFunction = void (*)(const HashType&, bool, const FFractalSetup&, const float*, const float*, int32, float*, float*, float*, float*);
+
+	template<typename HashType, typename NoisePolicy, ETerraFractalMode Mode>
+	TFractalRowFunction<HashType> SelectFractalOctaves(int32 NumOctaves)
+	{
+		static_assert(TerraMaxSpecializedOctaves == 8, "Add cases for the new specialized octave counts");
+		switch (NumOctaves)
+		{
+		case 1: return &TFractal<NoisePolicy, 1, Mode>::template Row<HashType>;
+		case 2: return &TFractal<NoisePolicy, 2, Mode>::template Row<HashType>;
+		case 3: return &TFractal<NoisePolicy, 3, Mode>::template Row<HashType>;
+		case 4: return &TFractal<NoisePolicy, 4, Mode>::template Row<HashType>;
+		case 5: return &TFractal<NoisePolicy, 5, Mode>::template Row<HashType>;
+		case 6: return &TFractal<NoisePolicy, 6, Mode>::template Row<HashType>;
+		case 7: return &TFractal<NoisePolicy, 7, Mode>::template Row<HashType>;
+		case 8: return &TFractal<NoisePolicy, 8, Mode>::template Row<HashType>;
+		default: return &TFractal<NoisePolicy, 0, Mode>::template Row<HashType>;
+		}
+	}
+
+	template<typename HashType, typename NoisePolicy>
+	TFractalRowFunction<HashType> SelectFractalMode(ETerraFractalMode Mode, int32 NumOctaves)
+	{
+		switch (Mode)
+		{
+		case ETerraFractalMode::Ridged: return SelectFractalOctaves<HashType, NoisePolicy, ETerraFractalMode::Ridged>(NumOctaves);
+		case ETerraFractalMode::Billow: return SelectFractalOctaves<HashType, NoisePolicy, ETerraFractalMode::Billow>(NumOctaves);
+		case ETerraFractalMode::DomainWarp: return SelectFractalOctaves<HashType, NoisePolicy, ETerraFractalMode::DomainWarp>(NumOctaves);
+		default: return SelectFractalOctaves<HashType, NoisePolicy, ETerraFractalMode::FBM>(NumOctaves);
+		}
+	}
+
+	/** Pick the row function for a grid; the only branch on the noise parameters per grid */
+	template<typename HashType>
+	TFractalRowFunction<HashType> SelectFractal(const FTerraNoiseParams& Params, int32 NumOctaves)
+	{
+		if (Params.NoiseType == ETerraNoiseType::Simplex)
+		{
+			return SelectFractalMode<HashType, FSimplexPolicy>(Params.FractalMode, NumOctaves);
+		}
+		return SelectFractalMode<HashType, FPerlinPolicy>(Params.FractalMode, NumOctaves);
+	}
+}
+
+float FTerraNoiseSampler::Perlin2D(float X, float Y, float Scale, int32 Octaves, float Persistence, float Lacunarity) const
+{
+	if (Scale <= 0.0f) Scale = 0.0001f;
+	
+	float Total = 0.0f;
+	float Frequency = 1.0f;
+	float Amplitude = 1.0f;
+	float MaxValue = 0.0f;
+	
+	for (int32 i = 0; i < Octaves; i++)
+	{
+		float SampleX = (X / Scale) * Frequency;
+		float SampleY = (Y / Scale) * Frequency;
+		
+		float NoiseValue;
+		EvaluatePoints(ETerraNoiseType::Perlin, false, &SampleX, &SampleY, 1, &NoiseValue);
+		
+		Total += NoiseValue * Amplitude;
+		MaxValue += Amplitude;
+		
+		Amplitude *= Persistence;
+		Frequency *= Lacunarity;
+	}
+	
+	// Normalize to 0-1 range
+	return (Total / MaxValue + 1.0f) * 0.5f;
+}
+
+float FTerraNoiseSampler::Perlin3D(float X, float Y, float Z, float Scale) const
+{
+	if (Scale <= 0.0f) Scale = 0.0001f;
+	
+	float SampleX = X / Scale;
+	float SampleY = Y / Scale;
+	float SampleZ = Z / Scale;
+	
+	float NoiseValue;
+	EvaluatePoints3D(false, &SampleX, &SampleY, &SampleZ, 1, &NoiseValue);
+	
+	// Normalize to 0-1 range
+	return (NoiseValue + 1.0f) * 0.5f;
+}
+
+float FTerraNoiseSampler::Simplex2D(float X, float Y, float Scale) const
+{
+	if (Scale <= 0.0f) Scale = 0.0001f;
+	
+	float SampleX = X / Scale;
+	float SampleY = Y / Scale;
+	
+	// Result is already scaled to [-1, 1]
+	float NoiseValue;
+	EvaluatePoints(ETerraNoiseType::Simplex, false, &SampleX, &SampleY, 1, &NoiseValue);
+	return NoiseValue;
+}
+
+float FTerraNoiseSampler::Perlin2DWithDerivatives(float X, float Y, float Scale, int32 Octaves, float Persistence, float Lacunarity, FVector2f& OutGradient) const
+{
+	if (Scale <= 0.0f) Scale = 0.0001f;
+
+	float Total = 0.0f;
+	FVector2f Gradient = FVector2f::ZeroVector;
+	float Frequency = 1.0f;
+	float Amplitude = 1.0f;
+	float MaxValue = 0.0f;
+
+	for (int32 i = 0; i < Octaves; i++)
+	{
+		float SampleX = (X / Scale) * Frequency;
+		float SampleY = (Y / Scale) * Frequency;
+		const float Multiplier = Frequency / Scale;
+
+		float NoiseValue, NoiseDX, NoiseDY;
+		EvaluatePointsWithDerivatives(ETerraNoiseType::Perlin, false, &SampleX, &SampleY, 1, &NoiseValue, &NoiseDX, &NoiseDY);
+
+		// Chain rule: each octave is sampled at X * Multiplier
+		Total += NoiseValue * Amplitude;
+		Gradient += FVector2f(NoiseDX, NoiseDY) * (Amplitude * Multiplier);
+		MaxValue += Amplitude;
+
+		Amplitude *= Persistence;
+		Frequency *= Lacunarity;
+	}
+
+	// Normalize to 0-1 range, which halves the slope as well
+	OutGradient = Gradient * (0.5f / MaxValue);
+	return (Total / MaxValue + 1.0f) * 0.5f;
+}
+
+float FTerraNoiseSampler::Simplex2DWithDerivatives(float X, float Y, float Scale, FVector2f& OutGradient) const
+{
+	if (Scale <= 0.0f) Scale = 0.0001f;
+
+	float SampleX = X / Scale;
+	float SampleY = Y / Scale;
+
+	float NoiseValue, NoiseDX, NoiseDY;
+	EvaluatePointsWithDerivatives(ETerraNoiseType::Simplex, false, &SampleX, &SampleY, 1, &NoiseValue, &NoiseDX, &NoiseDY);
+	OutGradient = FVector2f(NoiseDX, NoiseDY) / Scale;
+	return NoiseValue;
+}
+
+void FTerraNoiseSampler::EvaluatePoints(ETerraNoiseType NoiseType, bool bVector, const float* X, const float* Y, int32 Count, float* Out) const
+{
+	auto EvaluateWithHash = [&](const auto& Hash)
+	{
+		if (NoiseType == ETerraNoiseType::Simplex)
+		{
+			if (bVector)
+			{
+				TerraNoiseKernels::EvaluateSimplexPointsVector(Hash, X, Y, Count, Out);
+			}
+			else
+			{
+				TerraNoiseKernels::EvaluateSimplexPoints(Hash, X, Y, Count, Out);
+			}
+		}
+		else if (bVector)
+		{
+			TerraNoiseKernels::EvaluatePerlinPointsVector(Hash, X, Y, Count, Out);
+		}
+		else
+		{
+			TerraNoiseKernels::EvaluatePerlinPoints(Hash, X, Y, Count, Out);
+		}
+	};
+
+	if (HashMode == ETerraNoiseHash::IntegerHash)
+	{
+		EvaluateWithHash(TerraNoiseKernels::FIntegerHash{ static_cast<uint32>(Seed) });
+	}
+	else
+	{
+		// Raw pointer avoids a bounds check on every permutation lookup
+		EvaluateWithHash(TerraNoiseKernels::FPermutationTable{ Permutation });
+	}
+}
+
+void FTerraNoiseSampler::EvaluatePoints3D(bool bVector, const float* X, const float* Y, const float* Z, int32 Count, float* Out) const
+{
+	auto EvaluateWithHash = [&](const auto& Hash)
+	{
+		if (bVector)
+		{
+			TerraNoiseKernels::EvaluatePerlin3DPointsVector(Hash, X, Y, Z, Count, Out);
+		}
+		else
+		{
+			TerraNoiseKernels::EvaluatePerlin3DPoints(Hash, X, Y, Z, Count, Out);
+		}
+	};
+
+	if (HashMode == ETerraNoiseHash::IntegerHash)
+	{
+		EvaluateWithHash(TerraNoiseKernels::FIntegerHash{ static_cast<uint32>(Seed) });
+	}
+	else
+	{
+		EvaluateWithHash(TerraNoiseKernels::FPermutationTable{ Permutation });
+	}
+}
+
+void FTerraNoiseSampler::EvaluatePointsWithDerivatives(ETerraNoiseType NoiseType, bool bVector, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY) const
+{
+	auto EvaluateWithHash = [&](const auto& Hash)
+	{
+		if (NoiseType == ETerraNoiseType::Simplex)
+		{
+			if (bVector)
+			{
+				TerraNoiseKernels::EvaluateSimplexPointsWithDerivativesVector(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+			else
+			{
+				TerraNoiseKernels::EvaluateSimplexPointsWithDerivatives(Hash, X, Y, Count, Out, OutDX, OutDY);
+			}
+		}
+		else if (bVector)
+		{
+			TerraNoiseKernels::EvaluatePerlinPointsWithDerivativesVector(Hash, X, Y, Count, Out, OutDX, OutDY);
+		}
+		else
+		{
+			TerraNoiseKernels::EvaluatePerlinPointsWithDerivatives(Hash, X, Y, Count, Out, OutDX, OutDY);
+		}
+	};
+
+	if (HashMode == ETerraNoiseHash::IntegerHash)
+	{
+		EvaluateWithHash(TerraNoiseKernels::FIntegerHash{ static_cast<uint32>(Seed) });
+	}
+	else
+	{
+		EvaluateWithHash(TerraNoiseKernels::FPermutationTable{ Permutation });
+	}
+}
+
+bool FTerraNoiseSampler::UseVectorKernels(ETerraNoiseKernel Kernel)
+{
+	switch (Kernel)
+	{
+	case ETerraNoiseKernel::Scalar:
+		return false;
+	case ETerraNoiseKernel::Vector:
+		return true;
+	default:
+		return CVarTerraNoiseSIMD.GetValueOnAnyThread() != 0;
+	}
+}
+
+float FTerraNoiseSampler::Fractal2D(float X, float Y, const FTerraNoiseParams& Params) const
+{
+	float Value;
+	FillGridRows(FVector2D(X, Y), FVector2D(1.0, 1.0), 1, 0, 1, Params, &Value, nullptr, nullptr, ETerraNoiseKernel::Scalar);
+	return Value;
+}
+
+void FTerraNoiseSampler::NoiseGrid2D(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 Height, const FTerraNoiseParams& Params, TArrayView<float> Out, ETerraNoiseKernel Kernel) const
+{
+	NoiseGridRows(Origin, Step, Width, 0, Height, Params, Out, Kernel);
+}
+
+void FTerraNoiseSampler::NoiseGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, TArrayView<float> Out, ETerraNoiseKernel Kernel) const
+{
+	check(Out.Num() >= Width * NumRows);
+	FillGridRows(Origin, Step, Width, FirstRow, NumRows, Params, Out.GetData(), nullptr, nullptr, Kernel);
+}
+
+void FTerraNoiseSampler::NoiseGridRowsWithDerivatives(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, TArrayView<float> Out, TArrayView<float> OutDX, TArrayView<float> OutDY, ETerraNoiseKernel Kernel) const
+{
+	check(Out.Num() >= Width * NumRows && OutDX.Num() >= Width * NumRows && OutDY.Num() >= Width * NumRows);
+	FillGridRows(Origin, Step, Width, FirstRow, NumRows, Params, Out.GetData(), OutDX.GetData(), OutDY.GetData(), Kernel);
+}
+
+void FTerraNoiseSampler::FillGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, float* Out, float* OutDX, float* OutDY, ETerraNoiseKernel Kernel) const
+{
+	if (Width <= 0 || NumRows <= 0)
+	{
+		return;
+	}
+	const bool bDerivatives = OutDX != nullptr;
+	const bool bVector = UseVectorKernels(Kernel);
+
+	// Octave setup is identical for every sample, so build it once per grid
+	const TerraNoiseKernels::FFractalSetup Setup = TerraNoiseKernels::MakeFractalSetup(Params);
+
+	// Rows are evaluated in spans of columns, so the positions and the fractal's working rows stay on the stack at any width
+	constexpr int32 SpanSamples = TerraNoiseKernels::FractalSpanSamples;
+	alignas(16) float ColumnX[SpanSamples];
+	alignas(16) float RowY[SpanSamples];
+	alignas(16) float FractalScratch[TerraNoiseKernels::FractalScratchRows * SpanSamples];
+
+	auto FillWithHash = [&](const auto& Hash)
+	{
+		using HashType = typename TDecay<decltype(Hash)>::Type;
+		const TerraNoiseKernels::TFractalRowFunction<HashType> Row = TerraNoiseKernels::SelectFractal<HashType>(Params, Setup.NumOctaves);
+
+		for (int32 SpanStart = 0; SpanStart < Width; SpanStart += SpanSamples)
+		{
+			const int32 SpanWidth = FMath::Min(SpanSamples, Width - SpanStart);
+			for (int32 Column = 0; Column < SpanWidth; Column++)
+			{
+				ColumnX[Column] = static_cast<float>(Origin.X + (SpanStart + Column) * Step.X);
+			}
+
+			for (int32 RowIndex = 0; RowIndex < NumRows; RowIndex++)
+			{
+				const float Y = static_cast<float>(Origin.Y + (FirstRow + RowIndex) * Step.Y);
+				for (int32 Column = 0; Column < SpanWidth; Column++)
+				{
+					RowY[Column] = Y;
+				}
+
+				const int32 SpanOffset = RowIndex * Width + SpanStart;
+				Row(Hash, bVector, Setup, ColumnX, RowY, SpanWidth, FractalScratch, Out + SpanOffset, bDerivatives ? OutDX + SpanOffset : nullptr, bDerivatives ? OutDY + SpanOffset : nullptr);
+			}
+		}
+	};
+
+	if (HashMode == ETerraNoiseHash::IntegerHash)
+	{
+		FillWithHash(TerraNoiseKernels::FIntegerHash{ static_cast<uint32>(Seed) });
+	}
+	else
+	{
+		FillWithHash(TerraNoiseKernels::FPermutationTable{ Permutation });
+	}
+}
+
+void FTerraNoiseSampler::FractalPoints(const FTerraNoiseParams& Params, const float* X, const float* Y, int32 Count, float* Out, ETerraNoiseKernel Kernel) const
+{
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	const TerraNoiseKernels::FFractalSetup Setup = TerraNoiseKernels::MakeFractalSetup(Params);
+	const bool bVector = UseVectorKernels(Kernel);
+
+	// Evaluated in spans so the fractal's working rows stay on the stack for any number of points
+	constexpr int32 SpanSamples = TerraNoiseKernels::FractalSpanSamples;
+	alignas(16) float FractalScratch[TerraNoiseKernels::FractalScratchRows * SpanSamples];
+
+	auto FillWithHash = [&](const auto& Hash)
+	{
+		using HashType = typename TDecay<decltype(Hash)>::Type;
+		const TerraNoiseKernels::TFractalRowFunction<HashType> Row = TerraNoiseKernels::SelectFractal<HashType>(Params, Setup.NumOctaves);
+		for (int32 SpanStart = 0; SpanStart < Count; SpanStart += SpanSamples)
+		{
+			const int32 SpanCount = FMath::Min(SpanSamples, Count - SpanStart);
+			Row(Hash, bVector, Setup, X + SpanStart, Y + SpanStart, SpanCount, FractalScratch, Out + SpanStart, nullptr, nullptr);
+		}
+	};
+
+	if (HashMode == ETerraNoiseHash::IntegerHash)
+	{
+		FillWithHash(TerraNoiseKernels::FIntegerHash{ static_cast<uint32>(Seed) });
+	}
+	else
+	{
+		FillWithHash(TerraNoiseKernels::FPermutationTable{ Permutation });
+	}
+}
+
+void FTerraNoiseSampler::Perlin3DBatch(TConstArrayView<FVector3f> Points, float Scale, TArrayView<float> Out, ETerraNoiseKernel Kernel) const
+{
+	check(Out.Num() >= Points.Num());
+
+	if (Scale <= 0.0f) Scale = 0.0001f;
+	const float InvScale = 1.0f / Scale;
+	const bool bVector = UseVectorKernels(Kernel);
+
+	// Convert to structure-of-arrays in small blocks so the kernels can load four coordinates at once
+	constexpr int32 BlockSize = 64;
+	float SampleX[BlockSize];
+	float SampleY[BlockSize];
+	float SampleZ[BlockSize];
+
+	for (int32 Start = 0; Start < Points.Num(); Start += BlockSize)
+	{
+		const int32 Count = FMath::Min(BlockSize, Points.Num() - Start);
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			const FVector3f& Point = Points[Start + Index];
+			SampleX[Index] = Point.X * InvScale;
+			SampleY[Index] = Point.Y * InvScale;
+			SampleZ[Index] = Point.Z * InvScale;
+		}
+
+		float* BlockOut = Out.GetData() + Start;
+		EvaluatePoints3D(bVector, SampleX, SampleY, SampleZ, Count, BlockOut);
+
+		// Normalize to 0-1 range
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			BlockOut[Index] = (BlockOut[Index] + 1.0f) * 0.5f;
+		}
+	}
+}
+
+/** Times the scalar and vector kernels on the same input and checks they agree */
+static void RunNoiseKernelBenchmark(const TArray<FString>& Args)
+{
+	const int32 GridSize = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 16) : 512;
+	const int32 Iterations = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10;
+	const int32 NumSamples = GridSize * GridSize;
+
+	const FTerraNoiseSampler Sampler(12345);
+
+	TArray<float> ScalarOut;
+	TArray<float> VectorOut;
+	ScalarOut.SetNumUninitialized(NumSamples);
+	VectorOut.SetNumUninitialized(NumSamples);
+
+	auto Report = [&](const TCHAR* Name, double ScalarSeconds, double VectorSeconds)
+	{
+		float MaxError = 0.0f;
+		for (int32 Index = 0; Index < NumSamples; Index++)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs(ScalarOut[Index] - VectorOut[Index]));
+		}
+
+		const double TotalSamples = static_cast<double>(NumSamples) * Iterations;
+		UE_LOG(LogTemp, Log, TEXT("TerraForge noise benchmark %s: scalar %.2f Msamples/s, vector %.2f Msamples/s, speedup %.2fx, max error %g (%s)"),
+			Name,
+			TotalSamples / ScalarSeconds * 1.0e-6,
+			TotalSamples / VectorSeconds * 1.0e-6,
+			ScalarSeconds / VectorSeconds,
+			MaxError,
+			(MaxError <= TerraNoiseVectorTolerance) ? TEXT("ok") : TEXT("MISMATCH"));
+	};
+
+	auto TimeGrid = [&](const FTerraNoiseParams& Params, ETerraNoiseKernel Kernel, TArray<float>& Out)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Sampler.NoiseGrid2D(FVector2D(0.37, 0.61), FVector2D(1.0, 1.0), GridSize, GridSize, Params, Out, Kernel);
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	};
+
+	FTerraNoiseParams Params;
+	Params.Scale = 64.0f;
+	Params.Octaves = 1;
+	{
+		const double ScalarSeconds = TimeGrid(Params, ETerraNoiseKernel::Scalar, ScalarOut);
+		const double VectorSeconds = TimeGrid(Params, ETerraNoiseKernel::Vector, VectorOut);
+		Report(TEXT("Perlin2D"), ScalarSeconds, VectorSeconds);
+	}
+
+	Params.NoiseType = ETerraNoiseType::Simplex;
+	{
+		const double ScalarSeconds = TimeGrid(Params, ETerraNoiseKernel::Scalar, ScalarOut);
+		const double VectorSeconds = TimeGrid(Params, ETerraNoiseKernel::Vector, VectorOut);
+		Report(TEXT("Simplex2D"), ScalarSeconds, VectorSeconds);
+	}
+
+	TArray<FVector3f> Points;
+	Points.SetNumUninitialized(NumSamples);
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		Points[Index] = FVector3f(Index % GridSize + 0.37f, Index / GridSize + 0.61f, (Index % 7) * 3.1f);
+	}
+
+	auto TimeBatch = [&](ETerraNoiseKernel Kernel, TArray<float>& Out)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Sampler.Perlin3DBatch(Points, 64.0f, Out, Kernel);
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	};
+
+	{
+		const double ScalarSeconds = TimeBatch(ETerraNoiseKernel::Scalar, ScalarOut);
+		const double VectorSeconds = TimeBatch(ETerraNoiseKernel::Vector, VectorOut);
+		Report(TEXT("Perlin3D"), ScalarSeconds, VectorSeconds);
+	}
+}
+
+static FAutoConsoleCommand TerraNoiseBenchmarkCommand(
+	TEXT("TerraForge.Noise.Benchmark"),
+	TEXT("Compares scalar and vector noise kernels. Usage: TerraForge.Noise.Benchmark [GridSize] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunNoiseKernelBenchmark));
@@ -0,0 +1,36 @@
+// TerraForge - Procedural World Generator
+// Terrain Biome Implementation
+
+#include "TerrainBiome.h"
+
+// Where the moisture and temperature fields are read, in climate noise cells. Far apart and off the lattice,
+// so neither field lines up with the other or with the height noise, even with the repeating permutation table
+static const FVector2D MoistureOffset(1013.37, 577.71);
+static const FVector2D TemperatureOffset(-331.19, 1789.53);
+
+FTerrainBiomeClassifier::FTerrainBiomeClassifier(const FTerraBiomeParams& Params)
+{
+	ClimateNoise.NoiseType = ETerraNoiseType::Perlin;
+	ClimateNoise.Scale = FMath::Max(Params.ClimateScale, 1.0f);
+	ClimateNoise.Octaves = 3;
+	ClimateNoise.FractalMode = ETerraFractalMode::FBM;
+
+	const float HalfBlend = 0.5f * FMath::Max(Params.RockBlend, 0.0f);
+	RockCosSteep = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(Params.RockSlope + HalfBlend, 0.0f, 90.0f)));
+	RockCosFlat = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(Params.RockSlope - HalfBlend, 0.0f, 90.0f)));
+
+	SandHeight = Params.SandHeight;
+	SandBlend = FMath::Max(Params.SandBlend, 0.0f);
+	SnowHeight = Params.SnowHeight;
+	SnowBlend = FMath::Max(Params.SnowBlend, 0.0f);
+	TemperatureRange = Params.TemperatureRange;
+	DryMoisture = Params.DryMoisture;
+	MoistureBlend = FMath::Max(Params.MoistureBlend, 0.0f);
+}
+
+void FTerrainBiomeClassifier::SampleClimateRows(const FTerraNoiseSampler& Sampler, const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows,
+	TArrayView<float> OutMoisture, TArrayView<float> OutTemperature) const
+{
+	Sampler.NoiseGridRows(Origin + MoistureOffset * ClimateNoise.Scale, Step, Width, FirstRow, NumRows, ClimateNoise, OutMoisture);
+	Sampler.NoiseGridRows(Origin + TemperatureOffset * ClimateNoise.Scale, Step, Width, FirstRow, NumRows, ClimateNoise, OutTemperature);
+}
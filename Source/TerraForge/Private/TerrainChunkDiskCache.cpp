@@ -0,0 +1,228 @@
+// TerraForge - Procedural World Generator
+// Terrain Chunk Disk Cache Implementation
+
+#include "TerrainChunkDiskCache.h"
+#include "TerraForgeStats.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/xxhash.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+// Bump when the file layout or the generated data changes for the same settings
+static constexpr uint32 ChunkCacheMagic = 0x43465454; // "TTFC"
+static constexpr uint32 ChunkCacheVersion = 2;
+
+/**
+ * File header, followed by the halo height grid as floats and one FVector3f normal per vertex
+ */
+struct FChunkCacheHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint64 Key;
+	int32 Width;
+	int32 Height;
+	uint64 PayloadHash;
+};
+
+static int32 GetNumHaloHeights(const FTerrainBuildSettings& Settings)
+{
+	return (Settings.Width + 3) * (Settings.Height + 3);
+}
+
+static int32 GetNumVertices(const FTerrainBuildSettings& Settings)
+{
+	return (Settings.Width + 1) * (Settings.Height + 1);
+}
+
+FTerrainChunkDiskCache::FTerrainChunkDiskCache(FString InDirectory)
+	: Directory(MoveTemp(InDirectory))
+{
+}
+
+FString FTerrainChunkDiskCache::GetDefaultDirectory()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerraForge"), TEXT("ChunkCache"));
+}
+
+bool FTerrainChunkDiskCache::CanCache(const FTerrainBuildSettings& Settings)
+{
+	return !Settings.HeightProgram.IsValid() && !Settings.Heightmap.IsValid();
+}
+
+uint64 FTerrainChunkDiskCache::MakeKey(const FTerrainBuildSettings& Settings)
+{
+	// Fields are hashed one by one, so struct padding never reaches the hash
+	FXxHash64Builder Builder;
+	auto Add = [&Builder](const auto& Value)
+	{
+		Builder.Update(&Value, sizeof(Value));
+	};
+
+	Add(ChunkCacheVersion);
+	Add(Settings.Sampler.GetSeed());
+	Add(Settings.Sampler.GetHashMode());
+	Add(Settings.NoiseParams.NoiseType);
+	Add(Settings.NoiseParams.Scale);
+	Add(Settings.NoiseParams.Octaves);
+	Add(Settings.NoiseParams.Persistence);
+	Add(Settings.NoiseParams.Lacunarity);
+	Add(Settings.NoiseParams.FractalMode);
+	Add(Settings.NoiseParams.WarpStrength);
+	Add(Settings.Width);
+	Add(Settings.Height);
+	Add(Settings.GridSize);
+	Add(Settings.MaxHeight);
+	Add(Settings.NoiseOrigin.X);
+	Add(Settings.NoiseOrigin.Y);
+	Add(Settings.bAnalyticNormals);
+
+	const FTerraHydraulicErosionParams& Erosion = Settings.HydraulicErosion;
+	Add(Erosion.bEnabled);
+	if (Erosion.bEnabled)
+	{
+		Add(Erosion.DropletsPerCell);
+		Add(Erosion.MaxLifetime);
+		Add(Erosion.Inertia);
+		Add(Erosion.SedimentCapacity);
+		Add(Erosion.MinSedimentCapacity);
+		Add(Erosion.ErodeSpeed);
+		Add(Erosion.DepositSpeed);
+		Add(Erosion.EvaporateSpeed);
+		Add(Erosion.Gravity);
+		Add(Erosion.Seed);
+	}
+
+	const FTerraThermalErosionParams& Thermal = Settings.ThermalErosion;
+	Add(Thermal.bEnabled);
+	if (Thermal.bEnabled)
+	{
+		Add(Thermal.Iterations);
+		Add(Thermal.TalusAngle);
+		Add(Thermal.Rate);
+	}
+	return Builder.Finalize().Hash;
+}
+
+FString FTerrainChunkDiskCache::GetChunkPath(uint64 Key) const
+{
+	return FPaths::Combine(Directory, FString::Printf(TEXT("%016llx.tfchunk"), Key));
+}
+
+bool FTerrainChunkDiskCache::Load(uint64 Key, const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData) const
+{
+	TERRAFORGE_STAGE_SCOPE(ChunkCacheLoad);
+
+	if (!CanCache(Settings))
+	{
+		return false;
+	}
+
+	// A missing file is the common miss and fails here without logging
+	TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*GetChunkPath(Key)));
+	if (!Handle)
+	{
+		return false;
+	}
+
+	const int32 NumHeights = GetNumHaloHeights(Settings);
+	const int32 NumVertices = GetNumVertices(Settings);
+	const int64 PayloadSize = NumHeights * static_cast<int64>(sizeof(float)) + NumVertices * static_cast<int64>(sizeof(FVector3f));
+	if (Handle->GetFileSize() != sizeof(FChunkCacheHeader) + PayloadSize)
+	{
+		return false;
+	}
+
+	TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+	if (!Region)
+	{
+		return false;
+	}
+
+	const uint8* Mapped = Region->GetMappedPtr();
+	FChunkCacheHeader Header;
+	FMemory::Memcpy(&Header, Mapped, sizeof(Header));
+	const uint8* Payload = Mapped + sizeof(FChunkCacheHeader);
+	if (Header.Magic != ChunkCacheMagic || Header.Version != ChunkCacheVersion || Header.Key != Key || Header.Width != Settings.Width || Header.Height != Settings.Height
+		|| FXxHash64::HashBuffer(Payload, PayloadSize).Hash != Header.PayloadHash)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainChunkDiskCache: ignoring invalid cache file %s"), *GetChunkPath(Key));
+		return false;
+	}
+
+	OutData.Heights.SetNumUninitialized(NumHeights, EAllowShrinking::No);
+	FMemory::Memcpy(OutData.Heights.GetData(), Payload, NumHeights * sizeof(float));
+	OutData.HeightGradientX.Reset();
+	OutData.HeightGradientY.Reset();
+
+	// Tangents point along +X in the surface, as WriteNormalRow builds them: (1, 0, SlopeX) with SlopeX = -Normal.X / Normal.Z
+	const FVector3f* Normals = reinterpret_cast<const FVector3f*>(Payload + NumHeights * sizeof(float));
+	OutData.Normals.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	OutData.Tangents.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		FVector3f Normal;
+		FMemory::Memcpy(&Normal, Normals + Index, sizeof(Normal));
+		OutData.Normals[Index] = FVector(Normal);
+		OutData.Tangents[Index] = FProcMeshTangent(FVector(Normal.Z, 0.0f, -Normal.X).GetSafeNormal(), false);
+	}
+	return true;
+}
+
+bool FTerrainChunkDiskCache::Save(uint64 Key, const FTerrainBuildSettings& Settings, const FTerrainMeshData& Data) const
+{
+	TERRAFORGE_STAGE_SCOPE(ChunkCacheSave);
+
+	const int32 NumHeights = GetNumHaloHeights(Settings);
+	const int32 NumVertices = GetNumVertices(Settings);
+	if (!CanCache(Settings) || Data.Heights.Num() != NumHeights || Data.Normals.Num() != NumVertices)
+	{
+		return false;
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(NumHeights * sizeof(float) + NumVertices * sizeof(FVector3f));
+	FMemory::Memcpy(Payload.GetData(), Data.Heights.GetData(), NumHeights * sizeof(float));
+	FVector3f* Normals = reinterpret_cast<FVector3f*>(Payload.GetData() + NumHeights * sizeof(float));
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		const FVector3f Normal(Data.Normals[Index]);
+		FMemory::Memcpy(Normals + Index, &Normal, sizeof(Normal));
+	}
+
+	FChunkCacheHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = ChunkCacheMagic;
+	Header.Version = ChunkCacheVersion;
+	Header.Key = Key;
+	Header.Width = Settings.Width;
+	Header.Height = Settings.Height;
+	Header.PayloadHash = FXxHash64::HashBuffer(Payload.GetData(), Payload.Num()).Hash;
+
+	// Unique temporary name, since a regenerate can race an older build of the same chunk
+	const FString Path = GetChunkPath(Key);
+	const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	{
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+		if (!Writer)
+		{
+			return false;
+		}
+		Writer->Serialize(&Header, sizeof(Header));
+		Writer->Serialize(Payload.GetData(), Payload.Num());
+		if (!Writer->Close())
+		{
+			IFileManager::Get().Delete(*TempPath);
+			return false;
+		}
+	}
+
+	if (!IFileManager::Get().Move(*Path, *TempPath, true, true))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,559 @@
+// TerraForge - Procedural World Generator
+// Terrain Chunk Manager Implementation
+
+#include "TerrainChunkManager.h"
+#include "TerraForgeStats.h"
+#include "Kismet/GameplayStatics.h"
+#include "Tasks/Task.h"
+#include "Misc/Paths.h"
+
+ATerrainChunkManager::ATerrainChunkManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	StreamingSource = nullptr;
+	TerrainMaterial = nullptr;
+}
+
+void ATerrainChunkManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	RegenerateAllChunks();
+}
+
+void ATerrainChunkManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BuildResults.IsValid())
+	{
+		BuildResults->bCancelled.store(true);
+		BuildResults.Reset();
+	}
+
+	// Keeps the chunk memory stats balanced
+	for (TPair<FIntPoint, FTerrainChunk>& Pair : Chunks)
+	{
+		ReleaseChunk(Pair.Value);
+	}
+	Chunks.Reset();
+	TotalChunkMemory = 0;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATerrainChunkManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FVector StreamingLocation;
+	if (!GetStreamingLocation(StreamingLocation))
+	{
+		return;
+	}
+
+	// The desired set only changes when the camera crosses into another chunk
+	const FIntPoint NewCenter = WorldToChunk(StreamingLocation);
+	if (bStreamingDirty || NewCenter != CenterChunk)
+	{
+		UpdateDesiredChunks(NewCenter);
+	}
+
+	ApplyCompletedChunks();
+	UpdateChunkCollision();
+	LaunchPendingBuilds();
+	EnforceMemoryCap();
+
+	CSV_CUSTOM_STAT(TerraForge, ChunkMemoryMB, GetChunkMemoryMB(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(TerraForge, LoadedChunks, Chunks.Num(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(TerraForge, PendingChunks, PendingChunks.Num(), ECsvCustomStatOp::Set);
+}
+
+void ATerrainChunkManager::RegenerateAllChunks()
+{
+	// In-flight builds keep the old results object alive and post into it, so they are ignored
+	if (BuildResults.IsValid())
+	{
+		BuildResults->bCancelled.store(true);
+	}
+	BuildResults = MakeShared<FChunkBuildResults, ESPMode::ThreadSafe>();
+
+	// Enough for every build in flight plus the chunks evicted between them
+	if (!MeshArena.IsValid())
+	{
+		MeshArena = MakeShared<FTerrainMeshArena, ESPMode::ThreadSafe>(FMath::Max(2 * (MaxConcurrentBuilds + MaxChunkAppliesPerFrame), 8));
+	}
+
+	for (TPair<FIntPoint, FTerrainChunk>& Pair : Chunks)
+	{
+		ReleaseChunk(Pair.Value);
+	}
+	Chunks.Reset();
+	RequestQueue.Reset();
+	PendingChunks.Reset();
+	TotalChunkMemory = 0;
+	bWarnedOverBudget = false;
+	bCollisionDirty = true;
+
+	// Picks up changes to bUseDiskCache and DiskCacheDirectory
+	DiskCache.Reset();
+	if (bUseDiskCache)
+	{
+		DiskCache = MakeShared<FTerrainChunkDiskCache, ESPMode::ThreadSafe>(DiskCacheDirectory.IsEmpty() ? FTerrainChunkDiskCache::GetDefaultDirectory() : DiskCacheDirectory);
+	}
+
+	// Reopened so a rebaked file is picked up
+	Heightmap.Reset();
+	if (!HeightmapFile.FilePath.IsEmpty())
+	{
+		Heightmap = FTerrainHeightmapFile::Open(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), HeightmapFile.FilePath));
+	}
+
+	// Seed the noise once for every chunk
+	Sampler = FTerraNoiseSampler(RandomSeed, NoiseHashMode);
+	bStreamingDirty = true;
+}
+
+bool ATerrainChunkManager::GetStreamingLocation(FVector& OutLocation) const
+{
+	const AActor* Source = StreamingSource ? StreamingSource : UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Source)
+	{
+		return false;
+	}
+
+	OutLocation = Source->GetActorLocation();
+	return true;
+}
+
+FIntPoint ATerrainChunkManager::WorldToChunk(const FVector& WorldLocation) const
+{
+	const FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation);
+	const double ChunkSize = static_cast<double>(ChunkQuads) * GridSize;
+	return FIntPoint(FMath::FloorToInt32(LocalLocation.X / ChunkSize), FMath::FloorToInt32(LocalLocation.Y / ChunkSize));
+}
+
+bool ATerrainChunkManager::IsChunkInRange(const FIntPoint& Coord, const FIntPoint& Center) const
+{
+	const FIntPoint Delta = Coord - Center;
+	return Delta.X * Delta.X + Delta.Y * Delta.Y <= LoadRadius * LoadRadius;
+}
+
+void ATerrainChunkManager::UpdateDesiredChunks(const FIntPoint& Center)
+{
+	CenterChunk = Center;
+	bStreamingDirty = false;
+
+	// Show cached chunks back in range, hide the ones that left it
+	for (TPair<FIntPoint, FTerrainChunk>& Pair : Chunks)
+	{
+		const bool bInRange = IsChunkInRange(Pair.Key, Center);
+		if (bInRange)
+		{
+			Pair.Value.LastUsedFrame = GFrameCounter;
+		}
+		if (bInRange != Pair.Value.bVisible)
+		{
+			SetChunkVisible(Pair.Value, bInRange);
+			bCollisionDirty = true;
+		}
+	}
+
+	// Queue missing chunks nearest first; requests that left the range are dropped
+	RequestQueue.Reset();
+	for (int32 Y = -LoadRadius; Y <= LoadRadius; Y++)
+	{
+		for (int32 X = -LoadRadius; X <= LoadRadius; X++)
+		{
+			const FIntPoint Coord = Center + FIntPoint(X, Y);
+			if (IsChunkInRange(Coord, Center) && !Chunks.Contains(Coord) && !PendingChunks.Contains(Coord))
+			{
+				RequestQueue.Add(Coord);
+			}
+		}
+	}
+
+	RequestQueue.Sort([Center](const FIntPoint& A, const FIntPoint& B)
+	{
+		return (A - Center).SizeSquared() < (B - Center).SizeSquared();
+	});
+}
+
+void ATerrainChunkManager::LaunchPendingBuilds()
+{
+	int32 NumLaunched = 0;
+	while (PendingChunks.Num() < MaxConcurrentBuilds && NumLaunched < RequestQueue.Num())
+	{
+		const FIntPoint Coord = RequestQueue[NumLaunched++];
+		PendingChunks.Add(Coord);
+
+		TSharedRef<FChunkBuildResults, ESPMode::ThreadSafe> Results = BuildResults.ToSharedRef();
+		TSharedRef<FTerrainMeshArena, ESPMode::ThreadSafe> Arena = MeshArena.ToSharedRef();
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Results, Arena, Cache = DiskCache, Coord, Settings = MakeChunkSettings(Coord), bCompact = bCompactVertices]()
+		{
+			// Build buffers go back to the arena when this returns
+			const TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> MeshData = Arena->AcquireMeshData();
+
+			// A cache hit replaces all noise evaluation; a miss builds normally and stores the result for the next run
+			const uint64 CacheKey = Cache.IsValid() ? FTerrainChunkDiskCache::MakeKey(Settings) : 0;
+			if (Cache.IsValid() && Cache->Load(CacheKey, Settings, *MeshData))
+			{
+				if (!FTerrainMeshBuilder::BuildFromHeightsAndNormals(Settings, *MeshData, &Results->bCancelled))
+				{
+					return;
+				}
+			}
+			else
+			{
+				if (!FTerrainMeshBuilder::Build(Settings, *MeshData, &Results->bCancelled))
+				{
+					return;
+				}
+				if (Cache.IsValid())
+				{
+					Cache->Save(CacheKey, Settings, *MeshData);
+				}
+			}
+
+			// Packed here so the game thread only swaps buffers into the component
+			FCompletedChunk Completed;
+			Completed.Coord = Coord;
+			if (bCompact)
+			{
+				Completed.CompactMesh = MakeShared<FTerrainCompactMesh, ESPMode::ThreadSafe>();
+				FTerrainMeshBuilder::PackCompact(Settings, *MeshData, *Completed.CompactMesh);
+			}
+			else
+			{
+				Completed.Section = Arena->AcquireSection();
+				FTerrainMeshBuilder::PackSection(*MeshData, Completed.Section);
+			}
+			Completed.CollisionVertices = MoveTemp(MeshData->CollisionVertices);
+			Completed.CollisionTriangles = MoveTemp(MeshData->CollisionTriangles);
+			Results->Completed.Enqueue(MoveTemp(Completed));
+		});
+	}
+
+	RequestQueue.RemoveAt(0, NumLaunched, EAllowShrinking::No);
+}
+
+void ATerrainChunkManager::ApplyCompletedChunks()
+{
+	TERRAFORGE_STAGE_SCOPE(ApplyChunks);
+	LLM_SCOPE_BYTAG(TerraForge);
+
+	FCompletedChunk Completed;
+	for (int32 NumApplied = 0; NumApplied < MaxChunkAppliesPerFrame && BuildResults->Completed.Dequeue(Completed); NumApplied++)
+	{
+		PendingChunks.Remove(Completed.Coord);
+
+		// The camera moved on while this chunk was building
+		if (!IsChunkInRange(Completed.Coord, CenterChunk))
+		{
+			MeshArena->ReleaseSection(MoveTemp(Completed.Section));
+			continue;
+		}
+
+		const double ChunkSize = static_cast<double>(ChunkQuads) * GridSize;
+
+		const FVector ChunkLocation(Completed.Coord.X * ChunkSize, Completed.Coord.Y * ChunkSize, 0.0);
+
+		FTerrainChunk Chunk;
+		Chunk.Mesh = AcquireMesh();
+		Chunk.Mesh->SetRelativeLocation(ChunkLocation);
+		if (Completed.CompactMesh.IsValid())
+		{
+			// The procedural mesh only carries collision and is never drawn
+			Chunk.Heightfield = AcquireHeightfield();
+			Chunk.Heightfield->SetRelativeLocation(ChunkLocation);
+			Chunk.Mesh->SetVisibility(false);
+		}
+		Chunk.LastUsedFrame = GFrameCounter;
+		Chunk.bVisible = false;
+		SetChunkVisible(Chunk, true);
+		Chunk.CollisionVertices = MoveTemp(Completed.CollisionVertices);
+		Chunk.CollisionTriangles = MoveTemp(Completed.CollisionTriangles);
+
+		// The mesh section or the compact mesh owns the render vertices; compact chunks share their index buffer through the topology
+		const int64 RenderBytes = Chunk.Heightfield
+			? Completed.CompactMesh->Vertices.Num() * static_cast<int64>(sizeof(FTerrainCompactVertex))
+			: Completed.Section.ProcVertexBuffer.Num() * static_cast<int64>(sizeof(FProcMeshVertex)) + Completed.Section.ProcIndexBuffer.Num() * static_cast<int64>(sizeof(uint32));
+		Chunk.MemoryBytes = RenderBytes + Chunk.CollisionVertices.Num() * static_cast<int64>(sizeof(FVector)) + Chunk.CollisionTriangles.Num() * static_cast<int64>(sizeof(int32));
+
+		const bool bCollision = WantsCollision(Completed.Coord, Chunk);
+		if (Chunk.Heightfield)
+		{
+			TERRAFORGE_STAGE_SCOPE(MeshSection);
+			if (TerrainMaterial)
+			{
+				Chunk.Heightfield->SetMaterial(0, TerrainMaterial);
+			}
+			Chunk.Heightfield->SetMeshData(MoveTemp(Completed.CompactMesh));
+		}
+		else
+		{
+			// Full mesh collision is requested with the render section, so it is not uploaded twice
+			TERRAFORGE_STAGE_SCOPE(MeshSection);
+			Completed.Section.bEnableCollision = bCollision && CollisionMode == ETerraCollisionMode::FullMesh;
+			FTerrainMeshArena::InstallSection(Chunk.Mesh, 0, Completed.Section);
+			MeshArena->ReleaseSection(MoveTemp(Completed.Section));
+			if (TerrainMaterial)
+			{
+				Chunk.Mesh->SetMaterial(0, TerrainMaterial);
+			}
+		}
+		SetChunkCollision(Chunk, bCollision);
+
+		TotalChunkMemory += Chunk.MemoryBytes;
+		INC_MEMORY_STAT_BY(STAT_TerraForge_ChunkMemory, Chunk.MemoryBytes);
+		INC_DWORD_STAT(STAT_TerraForge_NumChunks);
+		Chunks.Add(Completed.Coord, MoveTemp(Chunk));
+	}
+}
+
+void ATerrainChunkManager::EnforceMemoryCap()
+{
+	const int64 MaxBytes = static_cast<int64>(MaxCacheMemoryMB) * 1024 * 1024;
+
+	while (TotalChunkMemory > MaxBytes)
+	{
+		// Least recently used hidden chunk; visible chunks are never evicted
+		FIntPoint OldestCoord;
+		uint64 OldestFrame = TNumericLimits<uint64>::Max();
+		for (const TPair<FIntPoint, FTerrainChunk>& Pair : Chunks)
+		{
+			if (!Pair.Value.bVisible && Pair.Value.LastUsedFrame < OldestFrame)
+			{
+				OldestFrame = Pair.Value.LastUsedFrame;
+				OldestCoord = Pair.Key;
+			}
+		}
+
+		if (OldestFrame == TNumericLimits<uint64>::Max())
+		{
+			if (!bWarnedOverBudget)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("TerrainChunkManager: visible chunks use %.1f MB, over MaxCacheMemoryMB %d. Reduce LoadRadius or ChunkQuads"),
+					GetChunkMemoryMB(), MaxCacheMemoryMB);
+				bWarnedOverBudget = true;
+			}
+			return;
+		}
+
+		FTerrainChunk& Chunk = Chunks.FindChecked(OldestCoord);
+		TotalChunkMemory -= Chunk.MemoryBytes;
+		ReleaseChunk(Chunk);
+		Chunks.Remove(OldestCoord);
+	}
+}
+
+void ATerrainChunkManager::SetChunkVisible(FTerrainChunk& Chunk, bool bVisible)
+{
+	Chunk.bVisible = bVisible;
+	if (Chunk.Heightfield)
+	{
+		Chunk.Heightfield->SetVisibility(bVisible);
+	}
+	else
+	{
+		Chunk.Mesh->SetVisibility(bVisible);
+	}
+}
+
+bool ATerrainChunkManager::WantsCollision(const FIntPoint& Coord, const FTerrainChunk& Chunk) const
+{
+	if (CollisionMode == ETerraCollisionMode::None || !Chunk.bVisible)
+	{
+		return false;
+	}
+
+	for (const FIntPoint& Center : CollisionCenters)
+	{
+		const FIntPoint Delta = Coord - Center;
+		if (Delta.X * Delta.X + Delta.Y * Delta.Y <= CollisionRadius * CollisionRadius)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ATerrainChunkManager::UpdateChunkCollision()
+{
+	TArray<FIntPoint, TInlineAllocator<8>> Centers;
+	FVector Location;
+	if (GetStreamingLocation(Location))
+	{
+		Centers.Add(WorldToChunk(Location));
+	}
+	for (const AActor* Source : CollisionSources)
+	{
+		if (Source)
+		{
+			Centers.AddUnique(WorldToChunk(Source->GetActorLocation()));
+		}
+	}
+
+	// Only walk the chunks when a source crossed into another chunk or the chunk set changed
+	if (!bCollisionDirty && Centers.Num() == CollisionCenters.Num() && FMemory::Memcmp(Centers.GetData(), CollisionCenters.GetData(), Centers.Num() * sizeof(FIntPoint)) == 0)
+	{
+		return;
+	}
+	CollisionCenters = Centers;
+	bCollisionDirty = false;
+
+	for (TPair<FIntPoint, FTerrainChunk>& Pair : Chunks)
+	{
+		SetChunkCollision(Pair.Value, WantsCollision(Pair.Key, Pair.Value));
+	}
+}
+
+void ATerrainChunkManager::SetChunkCollision(FTerrainChunk& Chunk, bool bCollision)
+{
+	if (Chunk.bCollision == bCollision)
+	{
+		return;
+	}
+	Chunk.bCollision = bCollision;
+
+	if (CollisionMode == ETerraCollisionMode::FullMesh && Chunk.Heightfield)
+	{
+		// Compact chunks have no render section to flag, so a collision-only section is rebuilt from the packed heights
+		if (bCollision)
+		{
+			const FTerrainCompactMesh& CompactMesh = *Chunk.Heightfield->GetMeshData();
+			TArray<FVector> Vertices;
+			Vertices.SetNumUninitialized(CompactMesh.Vertices.Num());
+			for (int32 Index = 0; Index < Vertices.Num(); Index++)
+			{
+				Vertices[Index] = CompactMesh.GetPosition(Index);
+			}
+			TArray<int32> Triangles;
+			CompactMesh.Topology->CopyIndices(Triangles);
+			Chunk.Mesh->CreateMeshSection(0, Vertices, Triangles, TArray<FVector>(), TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+		}
+		else
+		{
+			Chunk.Mesh->ClearMeshSection(0);
+		}
+	}
+	else if (CollisionMode == ETerraCollisionMode::FullMesh)
+	{
+		// Toggling a section's collision flag needs the section resubmitted; assigning it to itself copies nothing
+		FProcMeshSection* Section = Chunk.Mesh->GetProcMeshSection(0);
+		if (Section && Section->bEnableCollision != bCollision)
+		{
+			Section->bEnableCollision = bCollision;
+			Chunk.Mesh->SetProcMeshSection(0, *Section);
+		}
+	}
+	else if (CollisionMode == ETerraCollisionMode::Simplified)
+	{
+		// Section 1 holds the coarse grid. Hidden sections are skipped when drawing
+		if (bCollision)
+		{
+			Chunk.Mesh->CreateMeshSection(1, Chunk.CollisionVertices, Chunk.CollisionTriangles, TArray<FVector>(), TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>(), true);
+			Chunk.Mesh->SetMeshSectionVisible(1, false);
+		}
+		else
+		{
+			Chunk.Mesh->ClearMeshSection(1);
+		}
+	}
+
+	Chunk.Mesh->SetCollisionEnabled(bCollision ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+}
+
+UProceduralMeshComponent* ATerrainChunkManager::AcquireMesh()
+{
+	if (MeshPool.Num() > 0)
+	{
+		return MeshPool.Pop(EAllowShrinking::No);
+	}
+
+	UProceduralMeshComponent* Mesh = NewObject<UProceduralMeshComponent>(this);
+	Mesh->bUseAsyncCooking = true;
+	Mesh->SetupAttachment(Root);
+	Mesh->RegisterComponent();
+	return Mesh;
+}
+
+UTerrainHeightfieldComponent* ATerrainChunkManager::AcquireHeightfield()
+{
+	if (HeightfieldPool.Num() > 0)
+	{
+		return HeightfieldPool.Pop(EAllowShrinking::No);
+	}
+
+	UTerrainHeightfieldComponent* Heightfield = NewObject<UTerrainHeightfieldComponent>(this);
+	Heightfield->SetupAttachment(Root);
+	Heightfield->RegisterComponent();
+	return Heightfield;
+}
+
+void ATerrainChunkManager::ReleaseChunk(FTerrainChunk& Chunk)
+{
+	if (Chunk.Mesh)
+	{
+		DEC_MEMORY_STAT_BY(STAT_TerraForge_ChunkMemory, Chunk.MemoryBytes);
+		DEC_DWORD_STAT(STAT_TerraForge_NumChunks);
+
+		// Keep the render buffers for the next chunk instead of freeing them
+		if (FProcMeshSection* Section = Chunk.Mesh->GetProcMeshSection(0))
+		{
+			if (MeshArena.IsValid())
+			{
+				MeshArena->ReleaseSection(MoveTemp(*Section));
+			}
+			*Section = FProcMeshSection();
+		}
+		Chunk.Mesh->ClearAllMeshSections();
+		Chunk.Mesh->SetVisibility(false);
+		Chunk.Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Chunk.bCollision = false;
+		MeshPool.Add(Chunk.Mesh);
+		Chunk.Mesh = nullptr;
+	}
+
+	if (Chunk.Heightfield)
+	{
+		Chunk.Heightfield->ClearMeshData();
+		Chunk.Heightfield->SetVisibility(false);
+		HeightfieldPool.Add(Chunk.Heightfield);
+		Chunk.Heightfield = nullptr;
+	}
+}
+
+FTerrainBuildSettings ATerrainChunkManager::MakeChunkSettings(const FIntPoint& Coord) const
+{
+	const double ChunkSize = static_cast<double>(ChunkQuads) * GridSize;
+
+	FTerrainBuildSettings Settings;
+	Settings.Width = ChunkQuads;
+	Settings.Height = ChunkQuads;
+	Settings.GridSize = GridSize;
+	Settings.MaxHeight = MaxHeight;
+	Settings.NoiseOrigin = FVector2D(Coord.X * ChunkSize, Coord.Y * ChunkSize);
+	Settings.NoiseParams.NoiseType = bUseSimplexNoise ? ETerraNoiseType::Simplex : ETerraNoiseType::Perlin;
+	Settings.NoiseParams.Scale = NoiseScale;
+	Settings.NoiseParams.Octaves = Octaves;
+	Settings.NoiseParams.Persistence = Persistence;
+	Settings.NoiseParams.Lacunarity = Lacunarity;
+	Settings.NoiseParams.FractalMode = FractalMode;
+	Settings.NoiseParams.WarpStrength = WarpStrength;
+	Settings.Sampler = Sampler;
+	Settings.Heightmap = Heightmap;
+
+	// Chunks already build in parallel with each other, so each one stays on its own worker
+	Settings.bParallel = false;
+	Settings.bAnalyticNormals = bAnalyticNormals;
+	Settings.HydraulicErosion = HydraulicErosion;
+	Settings.ThermalErosion = ThermalErosion;
+	Settings.ThermalErosion.bProgressive = false;
+	Settings.Biome = Biome;
+	Settings.CollisionMode = CollisionMode;
+	Settings.CollisionGridStep = CollisionGridStep;
+	return Settings;
+}
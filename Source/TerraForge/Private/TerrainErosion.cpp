@@ -0,0 +1,571 @@
+// TerraForge - Procedural World Generator
+// Terrain Erosion Implementation
+
+#include "TerrainErosion.h"
+#include "TerrainMeshBuilder.h"
+#include "TerraForgeStats.h"
+#include "Async/ParallelFor.h"
+#include "Hash/xxhash.h"
+#include "Math/RandomStream.h"
+#include "Misc/ScopeLock.h"
+#include "Math/VectorRegister.h"
+
+// Cells per erosion tile along each axis, and how far a droplet may wander outside its tile.
+// Tiles are laid out on world cells, so every grid that reaches a tile erodes it the same way
+static constexpr int32 ErosionTileCells = 64;
+static constexpr int32 ErosionTileHalo = 32;
+static constexpr int32 ErosionRegionCells = ErosionTileCells + 2 * ErosionTileHalo;
+static_assert(2 * ErosionTileHalo <= ErosionTileCells, "A cell must lie in the regions of at most two erosion tiles per axis");
+
+// Eroded tiles kept by FErosionTileCache, at 64 KB each
+static constexpr int32 MaxCachedErosionTiles = 256;
+
+// Rows of the height grid relaxed by one worker per thermal step
+static constexpr int32 ThermalRowsPerBand = 16;
+
+/** Height grid shared by the droplets of one tile, in cell units */
+struct FErosionGrid
+{
+	float* Heights;
+	int32 NumColumns;
+
+	// Normalized heights to cells and back
+	float HeightScale;
+	float InvHeightScale;
+
+	/** Bilinear height and its gradient at a position inside cell (CellX, CellY) */
+	void Sample(int32 CellX, int32 CellY, float U, float V, float& OutHeight, float& OutGradientX, float& OutGradientY) const
+	{
+		const float* Corner = Heights + CellY * NumColumns + CellX;
+		const float HeightNW = Corner[0] * HeightScale;
+		const float HeightNE = Corner[1] * HeightScale;
+		const float HeightSW = Corner[NumColumns] * HeightScale;
+		const float HeightSE = Corner[NumColumns + 1] * HeightScale;
+
+		OutGradientX = (HeightNE - HeightNW) * (1.0f - V) + (HeightSE - HeightSW) * V;
+		OutGradientY = (HeightSW - HeightNW) * (1.0f - U) + (HeightSE - HeightNE) * U;
+		OutHeight = FMath::Lerp(FMath::Lerp(HeightNW, HeightNE, U), FMath::Lerp(HeightSW, HeightSE, U), V);
+	}
+
+	/** Spread Amount cells of material over the corners of a cell by bilinear weight */
+	void Apply(int32 CellX, int32 CellY, float U, float V, float Amount) const
+	{
+		const int32 Index = CellY * NumColumns + CellX;
+		const float Scaled = Amount * InvHeightScale;
+		Heights[Index] += Scaled * (1.0f - U) * (1.0f - V);
+		Heights[Index + 1] += Scaled * U * (1.0f - V);
+		Heights[Index + NumColumns] += Scaled * (1.0f - U) * V;
+		Heights[Index + NumColumns + 1] += Scaled * U * V;
+	}
+};
+
+/** One tile's share of the droplets, kept inside its region */
+struct FErosionTile
+{
+	// Droplets start in [SpawnMin, SpawnMax) and die on leaving [RegionMin, RegionMax)
+	FIntPoint SpawnMin;
+	FIntPoint SpawnMax;
+	FIntPoint RegionMin;
+	FIntPoint RegionMax;
+
+	int32 NumDroplets;
+	int32 RandomSeed;
+};
+
+static void ErodeTile(const FErosionGrid& Grid, const FErosionTile& Tile, const FTerraHydraulicErosionParams& Params)
+{
+	FRandomStream Random(Tile.RandomSeed);
+
+	// Cell corners are read at +1, so droplets stop one cell short of the region's far edge
+	const float MinX = static_cast<float>(Tile.RegionMin.X);
+	const float MinY = static_cast<float>(Tile.RegionMin.Y);
+	const float MaxX = static_cast<float>(Tile.RegionMax.X - 1);
+	const float MaxY = static_cast<float>(Tile.RegionMax.Y - 1);
+
+	for (int32 Droplet = 0; Droplet < Tile.NumDroplets; Droplet++)
+	{
+		float PositionX = Random.FRandRange(Tile.SpawnMin.X, Tile.SpawnMax.X);
+		float PositionY = Random.FRandRange(Tile.SpawnMin.Y, Tile.SpawnMax.Y);
+		float DirectionX = 0.0f;
+		float DirectionY = 0.0f;
+		float Speed = 1.0f;
+		float Water = 1.0f;
+		float Sediment = 0.0f;
+
+		for (int32 Step = 0; Step < Params.MaxLifetime; Step++)
+		{
+			const int32 CellX = FMath::Min(static_cast<int32>(PositionX), Tile.RegionMax.X - 2);
+			const int32 CellY = FMath::Min(static_cast<int32>(PositionY), Tile.RegionMax.Y - 2);
+			const float U = PositionX - CellX;
+			const float V = PositionY - CellY;
+
+			float Height, GradientX, GradientY;
+			Grid.Sample(CellX, CellY, U, V, Height, GradientX, GradientY);
+
+			// Blend the previous direction with downhill, then move one cell
+			DirectionX = DirectionX * Params.Inertia - GradientX * (1.0f - Params.Inertia);
+			DirectionY = DirectionY * Params.Inertia - GradientY * (1.0f - Params.Inertia);
+			const float Length = FMath::Sqrt(DirectionX * DirectionX + DirectionY * DirectionY);
+			if (Length < UE_SMALL_NUMBER)
+			{
+				break;
+			}
+			DirectionX /= Length;
+			DirectionY /= Length;
+
+			const float NewX = PositionX + DirectionX;
+			const float NewY = PositionY + DirectionY;
+			if (NewX < MinX || NewY < MinY || NewX >= MaxX || NewY >= MaxY)
+			{
+				break;
+			}
+
+			const int32 NewCellX = static_cast<int32>(NewX);
+			const int32 NewCellY = static_cast<int32>(NewY);
+			float NewHeight, UnusedX, UnusedY;
+			Grid.Sample(NewCellX, NewCellY, NewX - NewCellX, NewY - NewCellY, NewHeight, UnusedX, UnusedY);
+			const float DeltaHeight = NewHeight - Height;
+
+			// Fast, full droplets running downhill carry the most
+			const float Capacity = FMath::Max(-DeltaHeight * Speed * Water * Params.SedimentCapacity, Params.MinSedimentCapacity);
+			if (Sediment > Capacity || DeltaHeight > 0.0f)
+			{
+				// Uphill, fill the pit behind the droplet at most up to the new height
+				const float Deposit = DeltaHeight > 0.0f ? FMath::Min(DeltaHeight, Sediment) : (Sediment - Capacity) * Params.DepositSpeed;
+				Grid.Apply(CellX, CellY, U, V, Deposit);
+				Sediment -= Deposit;
+			}
+			else
+			{
+				// Never dig deeper than the drop, or the droplet would carve a pit
+				const float Erode = FMath::Min((Capacity - Sediment) * Params.ErodeSpeed, -DeltaHeight);
+				Grid.Apply(CellX, CellY, U, V, -Erode);
+				Sediment += Erode;
+			}
+
+			Speed = FMath::Sqrt(FMath::Max(Speed * Speed - DeltaHeight * Params.Gravity, 0.0f));
+			Water *= 1.0f - Params.EvaporateSpeed;
+			PositionX = NewX;
+			PositionY = NewY;
+		}
+	}
+}
+
+/** Floor of A / B for a positive B, rounding negative quotients down like world cell coordinates need */
+static FORCEINLINE int32 FloorDivide(int32 A, int32 B)
+{
+	return A >= 0 ? A / B : -((B - 1 - A) / B);
+}
+
+/** Hash of every setting that changes a tile's eroded heights, apart from the height source object itself */
+static uint64 MakeErosionTileKey(const FTerrainBuildSettings& Settings)
+{
+	// Fields are hashed one by one, so struct padding never reaches the hash
+	FXxHash64Builder Builder;
+	auto Add = [&Builder](const auto& Value)
+	{
+		Builder.Update(&Value, sizeof(Value));
+	};
+
+	Add(Settings.Sampler.GetSeed());
+	Add(Settings.Sampler.GetHashMode());
+	Add(Settings.NoiseParams.NoiseType);
+	Add(Settings.NoiseParams.Scale);
+	Add(Settings.NoiseParams.Octaves);
+	Add(Settings.NoiseParams.Persistence);
+	Add(Settings.NoiseParams.Lacunarity);
+	Add(Settings.NoiseParams.FractalMode);
+	Add(Settings.NoiseParams.WarpStrength);
+	Add(Settings.GridSize);
+	Add(Settings.MaxHeight);
+
+	const FTerraHydraulicErosionParams& Erosion = Settings.HydraulicErosion;
+	Add(Erosion.DropletsPerCell);
+	Add(Erosion.MaxLifetime);
+	Add(Erosion.Inertia);
+	Add(Erosion.SedimentCapacity);
+	Add(Erosion.MinSedimentCapacity);
+	Add(Erosion.ErodeSpeed);
+	Add(Erosion.DepositSpeed);
+	Add(Erosion.EvaporateSpeed);
+	Add(Erosion.Gravity);
+	Add(Erosion.Seed);
+	return Builder.Finalize().Hash;
+}
+
+/**
+ * Process-wide cache of the height change each world tile's droplets make to the tile's region, ErosionRegionCells squared values.
+ * Neighbouring chunks reach the same tiles, so each tile is simulated once instead of by every chunk around it.
+ * Holds MaxCachedErosionTiles tiles, least recently used first out
+ */
+class FErosionTileCache
+{
+public:
+	using FDelta = TSharedRef<const TArray<float>, ESPMode::ThreadSafe>;
+	using FHeightSource = TSharedPtr<const void, ESPMode::ThreadSafe>;
+
+	static FErosionTileCache& Get()
+	{
+		static FErosionTileCache Instance;
+		return Instance;
+	}
+
+	/** Cached change of a tile, or null */
+	TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> Find(uint64 SettingsKey, const FIntPoint& Tile, const FHeightSource& HeightSource)
+	{
+		FScopeLock ScopeLock(&Lock);
+		FEntry* Entry = Tiles.Find(FKey{ SettingsKey, Tile });
+
+		// A program or heightmap that has since been freed may share its address with the current one, but its weak pointer has expired
+		if (!Entry || Entry->HeightSource.Pin() != HeightSource)
+		{
+			return nullptr;
+		}
+		Entry->LastUse = ++UseClock;
+		return Entry->Delta;
+	}
+
+	void Add(uint64 SettingsKey, const FIntPoint& Tile, const FHeightSource& HeightSource, const FDelta& Delta)
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (Tiles.Num() >= MaxCachedErosionTiles && !Tiles.Contains(FKey{ SettingsKey, Tile }))
+		{
+			const FKey* Oldest = nullptr;
+			uint64 OldestUse = TNumericLimits<uint64>::Max();
+			for (const TPair<FKey, FEntry>& Pair : Tiles)
+			{
+				if (Pair.Value.LastUse < OldestUse)
+				{
+					Oldest = &Pair.Key;
+					OldestUse = Pair.Value.LastUse;
+				}
+			}
+			Tiles.Remove(FKey(*Oldest));
+		}
+		Tiles.Add(FKey{ SettingsKey, Tile }, FEntry{ Delta, HeightSource, ++UseClock });
+	}
+
+	void Empty()
+	{
+		FScopeLock ScopeLock(&Lock);
+		Tiles.Empty();
+	}
+
+private:
+	struct FKey
+	{
+		uint64 SettingsKey;
+		FIntPoint Tile;
+
+		bool operator==(const FKey& Other) const
+		{
+			return SettingsKey == Other.SettingsKey && Tile == Other.Tile;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(::GetTypeHash(Key.SettingsKey), ::GetTypeHash(Key.Tile));
+		}
+	};
+
+	struct FEntry
+	{
+		FDelta Delta;
+
+		// Program or heightmap the heights came from, null for the built-in noise
+		TWeakPtr<const void, ESPMode::ThreadSafe> HeightSource;
+
+		// UseClock value of the last lookup
+		uint64 LastUse;
+	};
+
+	FCriticalSection Lock;
+	TMap<FKey, FEntry> Tiles;
+	uint64 UseClock = 0;
+};
+
+void FTerrainErosion::EmptyTileCache()
+{
+	FErosionTileCache::Get().Empty();
+}
+
+int32 FTerrainErosion::ApplyHydraulic(const FTerrainBuildSettings& Settings, TArray<float>& Heights)
+{
+	TERRAFORGE_STAGE_SCOPE(HydraulicErosion);
+
+	const FTerraHydraulicErosionParams& Params = Settings.HydraulicErosion;
+	const int32 NumColumns = Settings.Width + 3;
+	const int32 NumRows = Settings.Height + 3;
+	if (!Params.bEnabled || Params.DropletsPerCell <= 0.0f || Heights.Num() != NumColumns * NumRows || Settings.MaxHeight <= 0.0f || Settings.GridSize <= 0.0f)
+	{
+		return 0;
+	}
+
+	// World cells covered by the halo grid. Chunk origins are whole multiples of the grid size, so neighbours agree on them
+	const FIntPoint GridMin(FMath::RoundToInt32(Settings.NoiseOrigin.X / Settings.GridSize) - 1, FMath::RoundToInt32(Settings.NoiseOrigin.Y / Settings.GridSize) - 1);
+	const FIntPoint GridMax = GridMin + FIntPoint(NumColumns, NumRows);
+
+	// Every tile whose region reaches the grid, inclusive
+	const FIntPoint TileMin(FloorDivide(GridMin.X - ErosionTileCells - ErosionTileHalo, ErosionTileCells) + 1,
+		FloorDivide(GridMin.Y - ErosionTileCells - ErosionTileHalo, ErosionTileCells) + 1);
+	const FIntPoint TileMax(FloorDivide(GridMax.X + ErosionTileHalo - 1, ErosionTileCells), FloorDivide(GridMax.Y + ErosionTileHalo - 1, ErosionTileCells));
+	const FIntPoint NumTiles = TileMax - TileMin + FIntPoint(1, 1);
+	const int32 NumTileCount = NumTiles.X * NumTiles.Y;
+
+	// Tiles other grids have already eroded with the same settings and height source
+	FErosionTileCache& Cache = FErosionTileCache::Get();
+	const uint64 SettingsKey = MakeErosionTileKey(Settings);
+	const FErosionTileCache::FHeightSource HeightSource = Settings.Heightmap.IsValid()
+		? FErosionTileCache::FHeightSource(Settings.Heightmap) : FErosionTileCache::FHeightSource(Settings.HeightProgram);
+
+	TArray<TSharedPtr<const TArray<float>, ESPMode::ThreadSafe>> Deltas;
+	Deltas.SetNum(NumTileCount);
+	TArray<int32> MissingTiles;
+	for (int32 TileIndex = 0; TileIndex < NumTileCount; TileIndex++)
+	{
+		const FIntPoint TileCoord = TileMin + FIntPoint(TileIndex % NumTiles.X, TileIndex / NumTiles.X);
+		Deltas[TileIndex] = Cache.Find(SettingsKey, TileCoord, HeightSource);
+		if (!Deltas[TileIndex].IsValid())
+		{
+			MissingTiles.Add(TileIndex);
+		}
+	}
+
+	FErosionTile Tile;
+	Tile.SpawnMin = FIntPoint(ErosionTileHalo, ErosionTileHalo);
+	Tile.SpawnMax = Tile.SpawnMin + FIntPoint(ErosionTileCells, ErosionTileCells);
+	Tile.RegionMin = FIntPoint(0, 0);
+	Tile.RegionMax = FIntPoint(ErosionRegionCells, ErosionRegionCells);
+	Tile.NumDroplets = FMath::RoundToInt(Params.DropletsPerCell * ErosionTileCells * ErosionTileCells);
+	Tile.RandomSeed = 0;
+
+	// Droplets depend on the seeds and the world tile only, never on the grid being built
+	const uint32 BaseSeed = HashCombine(GetTypeHash(Settings.Sampler.GetSeed()), GetTypeHash(Params.Seed));
+
+	// Each missing tile samples and erodes its own region from the un-eroded heights, so tiles never wait on each other
+	ParallelFor(MissingTiles.Num(), [&](int32 MissingIndex)
+	{
+		LLM_SCOPE_BYTAG(TerraForge);
+		const int32 TileIndex = MissingTiles[MissingIndex];
+		const FIntPoint TileCoord = TileMin + FIntPoint(TileIndex % NumTiles.X, TileIndex / NumTiles.X);
+		const FIntPoint RegionMin = TileCoord * ErosionTileCells - FIntPoint(ErosionTileHalo, ErosionTileHalo);
+
+		// Sampled from the tile's own origin, so every grid reads exactly the same heights. GenerateHeights adds its own halo ring,
+		// so its origin sits one cell past RegionMin and its size is three cells short of the region
+		FTerrainBuildSettings RegionSettings = Settings;
+		RegionSettings.Width = ErosionRegionCells - 3;
+		RegionSettings.Height = ErosionRegionCells - 3;
+		RegionSettings.NoiseOrigin = FVector2D((RegionMin.X + 1) * static_cast<double>(Settings.GridSize), (RegionMin.Y + 1) * static_cast<double>(Settings.GridSize));
+		RegionSettings.bAnalyticNormals = false;
+		RegionSettings.bParallel = false;
+		TArray<float> Original;
+		TArray<float> UnusedGradientX;
+		TArray<float> UnusedGradientY;
+		FTerrainMeshBuilder::GenerateHeights(RegionSettings, Original, UnusedGradientX, UnusedGradientY);
+
+		TSharedRef<TArray<float>, ESPMode::ThreadSafe> Delta = MakeShared<TArray<float>, ESPMode::ThreadSafe>(Original);
+		FErosionGrid Grid;
+		Grid.Heights = Delta->GetData();
+		Grid.NumColumns = ErosionRegionCells;
+		Grid.HeightScale = Settings.MaxHeight / Settings.GridSize;
+		Grid.InvHeightScale = 1.0f / Grid.HeightScale;
+
+		FErosionTile WorldTile = Tile;
+		WorldTile.RandomSeed = static_cast<int32>(HashCombine(BaseSeed, HashCombine(GetTypeHash(TileCoord.X), GetTypeHash(TileCoord.Y))));
+		ErodeTile(Grid, WorldTile, Params);
+
+		float* DeltaData = Delta->GetData();
+		for (int32 Index = 0; Index < Original.Num(); Index++)
+		{
+			DeltaData[Index] -= Original[Index];
+		}
+		Deltas[TileIndex] = Delta;
+		Cache.Add(SettingsKey, TileCoord, HeightSource, Delta);
+	}, Settings.bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	// Add each tile's change in world tile order, so a cell shared with a neighbouring grid sums the same changes in the same order
+	for (int32 TileIndex = 0; TileIndex < NumTileCount; TileIndex++)
+	{
+		const FIntPoint TileCoord = TileMin + FIntPoint(TileIndex % NumTiles.X, TileIndex / NumTiles.X);
+		const FIntPoint RegionMin = TileCoord * ErosionTileCells - FIntPoint(ErosionTileHalo, ErosionTileHalo);
+		const int32 FirstColumn = FMath::Max(RegionMin.X, GridMin.X);
+		const int32 EndColumn = FMath::Min(RegionMin.X + ErosionRegionCells, GridMax.X);
+		const int32 FirstRow = FMath::Max(RegionMin.Y, GridMin.Y);
+		const int32 EndRow = FMath::Min(RegionMin.Y + ErosionRegionCells, GridMax.Y);
+
+		const float* Delta = Deltas[TileIndex]->GetData();
+		for (int32 Y = FirstRow; Y < EndRow; Y++)
+		{
+			const float* Source = Delta + (Y - RegionMin.Y) * ErosionRegionCells + (FirstColumn - RegionMin.X);
+			float* Dest = Heights.GetData() + (Y - GridMin.Y) * NumColumns + (FirstColumn - GridMin.X);
+			for (int32 Column = 0; Column < EndColumn - FirstColumn; Column++)
+			{
+				Dest[Column] += Source[Column];
+			}
+		}
+	}
+
+	const int32 NumDroplets = Tile.NumDroplets * MissingTiles.Num();
+	INC_DWORD_STAT_BY(STAT_TerraForge_ErosionDroplets, NumDroplets);
+	INC_DWORD_STAT_BY(STAT_TerraForge_ErosionTilesReused, NumTileCount - MissingTiles.Num());
+	return NumDroplets;
+}
+
+/** Part of a height difference beyond the talus limit, which is what slides down */
+static FORCEINLINE float TalusExcess(float Delta, float Talus)
+{
+	return Delta - FMath::Clamp(Delta, -Talus, Talus);
+}
+
+static FORCEINLINE VectorRegister4Float TalusExcess(VectorRegister4Float Delta, VectorRegister4Float Talus, VectorRegister4Float NegTalus)
+{
+	return VectorSubtract(Delta, VectorMin(VectorMax(Delta, NegTalus), Talus));
+}
+
+/**
+ * One thermal step over the cells [FirstColumn, EndColumn) of a row. Each cell gives up Rate / 4 of its excess over every lower neighbour
+ * and takes the same share from every higher one, which is exactly what those neighbours compute for themselves, so material is conserved
+ */
+static void RelaxThermalRow(const float* Source, float* Dest, int32 NumColumns, int32 FirstColumn, int32 EndColumn, float Talus, float Rate)
+{
+	const float Share = 0.25f * Rate;
+	int32 Column = FirstColumn;
+
+	const VectorRegister4Float TalusV = VectorSetFloat1(Talus);
+	const VectorRegister4Float NegTalusV = VectorSetFloat1(-Talus);
+	const VectorRegister4Float ShareV = VectorSetFloat1(Share);
+	for (; Column + 4 <= EndColumn; Column += 4)
+	{
+		const float* Center = Source + Column;
+		const VectorRegister4Float Height = VectorLoad(Center);
+		VectorRegister4Float Excess = TalusExcess(VectorSubtract(Height, VectorLoad(Center - 1)), TalusV, NegTalusV);
+		Excess = VectorAdd(Excess, TalusExcess(VectorSubtract(Height, VectorLoad(Center + 1)), TalusV, NegTalusV));
+		Excess = VectorAdd(Excess, TalusExcess(VectorSubtract(Height, VectorLoad(Center - NumColumns)), TalusV, NegTalusV));
+		Excess = VectorAdd(Excess, TalusExcess(VectorSubtract(Height, VectorLoad(Center + NumColumns)), TalusV, NegTalusV));
+		VectorStore(VectorSubtract(Height, VectorMultiply(Excess, ShareV)), Dest + Column);
+	}
+
+	for (; Column < EndColumn; Column++)
+	{
+		const float* Center = Source + Column;
+		const float Height = *Center;
+		const float Excess = TalusExcess(Height - Center[-1], Talus) + TalusExcess(Height - Center[1], Talus)
+			+ TalusExcess(Height - Center[-NumColumns], Talus) + TalusExcess(Height - Center[NumColumns], Talus);
+		Dest[Column] = Height - Excess * Share;
+	}
+}
+
+bool FTerrainErosion::CanApplyThermal(const FTerrainBuildSettings& Settings)
+{
+	return Settings.MaxHeight > 0.0f && Settings.GridSize > 0.0f;
+}
+
+FTerrainBuildSettings FTerrainErosion::MakeThermalSourceSettings(const FTerrainBuildSettings& Settings)
+{
+	// Material moves at most one cell per step, so the padding keeps the fixed outer ring's influence out of the grid
+	const int32 Padding = FMath::Max(Settings.ThermalErosion.Iterations, 0);
+	FTerrainBuildSettings SourceSettings = Settings;
+	SourceSettings.Width = Settings.Width + 2 * Padding;
+	SourceSettings.Height = Settings.Height + 2 * Padding;
+	SourceSettings.NoiseOrigin = Settings.NoiseOrigin - FVector2D(Padding * static_cast<double>(Settings.GridSize), Padding * static_cast<double>(Settings.GridSize));
+	SourceSettings.bAnalyticNormals = false;
+	return SourceSettings;
+}
+
+void FTerrainErosion::SampleThermalSource(const FTerrainBuildSettings& Settings, TArray<float>& OutSource)
+{
+	const FTerrainBuildSettings SourceSettings = MakeThermalSourceSettings(Settings);
+	TArray<float> UnusedGradientX;
+	TArray<float> UnusedGradientY;
+	FTerrainMeshBuilder::GenerateHeights(SourceSettings, OutSource, UnusedGradientX, UnusedGradientY);
+
+	// Droplets are placed by world tile, so the padded grid erodes its share of cells exactly like the grid itself
+	if (SourceSettings.HydraulicErosion.bEnabled)
+	{
+		ApplyHydraulic(SourceSettings, OutSource);
+	}
+}
+
+void FTerrainErosion::CopyThermalResult(const FTerrainBuildSettings& Settings, const TArray<float>& Source, TArray<float>& Heights)
+{
+	const int32 Padding = FMath::Max(Settings.ThermalErosion.Iterations, 0);
+	const int32 NumColumns = Settings.Width + 3;
+	const int32 NumRows = Settings.Height + 3;
+	const int32 SourceColumns = NumColumns + 2 * Padding;
+	check(Source.Num() == SourceColumns * (NumRows + 2 * Padding));
+
+	Heights.SetNumUninitialized(NumColumns * NumRows);
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		FMemory::Memcpy(Heights.GetData() + Row * NumColumns, Source.GetData() + (Row + Padding) * SourceColumns + Padding, NumColumns * sizeof(float));
+	}
+}
+
+void FTerrainErosion::ApplyThermalSeamless(const FTerrainBuildSettings& Settings, TArray<float>& Heights)
+{
+	if (!Settings.ThermalErosion.bEnabled || Settings.ThermalErosion.Iterations <= 0 || !CanApplyThermal(Settings))
+	{
+		return;
+	}
+
+	TArray<float> Source;
+	TArray<float> Scratch;
+	SampleThermalSource(Settings, Source);
+	ApplyThermal(MakeThermalSourceSettings(Settings), Source, Scratch, Settings.ThermalErosion.Iterations);
+	CopyThermalResult(Settings, Source, Heights);
+}
+
+int32 FTerrainErosion::ApplyThermal(const FTerrainBuildSettings& Settings, TArray<float>& Heights, TArray<float>& Scratch, int32 MaxIterations, double TimeBudgetSeconds)
+{
+	TERRAFORGE_STAGE_SCOPE(ThermalErosion);
+
+	const FTerraThermalErosionParams& Params = Settings.ThermalErosion;
+	const int32 NumColumns = Settings.Width + 3;
+	const int32 NumRows = Settings.Height + 3;
+
+	// The outer ring has no neighbours outside the grid, so it is only ever read
+	const int32 FirstCell = 1;
+	if (MaxIterations <= 0 || !CanApplyThermal(Settings) || Heights.Num() != NumColumns * NumRows)
+	{
+		return 0;
+	}
+
+	// Largest stable height step between neighbours, in normalized heights
+	const float Talus = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(Params.TalusAngle, 0.0f, 89.0f))) * Settings.GridSize / Settings.MaxHeight;
+	const float Rate = FMath::Clamp(Params.Rate, 0.0f, 1.0f);
+
+	// Both buffers start with the fixed ring
+	Scratch = Heights;
+
+	const int32 EndColumn = NumColumns - FirstCell;
+	const int32 NumInteriorRows = NumRows - 2 * FirstCell;
+	const int32 NumBands = FMath::DivideAndRoundUp(NumInteriorRows, ThermalRowsPerBand);
+	const double StartTime = FPlatformTime::Seconds();
+
+	int32 Iteration = 0;
+	while (Iteration < MaxIterations)
+	{
+		const float* Source = Heights.GetData();
+		float* Dest = Scratch.GetData();
+		ParallelFor(NumBands, [Source, Dest, NumColumns, FirstCell, EndColumn, NumInteriorRows, Talus, Rate](int32 Band)
+		{
+			LLM_SCOPE_BYTAG(TerraForge);
+			const int32 FirstRow = FirstCell + Band * ThermalRowsPerBand;
+			const int32 EndRow = FirstCell + FMath::Min((Band + 1) * ThermalRowsPerBand, NumInteriorRows);
+			for (int32 Row = FirstRow; Row < EndRow; Row++)
+			{
+				RelaxThermalRow(Source + Row * NumColumns, Dest + Row * NumColumns, NumColumns, FirstCell, EndColumn, Talus, Rate);
+			}
+		}, Settings.bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+		// Swapping the arrays swaps their allocations, so Heights holds the newest step without a copy
+		Swap(Heights, Scratch);
+		Iteration++;
+
+		if (TimeBudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= TimeBudgetSeconds)
+		{
+			break;
+		}
+	}
+	return Iteration;
+}
@@ -0,0 +1,198 @@
+// TerraForge - Procedural World Generator
+// Terrain Heightfield Component Implementation
+
+#include "TerrainHeightfieldComponent.h"
+#include "PrimitiveSceneProxy.h"
+#include "PrimitiveViewRelevance.h"
+#include "SceneInterface.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRenderProxy.h"
+#include "RHIResourceUtils.h"
+
+/** GPU copy of the compact vertices */
+class FTerrainCompactVertexBuffer : public FVertexBuffer
+{
+public:
+	explicit FTerrainCompactVertexBuffer(TSharedRef<const FTerrainCompactMesh, ESPMode::ThreadSafe> InMesh)
+		: Mesh(MoveTemp(InMesh))
+	{
+	}
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		VertexBufferRHI = UE::RHIResourceUtils::CreateVertexBufferFromArray(RHICmdList, TEXT("TerrainCompactVertices"), EBufferUsageFlags::Static, MakeConstArrayView(Mesh->Vertices));
+	}
+
+private:
+	TSharedRef<const FTerrainCompactMesh, ESPMode::ThreadSafe> Mesh;
+};
+
+/** GPU copy of the grid topology, 16-bit whenever the topology is */
+class FTerrainTopologyIndexBuffer : public FIndexBuffer
+{
+public:
+	explicit FTerrainTopologyIndexBuffer(TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> InTopology)
+		: Topology(MoveTemp(InTopology))
+	{
+	}
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		if (Topology->Is16Bit())
+		{
+			IndexBufferRHI = UE::RHIResourceUtils::CreateIndexBufferFromArray(RHICmdList, TEXT("TerrainTopologyIndices"), EBufferUsageFlags::Static, MakeConstArrayView(Topology->Indices16));
+		}
+		else
+		{
+			const TConstArrayView<uint32> Indices(reinterpret_cast<const uint32*>(Topology->Indices32.GetData()), Topology->Indices32.Num());
+			IndexBufferRHI = UE::RHIResourceUtils::CreateIndexBufferFromArray(RHICmdList, TEXT("TerrainTopologyIndices"), EBufferUsageFlags::Static, Indices);
+		}
+	}
+
+private:
+	TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> Topology;
+};
+
+/**
+ * Static scene proxy for one heightfield. Mesh batches are cached by the renderer, so nothing is rebuilt per frame
+ */
+class FTerrainHeightfieldSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+	FTerrainHeightfieldSceneProxy(UTerrainHeightfieldComponent* Component, TSharedRef<const FTerrainCompactMesh, ESPMode::ThreadSafe> InMesh)
+		: FPrimitiveSceneProxy(Component)
+		, Mesh(InMesh)
+		, VertexBuffer(InMesh)
+		, IndexBuffer(InMesh->Topology.ToSharedRef())
+		, VertexFactory(GetScene().GetFeatureLevel())
+		, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetShaderPlatform()))
+	{
+		// Only materials used with the heightfield usage compile the compact vertex factory; in the editor the check sets the flag
+		Material = Component->GetMaterial(0);
+		if (!Material || !Material->CheckMaterialUsage_Concurrent(MATUSAGE_VirtualHeightfieldMesh))
+		{
+			Material = UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+
+		// The vertex factory reads the primitive uniform buffer rather than GPU scene
+		bVFRequiresPrimitiveUniformBuffer = true;
+
+		VertexFactory.SetData(&VertexBuffer, InMesh->Layout);
+	}
+
+	virtual ~FTerrainHeightfieldSceneProxy() override
+	{
+		VertexBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override
+	{
+		VertexBuffer.InitResource(RHICmdList);
+		IndexBuffer.InitResource(RHICmdList);
+		VertexFactory.InitResource(RHICmdList);
+	}
+
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override
+	{
+		FMeshBatch MeshBatch;
+		MeshBatch.VertexFactory = &VertexFactory;
+		MeshBatch.MaterialRenderProxy = Material->GetRenderProxy();
+		MeshBatch.ReverseCulling = IsLocalToWorldDeterminantNegative();
+		MeshBatch.Type = PT_TriangleList;
+		MeshBatch.DepthPriorityGroup = SDPG_World;
+		MeshBatch.CastShadow = true;
+		MeshBatch.LODIndex = 0;
+
+		FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
+		BatchElement.IndexBuffer = &IndexBuffer;
+		BatchElement.FirstIndex = 0;
+		BatchElement.NumPrimitives = Mesh->Topology->GetNumIndices() / 3;
+		BatchElement.MinVertexIndex = 0;
+		BatchElement.MaxVertexIndex = Mesh->Vertices.Num() - 1;
+		BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+
+		PDI->DrawMesh(MeshBatch, FLT_MAX);
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		FPrimitiveViewRelevance Result;
+		Result.bDrawRelevance = IsShown(View);
+		Result.bShadowRelevance = IsShadowCast(View);
+		Result.bStaticRelevance = true;
+		Result.bRenderInMainPass = ShouldRenderInMainPass();
+		Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+		Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+		MaterialRelevance.SetPrimitiveViewRelevance(Result);
+		Result.bVelocityRelevance = DrawsVelocity() && Result.bOpaque && Result.bRenderInMainPass;
+		return Result;
+	}
+
+	virtual bool CanBeOccluded() const override
+	{
+		return !MaterialRelevance.bDisableDepthTest;
+	}
+
+	virtual uint32 GetMemoryFootprint() const override
+	{
+		return sizeof(*this) + GetAllocatedSize();
+	}
+
+private:
+	// Kept alive for the vertex and index buffers, which upload from it
+	TSharedRef<const FTerrainCompactMesh, ESPMode::ThreadSafe> Mesh;
+
+	FTerrainCompactVertexBuffer VertexBuffer;
+	FTerrainTopologyIndexBuffer IndexBuffer;
+	FTerrainCompactVertexFactory VertexFactory;
+
+	UMaterialInterface* Material = nullptr;
+	FMaterialRelevance MaterialRelevance;
+};
+
+UTerrainHeightfieldComponent::UTerrainHeightfieldComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Render only; collision stays with procedural mesh sections
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	SetCanEverAffectNavigation(false);
+}
+
+void UTerrainHeightfieldComponent::SetMeshData(TSharedPtr<const FTerrainCompactMesh, ESPMode::ThreadSafe> InMeshData)
+{
+	MeshData = MoveTemp(InMeshData);
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UTerrainHeightfieldComponent::ClearMeshData()
+{
+	SetMeshData(nullptr);
+}
+
+FPrimitiveSceneProxy* UTerrainHeightfieldComponent::CreateSceneProxy()
+{
+	if (!MeshData.IsValid() || !MeshData->Topology.IsValid() || MeshData->Vertices.Num() == 0)
+	{
+		return nullptr;
+	}
+	return new FTerrainHeightfieldSceneProxy(this, MeshData.ToSharedRef());
+}
+
+FBoxSphereBounds UTerrainHeightfieldComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!MeshData.IsValid())
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0);
+	}
+	return FBoxSphereBounds(MeshData->LocalBounds).TransformBy(LocalToWorld);
+}
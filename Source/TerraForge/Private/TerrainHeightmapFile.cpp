@@ -0,0 +1,505 @@
+// TerraForge - Procedural World Generator
+// Terrain Heightmap File Implementation
+
+#include "TerrainHeightmapFile.h"
+#include "TerraForgeStats.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/xxhash.h"
+#include "Misc/Compression.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+// Bump when the file layout or the tile encoding changes
+static constexpr uint32 HeightmapFileMagic = 0x4D484654; // "TFHM"
+static constexpr uint32 HeightmapFileVersion = 1;
+
+// Tile data starts on this alignment, so uncompressed tiles can be read in place as uint16
+static constexpr int64 HeightmapTileAlignment = 16;
+
+/**
+ * File header, followed by one FTerrainHeightmapTileEntry per tile, row by row, and then the tile data
+ */
+struct FHeightmapFileHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	int32 TileQuads;
+	int32 TilesX;
+	int32 TilesY;
+	float GridSize;
+	uint64 IndexHash;
+};
+
+static_assert(sizeof(FTerrainHeightmapTileEntry) == 16, "Heightmap index entries are stored as is");
+
+static FName GetCodecFormatName(ETerraHeightmapCodec Codec)
+{
+	return Codec == ETerraHeightmapCodec::Oodle ? NAME_Oodle : NAME_LZ4;
+}
+
+static int64 GetIndexOffset()
+{
+	return sizeof(FHeightmapFileHeader);
+}
+
+static int64 GetTileBytes(const FTerrainHeightmapLayout& Layout)
+{
+	return static_cast<int64>(Layout.GetTileSamples()) * Layout.GetTileSamples() * sizeof(uint16);
+}
+
+/**
+ * Replace each sample with its difference from the one to the left, or above for the first column, and split the
+ * result into a low-byte plane and a high-byte plane. Smooth terrain then becomes long runs of small values that LZ4 and Oodle compress well
+ */
+static void EncodeTileDeltas(TConstArrayView<uint16> Samples, int32 NumColumns, TArray<uint8>& Out)
+{
+	const int32 NumSamples = Samples.Num();
+	Out.SetNumUninitialized(NumSamples * 2);
+	uint8* LowBytes = Out.GetData();
+	uint8* HighBytes = LowBytes + NumSamples;
+
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		const int32 Column = Index % NumColumns;
+		const uint16 Prediction = Column > 0 ? Samples[Index - 1] : (Index >= NumColumns ? Samples[Index - NumColumns] : 0);
+		const uint16 Delta = static_cast<uint16>(Samples[Index] - Prediction);
+		LowBytes[Index] = static_cast<uint8>(Delta & 0xFF);
+		HighBytes[Index] = static_cast<uint8>(Delta >> 8);
+	}
+}
+
+/** Inverse of EncodeTileDeltas */
+static void DecodeTileDeltas(const uint8* Encoded, int32 NumSamples, int32 NumColumns, uint16* Out)
+{
+	const uint8* LowBytes = Encoded;
+	const uint8* HighBytes = Encoded + NumSamples;
+
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		const int32 Column = Index % NumColumns;
+		const uint16 Prediction = Column > 0 ? Out[Index - 1] : (Index >= NumColumns ? Out[Index - NumColumns] : 0);
+		const uint16 Delta = static_cast<uint16>(LowBytes[Index] | (HighBytes[Index] << 8));
+		Out[Index] = static_cast<uint16>(Prediction + Delta);
+	}
+}
+
+FTerrainHeightmapTile::~FTerrainHeightmapTile() = default;
+
+struct FTerrainHeightmapFile::FTileLookup
+{
+	explicit FTileLookup(const FTerrainHeightmapFile& InFile)
+		: File(InFile)
+	{
+	}
+
+	const FTerrainHeightmapTile* Find(int32 TileIndex)
+	{
+		// Neighbouring samples nearly always hit the same tile as the previous one
+		if (TileIndex == LastIndex)
+		{
+			return LastTile;
+		}
+
+		TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>* Found = nullptr;
+		for (TPair<int32, TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>>& Entry : Tiles)
+		{
+			if (Entry.Key == TileIndex)
+			{
+				Found = &Entry.Value;
+				break;
+			}
+		}
+		if (!Found)
+		{
+			Found = &Tiles.Emplace_GetRef(TileIndex, File.FindOrLoadTile(TileIndex)).Value;
+		}
+
+		LastIndex = TileIndex;
+		LastTile = Found->Get();
+		return LastTile;
+	}
+
+	const FTerrainHeightmapFile& File;
+
+	// Held until the lookup ends, so eviction from the shared cache cannot free a tile mid-call
+	TArray<TPair<int32, TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>>, TInlineAllocator<4>> Tiles;
+
+	int32 LastIndex = INDEX_NONE;
+	const FTerrainHeightmapTile* LastTile = nullptr;
+};
+
+TSharedPtr<const FTerrainHeightmapFile, ESPMode::ThreadSafe> FTerrainHeightmapFile::Open(const FString& Path, int32 MaxCachedTiles)
+{
+	TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!Handle || Handle->GetFileSize() < GetIndexOffset())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: could not open %s"), *Path);
+		return nullptr;
+	}
+
+	FHeightmapFileHeader Header;
+	{
+		TUniquePtr<IMappedFileRegion> HeaderRegion(Handle->MapRegion(0, sizeof(FHeightmapFileHeader)));
+		if (!HeaderRegion)
+		{
+			return nullptr;
+		}
+		FMemory::Memcpy(&Header, HeaderRegion->GetMappedPtr(), sizeof(Header));
+	}
+
+	if (Header.Magic != HeightmapFileMagic || Header.Version != HeightmapFileVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: %s is not a TerraForge heightmap of version %u"), *Path, HeightmapFileVersion);
+		return nullptr;
+	}
+
+	// The header is untrusted, so its sizes are bounded before anything is multiplied or mapped from them
+	FTerrainHeightmapLayout HeaderLayout;
+	HeaderLayout.TileQuads = Header.TileQuads;
+	HeaderLayout.TilesX = Header.TilesX;
+	HeaderLayout.TilesY = Header.TilesY;
+	HeaderLayout.GridSize = Header.GridSize;
+	if (!HeaderLayout.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: %s has an invalid layout (%d x %d tiles of %d quads)"), *Path, Header.TilesX, Header.TilesY, Header.TileQuads);
+		return nullptr;
+	}
+
+	TSharedPtr<FTerrainHeightmapFile, ESPMode::ThreadSafe> File = MakeShareable(new FTerrainHeightmapFile());
+	File->Path = Path;
+	File->Layout = HeaderLayout;
+	File->MaxCachedTiles = FMath::Max(MaxCachedTiles, 1);
+
+	const int32 NumTiles = HeaderLayout.GetNumTiles();
+	const int64 IndexBytes = NumTiles * static_cast<int64>(sizeof(FTerrainHeightmapTileEntry));
+	if (Handle->GetFileSize() < GetIndexOffset() + IndexBytes)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: %s is truncated"), *Path);
+		return nullptr;
+	}
+
+	{
+		TUniquePtr<IMappedFileRegion> IndexRegion(Handle->MapRegion(GetIndexOffset(), IndexBytes));
+		if (!IndexRegion || FXxHash64::HashBuffer(IndexRegion->GetMappedPtr(), IndexBytes).Hash != Header.IndexHash)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: %s has a corrupt tile index"), *Path);
+			return nullptr;
+		}
+		File->Index.SetNumUninitialized(NumTiles);
+		FMemory::Memcpy(File->Index.GetData(), IndexRegion->GetMappedPtr(), IndexBytes);
+	}
+
+	// Reject out of range tiles up front, so LoadTile only has to check the decoded data
+	const int64 TileBytes = GetTileBytes(File->Layout);
+	for (const FTerrainHeightmapTileEntry& Entry : File->Index)
+	{
+		const bool bRaw = Entry.Codec == static_cast<uint32>(ETerraHeightmapCodec::None);
+		const uint64 FileSize = static_cast<uint64>(Handle->GetFileSize());
+		if (Entry.Offset < static_cast<uint64>(GetIndexOffset() + IndexBytes) || Entry.Offset > FileSize || Entry.Size > FileSize - Entry.Offset
+			|| Entry.Codec > static_cast<uint32>(ETerraHeightmapCodec::Oodle) || (bRaw && Entry.Size != TileBytes))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: %s has an invalid tile entry"), *Path);
+			return nullptr;
+		}
+	}
+
+	File->Handle = TSharedPtr<IMappedFileHandle, ESPMode::ThreadSafe>(Handle.Release());
+	return File;
+}
+
+FTerrainHeightmapFile::~FTerrainHeightmapFile()
+{
+	// Cached tiles still referenced elsewhere keep the handle open themselves
+	CachedTiles.Empty();
+}
+
+TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> FTerrainHeightmapFile::GetTile(int32 TileX, int32 TileY) const
+{
+	if (TileX < 0 || TileY < 0 || TileX >= Layout.TilesX || TileY >= Layout.TilesY)
+	{
+		return nullptr;
+	}
+	return FindOrLoadTile(TileY * Layout.TilesX + TileX);
+}
+
+TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> FTerrainHeightmapFile::FindOrLoadTile(int32 TileIndex) const
+{
+	auto FindCached = [this](int32 Index) -> TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>
+	{
+		for (int32 CacheIndex = CachedTiles.Num() - 1; CacheIndex >= 0; CacheIndex--)
+		{
+			if (CachedTiles[CacheIndex].Key == Index)
+			{
+				// Move to the back as the most recently used
+				TPair<int32, TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>> Entry = MoveTemp(CachedTiles[CacheIndex]);
+				CachedTiles.RemoveAt(CacheIndex, EAllowShrinking::No);
+				return CachedTiles.Add_GetRef(MoveTemp(Entry)).Value;
+			}
+		}
+		return nullptr;
+	};
+
+	{
+		FScopeLock Lock(&CacheLock);
+		if (TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> Tile = FindCached(TileIndex))
+		{
+			return Tile;
+		}
+	}
+
+	// Decoded outside the lock so other tiles can be served meanwhile; if two threads race, the first insert wins
+	TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> Loaded = LoadTile(TileIndex);
+	if (!Loaded.IsValid())
+	{
+		return nullptr;
+	}
+
+	FScopeLock Lock(&CacheLock);
+	if (TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> Tile = FindCached(TileIndex))
+	{
+		return Tile;
+	}
+	if (CachedTiles.Num() >= MaxCachedTiles)
+	{
+		CachedTiles.RemoveAt(0, EAllowShrinking::No);
+	}
+	CachedTiles.Emplace(TileIndex, Loaded);
+	return Loaded;
+}
+
+TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> FTerrainHeightmapFile::LoadTile(int32 TileIndex) const
+{
+	TERRAFORGE_STAGE_SCOPE(HeightmapTileLoad);
+
+	if (!Index.IsValidIndex(TileIndex))
+	{
+		return nullptr;
+	}
+
+	const FTerrainHeightmapTileEntry& Entry = Index[TileIndex];
+	TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(Entry.Offset, Entry.Size));
+	if (!Region)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: could not map tile %d of %s"), TileIndex, *Path);
+		return nullptr;
+	}
+
+	// Open bounds TileQuads, so a tile's sample count always fits in int32
+	const int32 NumSamples = Layout.GetTileSamples() * Layout.GetTileSamples();
+	TSharedRef<FTerrainHeightmapTile, ESPMode::ThreadSafe> Tile = MakeShared<FTerrainHeightmapTile, ESPMode::ThreadSafe>();
+	const ETerraHeightmapCodec Codec = static_cast<ETerraHeightmapCodec>(Entry.Codec);
+	if (Codec == ETerraHeightmapCodec::None)
+	{
+		// Zero copy: the samples stay in the page cache and are read through the mapping
+		Tile->Samples = TConstArrayView<uint16>(reinterpret_cast<const uint16*>(Region->GetMappedPtr()), NumSamples);
+		Tile->Handle = Handle;
+		Tile->Region = MoveTemp(Region);
+		return Tile;
+	}
+
+	TArray<uint8> Encoded;
+	Encoded.SetNumUninitialized(NumSamples * 2);
+	if (!FCompression::UncompressMemory(GetCodecFormatName(Codec), Encoded.GetData(), Encoded.Num(), Region->GetMappedPtr(), Entry.Size))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TerrainHeightmapFile: tile %d of %s does not decompress"), TileIndex, *Path);
+		return nullptr;
+	}
+
+	Tile->Decoded.SetNumUninitialized(NumSamples);
+	DecodeTileDeltas(Encoded.GetData(), NumSamples, Layout.GetTileSamples(), Tile->Decoded.GetData());
+	Tile->Samples = Tile->Decoded;
+	return Tile;
+}
+
+float FTerrainHeightmapFile::Sample(FTileLookup& Lookup, double WorldX, double WorldY) const
+{
+	// Global sample coordinates, with the cell chosen so its far corner is still inside the same tile
+	const int32 NumQuadsX = Layout.TilesX * Layout.TileQuads;
+	const int32 NumQuadsY = Layout.TilesY * Layout.TileQuads;
+	const double SampleX = WorldX / Layout.GridSize;
+	const double SampleY = WorldY / Layout.GridSize;
+	const int32 CellX = FMath::Clamp(FMath::FloorToInt32(SampleX), 0, NumQuadsX - 1);
+	const int32 CellY = FMath::Clamp(FMath::FloorToInt32(SampleY), 0, NumQuadsY - 1);
+	const float FracX = static_cast<float>(FMath::Clamp(SampleX - CellX, 0.0, 1.0));
+	const float FracY = static_cast<float>(FMath::Clamp(SampleY - CellY, 0.0, 1.0));
+
+	const int32 TileX = FMath::Min(CellX / Layout.TileQuads, Layout.TilesX - 1);
+	const int32 TileY = FMath::Min(CellY / Layout.TileQuads, Layout.TilesY - 1);
+	const FTerrainHeightmapTile* Tile = Lookup.Find(TileY * Layout.TilesX + TileX);
+	if (!Tile)
+	{
+		return 0.0f;
+	}
+
+	const int32 NumColumns = Layout.GetTileSamples();
+	const int32 LocalX = CellX - TileX * Layout.TileQuads;
+	const int32 LocalY = CellY - TileY * Layout.TileQuads;
+	const uint16* Row0 = Tile->GetSamples().GetData() + LocalY * NumColumns + LocalX;
+	const uint16* Row1 = Row0 + NumColumns;
+
+	const float Top = FMath::Lerp(static_cast<float>(Row0[0]), static_cast<float>(Row0[1]), FracX);
+	const float Bottom = FMath::Lerp(static_cast<float>(Row1[0]), static_cast<float>(Row1[1]), FracX);
+	return FMath::Lerp(Top, Bottom, FracY) * (1.0f / MAX_uint16);
+}
+
+void FTerrainHeightmapFile::Evaluate(const float* X, const float* Y, int32 Count, float* Out) const
+{
+	FTileLookup Lookup(*this);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		Out[Index] = Sample(Lookup, X[Index], Y[Index]);
+	}
+}
+
+void FTerrainHeightmapFile::EvaluateGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, TArrayView<float> Out) const
+{
+	check(Out.Num() >= Width * NumRows);
+
+	FTileLookup Lookup(*this);
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		const double WorldY = Origin.Y + (FirstRow + Row) * Step.Y;
+		float* OutRow = Out.GetData() + Row * Width;
+		for (int32 Column = 0; Column < Width; Column++)
+		{
+			OutRow[Column] = Sample(Lookup, Origin.X + Column * Step.X, WorldY);
+		}
+	}
+}
+
+FTerrainHeightmapWriter::~FTerrainHeightmapWriter()
+{
+	// Abandoned without Close; never leave a partial file behind
+	if (Writer)
+	{
+		Writer.Reset();
+		IFileManager::Get().Delete(*TempPath);
+	}
+}
+
+bool FTerrainHeightmapWriter::Open(const FString& InPath, const FTerrainHeightmapLayout& InLayout, ETerraHeightmapCodec InCodec)
+{
+	check(!Writer);
+
+	if (!InLayout.IsValid())
+	{
+		return false;
+	}
+
+	Path = InPath;
+	TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	Layout = InLayout;
+	Codec = InCodec;
+	TileBytes = 0;
+	bFailed = false;
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*TempPath));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	// Placeholder header and index, overwritten by Close once every tile offset is known
+	Index.Reset();
+	Index.SetNum(Layout.GetNumTiles());
+	FHeightmapFileHeader Header;
+	FMemory::Memzero(Header);
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize(Index.GetData(), Index.Num() * sizeof(FTerrainHeightmapTileEntry));
+	return !Writer->IsError();
+}
+
+bool FTerrainHeightmapWriter::WriteTile(int32 TileX, int32 TileY, TConstArrayView<uint16> Samples)
+{
+	const int32 NumColumns = Layout.GetTileSamples();
+	if (TileX < 0 || TileY < 0 || TileX >= Layout.TilesX || TileY >= Layout.TilesY || Samples.Num() != NumColumns * NumColumns)
+	{
+		return false;
+	}
+
+	// Compress on the calling thread; only the append below is serialized
+	TArray<uint8> Compressed;
+	ETerraHeightmapCodec StoredCodec = ETerraHeightmapCodec::None;
+	if (Codec != ETerraHeightmapCodec::None)
+	{
+		TArray<uint8> Encoded;
+		EncodeTileDeltas(Samples, NumColumns, Encoded);
+
+		const FName FormatName = GetCodecFormatName(Codec);
+		int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, Encoded.Num());
+		Compressed.SetNumUninitialized(CompressedSize);
+
+		// Tiles that do not shrink, e.g. pure noise, are stored raw and stay zero copy
+		if (FCompression::CompressMemory(FormatName, Compressed.GetData(), CompressedSize, Encoded.GetData(), Encoded.Num()) && CompressedSize < Encoded.Num())
+		{
+			Compressed.SetNum(CompressedSize, EAllowShrinking::No);
+			StoredCodec = Codec;
+		}
+	}
+
+	const uint8* Data = StoredCodec == ETerraHeightmapCodec::None ? reinterpret_cast<const uint8*>(Samples.GetData()) : Compressed.GetData();
+	const int64 Size = StoredCodec == ETerraHeightmapCodec::None ? Samples.Num() * static_cast<int64>(sizeof(uint16)) : Compressed.Num();
+
+	FScopeLock Lock(&WriteLock);
+	if (!Writer || bFailed)
+	{
+		return false;
+	}
+
+	static const uint8 Padding[HeightmapTileAlignment] = {};
+	const int64 Position = Writer->Tell();
+	const int64 AlignedPosition = Align(Position, HeightmapTileAlignment);
+	Writer->Serialize(const_cast<uint8*>(Padding), AlignedPosition - Position);
+	Writer->Serialize(const_cast<uint8*>(Data), Size);
+	if (Writer->IsError())
+	{
+		bFailed = true;
+		return false;
+	}
+
+	FTerrainHeightmapTileEntry& Entry = Index[TileY * Layout.TilesX + TileX];
+	Entry.Offset = AlignedPosition;
+	Entry.Size = static_cast<uint32>(Size);
+	Entry.Codec = static_cast<uint32>(StoredCodec);
+	TileBytes += Size;
+	return true;
+}
+
+bool FTerrainHeightmapWriter::Close()
+{
+	FScopeLock Lock(&WriteLock);
+	if (!Writer)
+	{
+		return false;
+	}
+
+	const bool bComplete = !bFailed && !Index.ContainsByPredicate([](const FTerrainHeightmapTileEntry& Entry) { return Entry.Offset == 0; });
+	if (bComplete)
+	{
+		FHeightmapFileHeader Header;
+		FMemory::Memzero(Header);
+		Header.Magic = HeightmapFileMagic;
+		Header.Version = HeightmapFileVersion;
+		Header.TileQuads = Layout.TileQuads;
+		Header.TilesX = Layout.TilesX;
+		Header.TilesY = Layout.TilesY;
+		Header.GridSize = Layout.GridSize;
+		Header.IndexHash = FXxHash64::HashBuffer(Index.GetData(), Index.Num() * sizeof(FTerrainHeightmapTileEntry)).Hash;
+
+		Writer->Seek(0);
+		Writer->Serialize(&Header, sizeof(Header));
+		Writer->Serialize(Index.GetData(), Index.Num() * sizeof(FTerrainHeightmapTileEntry));
+	}
+
+	const bool bClosed = Writer->Close();
+	Writer.Reset();
+	if (!bComplete || !bClosed || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,140 @@
+// TerraForge - Procedural World Generator
+// Terrain Mesh Arena Implementation
+
+#include "TerrainMeshArena.h"
+#include "TerraForgeStats.h"
+
+FTerrainMeshArena::FTerrainMeshArena(int32 InMaxPooled)
+	: MaxPooled(FMath::Max(InMaxPooled, 1))
+{
+}
+
+FTerrainMeshArena::~FTerrainMeshArena()
+{
+	for (FTerrainMeshData* Data : FreeMeshData)
+	{
+		delete Data;
+	}
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_ArenaMemory, PooledBytes);
+}
+
+TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> FTerrainMeshArena::AcquireMeshData()
+{
+	FTerrainMeshData* Data = nullptr;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FreeMeshData.Num() > 0)
+		{
+			Data = FreeMeshData.Pop(EAllowShrinking::No);
+			const int64 Bytes = GetAllocatedSize(*Data);
+			PooledBytes -= Bytes;
+			DEC_MEMORY_STAT_BY(STAT_TerraForge_ArenaMemory, Bytes);
+		}
+	}
+	if (!Data)
+	{
+		Data = new FTerrainMeshData();
+	}
+
+	// The deleter holds the arena weakly, so buffers outliving it are simply freed
+	TWeakPtr<FTerrainMeshArena, ESPMode::ThreadSafe> WeakArena = AsShared();
+	return TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe>(Data, [WeakArena](FTerrainMeshData* Released)
+	{
+		if (TSharedPtr<FTerrainMeshArena, ESPMode::ThreadSafe> Arena = WeakArena.Pin())
+		{
+			Arena->ReleaseMeshData(Released);
+		}
+		else
+		{
+			delete Released;
+		}
+	});
+}
+
+void FTerrainMeshArena::ReleaseMeshData(FTerrainMeshData* Data)
+{
+	// Only the allocations are worth keeping
+	Data->Topology.Reset();
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FreeMeshData.Num() < MaxPooled)
+		{
+			const int64 Bytes = GetAllocatedSize(*Data);
+			PooledBytes += Bytes;
+			INC_MEMORY_STAT_BY(STAT_TerraForge_ArenaMemory, Bytes);
+			FreeMeshData.Add(Data);
+			return;
+		}
+	}
+	delete Data;
+}
+
+FProcMeshSection FTerrainMeshArena::AcquireSection()
+{
+	FScopeLock ScopeLock(&Lock);
+	if (FreeSections.Num() == 0)
+	{
+		return FProcMeshSection();
+	}
+
+	FProcMeshSection Section = FreeSections.Pop(EAllowShrinking::No);
+	const int64 Bytes = GetAllocatedSize(Section);
+	PooledBytes -= Bytes;
+	DEC_MEMORY_STAT_BY(STAT_TerraForge_ArenaMemory, Bytes);
+	return Section;
+}
+
+void FTerrainMeshArena::ReleaseSection(FProcMeshSection&& Section)
+{
+	// Nothing to reuse in a section that never held data
+	if (Section.ProcVertexBuffer.Max() == 0 && Section.ProcIndexBuffer.Max() == 0)
+	{
+		return;
+	}
+
+	// Emptied without freeing, so the next pack only overwrites
+	Section.ProcVertexBuffer.Reset();
+	Section.ProcIndexBuffer.Reset();
+
+	FScopeLock ScopeLock(&Lock);
+	if (FreeSections.Num() < MaxPooled)
+	{
+		const int64 Bytes = GetAllocatedSize(Section);
+		PooledBytes += Bytes;
+		INC_MEMORY_STAT_BY(STAT_TerraForge_ArenaMemory, Bytes);
+		FreeSections.Add(MoveTemp(Section));
+	}
+}
+
+void FTerrainMeshArena::InstallSection(UProceduralMeshComponent* Mesh, int32 SectionIndex, FProcMeshSection& InOutSection)
+{
+	if (SectionIndex >= Mesh->GetNumSections())
+	{
+		Mesh->SetProcMeshSection(SectionIndex, FProcMeshSection());
+	}
+
+	FProcMeshSection* Target = Mesh->GetProcMeshSection(SectionIndex);
+	Swap(*Target, InOutSection);
+
+	// Assigning the section to itself copies nothing, but runs the component's bounds, collision and render state updates
+	Mesh->SetProcMeshSection(SectionIndex, *Target);
+}
+
+int64 FTerrainMeshArena::GetPooledBytes() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return PooledBytes;
+}
+
+int64 FTerrainMeshArena::GetAllocatedSize(const FTerrainMeshData& Data)
+{
+	return Data.Heights.GetAllocatedSize() + Data.HeightGradientX.GetAllocatedSize() + Data.HeightGradientY.GetAllocatedSize()
+		+ Data.Vertices.GetAllocatedSize() + Data.Triangles.GetAllocatedSize() + Data.Normals.GetAllocatedSize() + Data.UVs.GetAllocatedSize()
+		+ Data.VertexColors.GetAllocatedSize() + Data.Tangents.GetAllocatedSize() + Data.CollisionVertices.GetAllocatedSize() + Data.CollisionTriangles.GetAllocatedSize();
+}
+
+int64 FTerrainMeshArena::GetAllocatedSize(const FProcMeshSection& Section)
+{
+	return Section.ProcVertexBuffer.GetAllocatedSize() + Section.ProcIndexBuffer.GetAllocatedSize();
+}
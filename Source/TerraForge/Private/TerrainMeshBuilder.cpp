@@ -0,0 +1,511 @@
+// TerraForge - Procedural World Generator
+// Terrain Mesh Builder Implementation
+
+#include "TerrainMeshBuilder.h"
+#include "TerraNoiseGraph.h"
+#include "TerrainHeightmapFile.h"
+#include "TerrainErosion.h"
+#include "TerraForgeStats.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+// Rows of vertices or quads handed to one worker at a time
+static constexpr int32 TerrainRowsPerBlock = 8;
+
+/** Run Body(FirstRow, EndRow) over NumRows rows in blocks, on worker threads when bParallel is set */
+static void ParallelForRowBlocks(int32 NumRows, bool bParallel, TFunctionRef<void(int32, int32)> Body)
+{
+	const int32 NumBlocks = FMath::DivideAndRoundUp(NumRows, TerrainRowsPerBlock);
+	ParallelFor(NumBlocks, [NumRows, &Body](int32 Block)
+	{
+		LLM_SCOPE_BYTAG(TerraForge);
+		const int32 FirstRow = Block * TerrainRowsPerBlock;
+		Body(FirstRow, FMath::Min(FirstRow + TerrainRowsPerBlock, NumRows));
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+bool FTerrainMeshBuilder::Build(const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData, const std::atomic<bool>* CancelFlag)
+{
+	LLM_SCOPE_BYTAG(TerraForge);
+
+	auto IsCancelled = [CancelFlag]()
+	{
+		return CancelFlag && CancelFlag->load(std::memory_order_relaxed);
+	};
+
+	// Sample the height grid, including the halo ring used for border normals
+	GenerateHeights(Settings, OutData.Heights, OutData.HeightGradientX, OutData.HeightGradientY);
+	if (IsCancelled())
+	{
+		return false;
+	}
+
+	// Eroded heights no longer match the noise gradients, so normals come from height differences.
+	// The thermal pass erodes its own padded copy of the heights, droplets included, so the droplets only run here without it
+	const bool bThermal = Settings.ThermalErosion.bEnabled && !Settings.ThermalErosion.bProgressive;
+	if (Settings.HydraulicErosion.bEnabled && !bThermal)
+	{
+		FTerrainErosion::ApplyHydraulic(Settings, OutData.Heights);
+		OutData.HeightGradientX.Reset();
+		OutData.HeightGradientY.Reset();
+		if (IsCancelled())
+		{
+			return false;
+		}
+	}
+
+	if (bThermal)
+	{
+		FTerrainErosion::ApplyThermalSeamless(Settings, OutData.Heights);
+		OutData.HeightGradientX.Reset();
+		OutData.HeightGradientY.Reset();
+		if (IsCancelled())
+		{
+			return false;
+		}
+	}
+
+	// Normals and tangents straight from the height grid or the noise gradients
+	if (OutData.HeightGradientX.Num() > 0)
+	{
+		CalculateNormalsFromGradients(Settings, OutData.HeightGradientX, OutData.HeightGradientY, OutData.Normals, OutData.Tangents);
+	}
+	else
+	{
+		CalculateNormals(Settings, OutData.Heights, OutData.Normals, OutData.Tangents);
+	}
+	if (IsCancelled())
+	{
+		return false;
+	}
+
+	return BuildFromHeightsAndNormals(Settings, OutData, CancelFlag);
+}
+
+bool FTerrainMeshBuilder::BuildFromHeightsAndNormals(const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData, const std::atomic<bool>* CancelFlag)
+{
+	LLM_SCOPE_BYTAG(TerraForge);
+
+	// Generate vertices, UVs and biome colors
+	GenerateVertices(Settings, OutData.Heights, OutData.Normals, OutData.Vertices, OutData.UVs, OutData.VertexColors);
+
+	// Generate triangles
+	OutData.Topology = GenerateTriangles(Settings, OutData.Triangles);
+	if (CancelFlag && CancelFlag->load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	// The collision grid is a subset of the render vertices, so it reads the heights already sampled
+	OutData.CollisionMode = Settings.CollisionMode;
+	if (Settings.CollisionMode == ETerraCollisionMode::Simplified)
+	{
+		GenerateCollision(Settings, OutData.CollisionVertices, OutData.CollisionTriangles, &OutData.Heights);
+	}
+	else
+	{
+		OutData.CollisionVertices.Reset();
+		OutData.CollisionTriangles.Reset();
+	}
+	return true;
+}
+
+void FTerrainMeshBuilder::GenerateHeights(const FTerrainBuildSettings& Settings, TArray<float>& Heights, TArray<float>& GradientX, TArray<float>& GradientY)
+{
+	TERRAFORGE_STAGE_SCOPE(Heights);
+
+	const int32 HaloColumns = Settings.Width + 3;
+	const int32 HaloRows = Settings.Height + 3;
+	Heights.SetNumUninitialized(HaloColumns * HaloRows);
+
+	// Graph programs and heightmaps have no analytic gradient
+	const bool bGradients = Settings.bAnalyticNormals && !Settings.HeightProgram.IsValid() && !Settings.Heightmap.IsValid();
+	if (bGradients)
+	{
+		GradientX.SetNumUninitialized(HaloColumns * HaloRows);
+		GradientY.SetNumUninitialized(HaloColumns * HaloRows);
+	}
+	else
+	{
+		GradientX.Reset();
+		GradientY.Reset();
+	}
+
+	// The halo starts one grid step before the first vertex
+	const FVector2D Step(Settings.GridSize, Settings.GridSize);
+	const FVector2D HaloOrigin = Settings.NoiseOrigin - Step;
+
+	ParallelForRowBlocks(HaloRows, Settings.bParallel, [&](int32 FirstRow, int32 EndRow)
+	{
+		// Sample this block's rows of the height grid in one call
+		const int32 BlockStart = FirstRow * HaloColumns;
+		const int32 BlockSize = (EndRow - FirstRow) * HaloColumns;
+		TArrayView<float> BlockHeights = TArrayView<float>(Heights).Slice(BlockStart, BlockSize);
+		if (Settings.Heightmap.IsValid())
+		{
+			Settings.Heightmap->EvaluateGridRows(HaloOrigin, Step, HaloColumns, FirstRow, EndRow - FirstRow, BlockHeights);
+		}
+		else if (Settings.HeightProgram.IsValid())
+		{
+			Settings.HeightProgram->EvaluateGridRows(HaloOrigin, Step, HaloColumns, FirstRow, EndRow - FirstRow, BlockHeights);
+		}
+		else if (bGradients)
+		{
+			Settings.Sampler.NoiseGridRowsWithDerivatives(HaloOrigin, Step, HaloColumns, FirstRow, EndRow - FirstRow, Settings.NoiseParams, BlockHeights,
+				TArrayView<float>(GradientX).Slice(BlockStart, BlockSize), TArrayView<float>(GradientY).Slice(BlockStart, BlockSize));
+		}
+		else
+		{
+			Settings.Sampler.NoiseGridRows(HaloOrigin, Step, HaloColumns, FirstRow, EndRow - FirstRow, Settings.NoiseParams, BlockHeights);
+		}
+	});
+}
+
+void FTerrainMeshBuilder::GenerateVertices(const FTerrainBuildSettings& Settings, const TArray<float>& Heights, const TArray<FVector>& Normals, TArray<FVector>& Vertices, TArray<FVector2D>& UVs, TArray<FColor>& VertexColors)
+{
+	TERRAFORGE_STAGE_SCOPE(Vertices);
+
+	const int32 NumColumns = Settings.Width + 1;
+	const int32 NumRows = Settings.Height + 1;
+	const int32 NumVertices = NumColumns * NumRows;
+	check(Normals.Num() == NumVertices);
+
+	// Pre-size so each row block writes its own slice
+	Vertices.SetNumUninitialized(NumVertices);
+	UVs.SetNumUninitialized(NumVertices);
+	VertexColors.SetNumUninitialized(NumVertices);
+
+	const bool bBiomes = Settings.Biome.bEnabled;
+	const FTerrainBiomeClassifier Biome(Settings.Biome);
+
+	ParallelForRowBlocks(NumRows, Settings.bParallel, [&](int32 FirstRow, int32 EndRow)
+	{
+		// Climate for one row of vertices at a time, kept on the stack for rows of up to 512 vertices
+		TArray<float, TInlineAllocator<2 * 512>> Climate;
+		Climate.SetNumUninitialized(bBiomes ? NumColumns * 2 : 0);
+		const int32 NumClimateColumns = Climate.Num() / 2;
+		const TArrayView<float> Moisture = TArrayView<float>(Climate).Left(NumClimateColumns);
+		const TArrayView<float> Temperature = TArrayView<float>(Climate).Right(NumClimateColumns);
+
+		for (int32 Y = FirstRow; Y < EndRow; Y++)
+		{
+			if (bBiomes)
+			{
+				Biome.SampleClimateRows(Settings.Sampler, Settings.NoiseOrigin, FVector2D(Settings.GridSize, Settings.GridSize), NumColumns, Y, 1, Moisture, Temperature);
+			}
+
+			for (int32 X = 0; X <= Settings.Width; X++)
+			{
+				const int32 Index = Y * NumColumns + X;
+
+				// Calculate world position
+				float WorldX = X * Settings.GridSize;
+				float WorldY = Y * Settings.GridSize;
+
+				// Apply height multiplier
+				const float Height = Heights[GetHaloIndex(Settings, X, Y)];
+				float WorldZ = Height * Settings.MaxHeight;
+
+				Vertices[Index] = FVector(WorldX, WorldY, WorldZ);
+
+				// UV coordinates
+				float U = static_cast<float>(X) / Settings.Width;
+				float V = static_cast<float>(Y) / Settings.Height;
+				UVs[Index] = FVector2D(U, V);
+
+				// Material weights while the height and normal are at hand
+				if (bBiomes)
+				{
+					VertexColors[Index] = Biome.Classify(Height, Normals[Index].Z, Moisture[X], Temperature[X]);
+				}
+				else
+				{
+					const uint8 Gray = static_cast<uint8>(FMath::Clamp(Height, 0.0f, 1.0f) * 255.0f);
+					VertexColors[Index] = FColor(Gray, Gray, Gray, 255);
+				}
+			}
+		}
+	});
+}
+
+TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> FTerrainMeshBuilder::GenerateTriangles(const FTerrainBuildSettings& Settings, TArray<int32>& Triangles, ETerrainTopologyVariant Variant)
+{
+	TERRAFORGE_STAGE_SCOPE(Triangles);
+
+	// The index list only depends on the grid size, so it is built once per size and copied
+	TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> Topology = FTerrainTopologyCache::Get().FindOrCreate(Settings.Width, Settings.Height, Variant);
+	Topology->CopyIndices(Triangles);
+	return Topology;
+}
+
+/**
+ * Write normals and +X tangents for one row of vertices from their slopes.
+ * Slope along an axis is Delta * Scale; the surface normal is then (-SlopeX, -SlopeY, 1) and the tangent along +X, where U grows, is (1, 0, SlopeX)
+ */
+static void WriteNormalRow(const float* DeltaX, const float* DeltaY, float Scale, int32 Count, FVector* Normals, FProcMeshTangent* Tangents)
+{
+	const VectorRegister4Float ScaleVector = VectorSetFloat1(Scale);
+	const VectorRegister4Float One = VectorSetFloat1(1.0f);
+
+	int32 X = 0;
+	for (; X + 4 <= Count; X += 4)
+	{
+		const VectorRegister4Float SlopeX = VectorMultiply(VectorLoad(DeltaX + X), ScaleVector);
+		const VectorRegister4Float SlopeY = VectorMultiply(VectorLoad(DeltaY + X), ScaleVector);
+		const VectorRegister4Float SlopeXSquared = VectorMultiply(SlopeX, SlopeX);
+		const VectorRegister4Float InvNormalLength = VectorReciprocalSqrtAccurate(VectorMultiplyAdd(SlopeY, SlopeY, VectorAdd(SlopeXSquared, One)));
+		const VectorRegister4Float InvTangentLength = VectorReciprocalSqrtAccurate(VectorAdd(SlopeXSquared, One));
+
+		alignas(16) float NormalX[4];
+		alignas(16) float NormalY[4];
+		alignas(16) float NormalZ[4];
+		alignas(16) float TangentX[4];
+		alignas(16) float TangentZ[4];
+		VectorStoreAligned(VectorNegate(VectorMultiply(SlopeX, InvNormalLength)), NormalX);
+		VectorStoreAligned(VectorNegate(VectorMultiply(SlopeY, InvNormalLength)), NormalY);
+		VectorStoreAligned(InvNormalLength, NormalZ);
+		VectorStoreAligned(InvTangentLength, TangentX);
+		VectorStoreAligned(VectorMultiply(SlopeX, InvTangentLength), TangentZ);
+
+		for (int32 Lane = 0; Lane < 4; Lane++)
+		{
+			Normals[X + Lane] = FVector(NormalX[Lane], NormalY[Lane], NormalZ[Lane]);
+			Tangents[X + Lane] = FProcMeshTangent(FVector(TangentX[Lane], 0.0f, TangentZ[Lane]), false);
+		}
+	}
+
+	// Remaining vertices of the row
+	for (; X < Count; X++)
+	{
+		const float SlopeX = DeltaX[X] * Scale;
+		const float SlopeY = DeltaY[X] * Scale;
+		const float InvNormalLength = FMath::InvSqrt(SlopeX * SlopeX + SlopeY * SlopeY + 1.0f);
+		const float InvTangentLength = FMath::InvSqrt(SlopeX * SlopeX + 1.0f);
+
+		Normals[X] = FVector(-SlopeX * InvNormalLength, -SlopeY * InvNormalLength, InvNormalLength);
+		Tangents[X] = FProcMeshTangent(FVector(InvTangentLength, 0.0f, SlopeX * InvTangentLength), false);
+	}
+}
+
+void FTerrainMeshBuilder::CalculateNormals(const FTerrainBuildSettings& Settings, const TArray<float>& Heights, TArray<FVector>& Normals, TArray<FProcMeshTangent>& Tangents)
+{
+	TERRAFORGE_STAGE_SCOPE(Normals);
+
+	const int32 NumColumns = Settings.Width + 1;
+	const int32 HaloColumns = Settings.Width + 3;
+	const int32 NumVertices = NumColumns * (Settings.Height + 1);
+	Normals.SetNumUninitialized(NumVertices);
+	Tangents.SetNumUninitialized(NumVertices);
+
+	// Central differences: dZ/dX = (H(X+1) - H(X-1)) * MaxHeight / (2 * GridSize)
+	const float SlopeScale = Settings.MaxHeight / (2.0f * Settings.GridSize);
+
+	ParallelForRowBlocks(Settings.Height + 1, Settings.bParallel, [&](int32 FirstRow, int32 EndRow)
+	{
+		TArray<float, TInlineAllocator<2 * 512>> Deltas;
+		Deltas.SetNumUninitialized(NumColumns * 2);
+		float* DeltaX = Deltas.GetData();
+		float* DeltaY = DeltaX + NumColumns;
+
+		for (int32 Y = FirstRow; Y < EndRow; Y++)
+		{
+			const float* Center = Heights.GetData() + GetHaloIndex(Settings, 0, Y);
+			const float* Down = Center - HaloColumns;
+			const float* Up = Center + HaloColumns;
+			for (int32 X = 0; X < NumColumns; X++)
+			{
+				DeltaX[X] = Center[X + 1] - Center[X - 1];
+				DeltaY[X] = Up[X] - Down[X];
+			}
+
+			WriteNormalRow(DeltaX, DeltaY, SlopeScale, NumColumns, Normals.GetData() + Y * NumColumns, Tangents.GetData() + Y * NumColumns);
+		}
+	});
+}
+
+void FTerrainMeshBuilder::CalculateNormalsFromGradients(const FTerrainBuildSettings& Settings, const TArray<float>& GradientX, const TArray<float>& GradientY, TArray<FVector>& Normals, TArray<FProcMeshTangent>& Tangents)
+{
+	TERRAFORGE_STAGE_SCOPE(Normals);
+
+	const int32 NumColumns = Settings.Width + 1;
+	const int32 NumVertices = NumColumns * (Settings.Height + 1);
+	Normals.SetNumUninitialized(NumVertices);
+	Tangents.SetNumUninitialized(NumVertices);
+
+	// Gradients are per world unit of normalized height, so only MaxHeight is left to apply
+	ParallelForRowBlocks(Settings.Height + 1, Settings.bParallel, [&](int32 FirstRow, int32 EndRow)
+	{
+		for (int32 Y = FirstRow; Y < EndRow; Y++)
+		{
+			const int32 RowStart = GetHaloIndex(Settings, 0, Y);
+			WriteNormalRow(GradientX.GetData() + RowStart, GradientY.GetData() + RowStart, Settings.MaxHeight, NumColumns, Normals.GetData() + Y * NumColumns, Tangents.GetData() + Y * NumColumns);
+		}
+	});
+}
+
+void FTerrainMeshBuilder::GenerateCollision(const FTerrainBuildSettings& Settings, TArray<FVector>& Vertices, TArray<int32>& Triangles, const TArray<float>* Heights)
+{
+	TERRAFORGE_STAGE_SCOPE(Collision);
+
+	const int32 Step = FMath::Max(Settings.CollisionGridStep, 1);
+	const int32 CollisionWidth = FMath::DivideAndRoundUp(Settings.Width, Step);
+	const int32 CollisionHeight = FMath::DivideAndRoundUp(Settings.Height, Step);
+	const int32 NumColumns = CollisionWidth + 1;
+	const int32 NumVertices = NumColumns * (CollisionHeight + 1);
+
+	Vertices.SetNumUninitialized(NumVertices);
+	if (Heights)
+	{
+		for (int32 Row = 0; Row <= CollisionHeight; Row++)
+		{
+			const int32 GridY = FMath::Min(Row * Step, Settings.Height);
+			for (int32 Column = 0; Column < NumColumns; Column++)
+			{
+				const int32 GridX = FMath::Min(Column * Step, Settings.Width);
+				Vertices[Row * NumColumns + Column] = FVector(GridX * Settings.GridSize, GridY * Settings.GridSize, (*Heights)[GetHaloIndex(Settings, GridX, GridY)] * Settings.MaxHeight);
+			}
+		}
+		FTerrainTopologyCache::Get().FindOrCreate(CollisionWidth, CollisionHeight, ETerrainTopologyVariant::Grid)->CopyIndices(Triangles);
+		return;
+	}
+
+	TArray<float> Samples;
+	Samples.SetNumUninitialized(NumVertices * 3);
+	float* SampleX = Samples.GetData();
+	float* SampleY = SampleX + NumVertices;
+	float* SampleHeights = SampleY + NumVertices;
+
+	// Positions computed like the halo grid in GenerateHeights, so collision vertices sit exactly on render vertices
+	const FVector2D GridStep(Settings.GridSize, Settings.GridSize);
+	const FVector2D HaloOrigin = Settings.NoiseOrigin - GridStep;
+
+	for (int32 Row = 0; Row <= CollisionHeight; Row++)
+	{
+		const int32 GridY = FMath::Min(Row * Step, Settings.Height);
+		for (int32 Column = 0; Column < NumColumns; Column++)
+		{
+			const int32 GridX = FMath::Min(Column * Step, Settings.Width);
+			const int32 Index = Row * NumColumns + Column;
+			SampleX[Index] = static_cast<float>(HaloOrigin.X + (GridX + 1) * GridStep.X);
+			SampleY[Index] = static_cast<float>(HaloOrigin.Y + (GridY + 1) * GridStep.Y);
+			Vertices[Index] = FVector(GridX * Settings.GridSize, GridY * Settings.GridSize, 0.0);
+		}
+	}
+
+	if (Settings.Heightmap.IsValid())
+	{
+		Settings.Heightmap->Evaluate(SampleX, SampleY, NumVertices, SampleHeights);
+	}
+	else if (Settings.HeightProgram.IsValid())
+	{
+		Settings.HeightProgram->Evaluate(SampleX, SampleY, NumVertices, SampleHeights);
+	}
+	else
+	{
+		Settings.Sampler.FractalPoints(Settings.NoiseParams, SampleX, SampleY, NumVertices, SampleHeights);
+	}
+
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		Vertices[Index].Z = SampleHeights[Index] * Settings.MaxHeight;
+	}
+
+	FTerrainTopologyCache::Get().FindOrCreate(CollisionWidth, CollisionHeight, ETerrainTopologyVariant::Grid)->CopyIndices(Triangles);
+}
+
+void FTerrainMeshBuilder::PackSection(const FTerrainMeshData& Data, FProcMeshSection& OutSection)
+{
+	TERRAFORGE_STAGE_SCOPE(PackSection);
+
+	const int32 NumVertices = Data.Vertices.Num();
+	const bool bHasUVs = Data.UVs.Num() == NumVertices;
+	const bool bHasColors = Data.VertexColors.Num() == NumVertices;
+	const bool bHasTangents = Data.Tangents.Num() == NumVertices;
+
+	OutSection.ProcVertexBuffer.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	OutSection.SectionLocalBox.Init();
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		FProcMeshVertex& Vertex = OutSection.ProcVertexBuffer[Index];
+		Vertex.Position = Data.Vertices[Index];
+		Vertex.Normal = Data.Normals[Index];
+		Vertex.Tangent = bHasTangents ? Data.Tangents[Index] : FProcMeshTangent();
+		Vertex.Color = bHasColors ? Data.VertexColors[Index] : FColor::White;
+		Vertex.UV0 = bHasUVs ? Data.UVs[Index] : FVector2D::ZeroVector;
+		Vertex.UV1 = FVector2D::ZeroVector;
+		Vertex.UV2 = FVector2D::ZeroVector;
+		Vertex.UV3 = FVector2D::ZeroVector;
+		OutSection.SectionLocalBox += Vertex.Position;
+	}
+
+	const int32 NumIndices = Data.Triangles.Num();
+	OutSection.ProcIndexBuffer.SetNumUninitialized(NumIndices, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumIndices; Index++)
+	{
+		OutSection.ProcIndexBuffer[Index] = static_cast<uint32>(Data.Triangles[Index]);
+	}
+
+	OutSection.bSectionVisible = true;
+}
+
+/** Map a unit vector onto the octahedron unfolded into [0, 255]^2, matching UnitOctahedronToUnitVector in the shader */
+static void EncodeOctahedralNormal(const FVector& Normal, uint8& OutX, uint8& OutY)
+{
+	const FVector3f N = FVector3f(Normal) / (FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z));
+	FVector2f Octahedron(N.X, N.Y);
+	if (N.Z < 0.0f)
+	{
+		Octahedron = FVector2f(
+			(1.0f - FMath::Abs(N.Y)) * (N.X >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - FMath::Abs(N.X)) * (N.Y >= 0.0f ? 1.0f : -1.0f));
+	}
+	OutX = static_cast<uint8>(FMath::RoundToInt((Octahedron.X * 0.5f + 0.5f) * 255.0f));
+	OutY = static_cast<uint8>(FMath::RoundToInt((Octahedron.Y * 0.5f + 0.5f) * 255.0f));
+}
+
+FVector FTerrainCompactMesh::GetPosition(int32 Index) const
+{
+	const int32 NumColumns = GetNumColumns();
+	return FVector(
+		(Index % NumColumns) * Layout.GridSize,
+		(Index / NumColumns) * Layout.GridSize,
+		Vertices[Index].Height * Layout.HeightScale + Layout.HeightOffset);
+}
+
+void FTerrainMeshBuilder::PackCompact(const FTerrainBuildSettings& Settings, const FTerrainMeshData& Data, FTerrainCompactMesh& OutMesh)
+{
+	TERRAFORGE_STAGE_SCOPE(PackSection);
+
+	const int32 NumColumns = Settings.Width + 1;
+	const int32 NumVertices = NumColumns * (Settings.Height + 1);
+	check(Data.Vertices.Num() == NumVertices);
+
+	float MinZ = TNumericLimits<float>::Max();
+	float MaxZ = -TNumericLimits<float>::Max();
+	for (const FVector& Vertex : Data.Vertices)
+	{
+		MinZ = FMath::Min(MinZ, static_cast<float>(Vertex.Z));
+		MaxZ = FMath::Max(MaxZ, static_cast<float>(Vertex.Z));
+	}
+
+	// Quantized over the terrain-wide range rather than this mesh's own, so a vertex on an edge shared with a neighbouring chunk
+	// encodes to the same step on both sides and no cracks open between them
+	const float HeightScale = FMath::Max(Settings.MaxHeight, KINDA_SMALL_NUMBER) / 65535.0f;
+	OutMesh.Layout.NumColumns = NumColumns;
+	OutMesh.Layout.GridSize = Settings.GridSize;
+	OutMesh.Layout.HeightScale = HeightScale;
+	OutMesh.Layout.HeightOffset = 0.0f;
+	OutMesh.Layout.UVScale = FVector2f(1.0f / Settings.Width, 1.0f / Settings.Height);
+	OutMesh.Topology = Data.Topology;
+	OutMesh.LocalBounds = FBox(FVector(0.0, 0.0, MinZ), FVector(Settings.Width * Settings.GridSize, Settings.Height * Settings.GridSize, MaxZ));
+
+	const bool bHasColors = Data.VertexColors.Num() == NumVertices;
+	OutMesh.Vertices.SetNumUninitialized(NumVertices, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		FTerrainCompactVertex& Vertex = OutMesh.Vertices[Index];
+		Vertex.Height = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Data.Vertices[Index].Z / HeightScale), 0, 65535));
+		EncodeOctahedralNormal(Data.Normals[Index], Vertex.NormalX, Vertex.NormalY);
+		Vertex.Color = bHasColors ? Data.VertexColors[Index] : FColor::White;
+	}
+}
@@ -0,0 +1,218 @@
+// TerraForge - Procedural World Generator
+// Terrain Quadtree Implementation
+
+#include "TerrainQuadtree.h"
+#include "TerraForgeStats.h"
+#include "Async/ParallelFor.h"
+
+float FTerrainQuadtree::GetLevelRange(const FTerrainLODSettings& Settings, int32 Level)
+{
+	return Settings.LODDistance * static_cast<float>(1 << Level);
+}
+
+static void SelectNodesRecursive(const FTerrainLODSettings& Settings, const FTerrainQuadtreeNode& Node, const FVector& CameraLocation, TArray<FTerrainQuadtreeNode>& OutNodes)
+{
+	const int32 NodeQuads = Settings.PatchQuads << Node.Level;
+	const int32 X0 = Node.Coord.X * NodeQuads;
+	const int32 Y0 = Node.Coord.Y * NodeQuads;
+	if (X0 >= Settings.Base.Width || Y0 >= Settings.Base.Height)
+	{
+		return;
+	}
+
+	// Nodes reaching past the terrain are split further, so patches overhang the edge by less than one level 0 patch
+	const int32 PaddedWidth = FMath::DivideAndRoundUp(Settings.Base.Width, Settings.PatchQuads) * Settings.PatchQuads;
+	const int32 PaddedHeight = FMath::DivideAndRoundUp(Settings.Base.Height, Settings.PatchQuads) * Settings.PatchQuads;
+	const bool bOverhangs = X0 + NodeQuads > PaddedWidth || Y0 + NodeQuads > PaddedHeight;
+
+	const double GridSize = Settings.Base.GridSize;
+	const FBox Bounds(
+		FVector(X0 * GridSize, Y0 * GridSize, 0.0),
+		FVector((X0 + NodeQuads) * GridSize, (Y0 + NodeQuads) * GridSize, Settings.Base.MaxHeight));
+	const double Distance = FMath::Sqrt(Bounds.ComputeSquaredDistanceToPoint(CameraLocation));
+
+	if (Node.Level > 0 && (bOverhangs || Distance < FTerrainQuadtree::GetLevelRange(Settings, Node.Level - 1)))
+	{
+		for (int32 Child = 0; Child < 4; Child++)
+		{
+			FTerrainQuadtreeNode ChildNode;
+			ChildNode.Level = Node.Level - 1;
+			ChildNode.Coord = FIntPoint(Node.Coord.X * 2 + (Child & 1), Node.Coord.Y * 2 + (Child >> 1));
+			SelectNodesRecursive(Settings, ChildNode, CameraLocation, OutNodes);
+		}
+		return;
+	}
+
+	OutNodes.Add(Node);
+}
+
+void FTerrainQuadtree::SelectNodes(const FTerrainLODSettings& Settings, const FVector& CameraLocation, TArray<FTerrainQuadtreeNode>& OutNodes)
+{
+	OutNodes.Reset();
+
+	const int32 RootLevel = Settings.NumLevels - 1;
+	const int32 RootQuads = Settings.PatchQuads << RootLevel;
+	const int32 NumRootsX = FMath::DivideAndRoundUp(Settings.Base.Width, RootQuads);
+	const int32 NumRootsY = FMath::DivideAndRoundUp(Settings.Base.Height, RootQuads);
+
+	for (int32 Y = 0; Y < NumRootsY; Y++)
+	{
+		for (int32 X = 0; X < NumRootsX; X++)
+		{
+			FTerrainQuadtreeNode Root;
+			Root.Level = RootLevel;
+			Root.Coord = FIntPoint(X, Y);
+			SelectNodesRecursive(Settings, Root, CameraLocation, OutNodes);
+		}
+	}
+}
+
+void FTerrainQuadtree::BuildPatch(const FTerrainLODSettings& Settings, const FTerrainQuadtreeNode& Node, const FVector& CameraLocation, FTerrainMeshData& OutData)
+{
+	const int32 PatchQuads = Settings.PatchQuads;
+	const int32 NumColumns = PatchQuads + 1;
+	const int32 Step = 1 << Node.Level;
+	const int32 X0 = Node.Coord.X * (PatchQuads << Node.Level);
+	const int32 Y0 = Node.Coord.Y * (PatchQuads << Node.Level);
+	const FVector2D Origin(X0 * static_cast<double>(Settings.Base.GridSize), Y0 * static_cast<double>(Settings.Base.GridSize));
+
+	// Same noise as the full-resolution terrain, sampled every Step fine quads
+	FTerrainBuildSettings PatchSettings = Settings.Base;
+	PatchSettings.Width = PatchQuads;
+	PatchSettings.Height = PatchQuads;
+	PatchSettings.GridSize = Settings.Base.GridSize * Step;
+	PatchSettings.NoiseOrigin = Settings.Base.NoiseOrigin + Origin;
+	PatchSettings.bParallel = false;
+
+	FTerrainMeshBuilder::GenerateHeights(PatchSettings, OutData.Heights, OutData.HeightGradientX, OutData.HeightGradientY);
+
+	// Near the far end of its range, pull odd vertices onto the next coarser level's surface
+	// so the switch to the parent patch is invisible. Done on the height grid so normals follow the morph
+	if (Settings.bMorph && Node.Level < Settings.NumLevels - 1)
+	{
+		const float Range = GetLevelRange(Settings, Node.Level);
+		const float MorphStartDistance = Range * Settings.MorphStart;
+		const float InvMorphLength = 1.0f / FMath::Max(Range - MorphStartDistance, KINDA_SMALL_NUMBER);
+
+		// Morphed heights no longer match the analytic gradients, so these patches fall back to height differences
+		OutData.HeightGradientX.Reset();
+		OutData.HeightGradientY.Reset();
+
+		const TArray<float> Heights = OutData.Heights;
+		auto HeightAt = [&Heights, &PatchSettings](int32 X, int32 Y)
+		{
+			return Heights[FTerrainMeshBuilder::GetHaloIndex(PatchSettings, X, Y)];
+		};
+
+		for (int32 Y = 0; Y < NumColumns; Y++)
+		{
+			for (int32 X = 0; X < NumColumns; X++)
+			{
+				const bool bOddX = (X & 1) != 0;
+				const bool bOddY = (Y & 1) != 0;
+				if (!bOddX && !bOddY)
+				{
+					continue;
+				}
+
+				// Height of the coarse triangles at this vertex; coarse quads split along the same diagonal
+				float CoarseHeight;
+				if (bOddX && bOddY)
+				{
+					CoarseHeight = 0.5f * (HeightAt(X - 1, Y - 1) + HeightAt(X + 1, Y + 1));
+				}
+				else if (bOddX)
+				{
+					CoarseHeight = 0.5f * (HeightAt(X - 1, Y) + HeightAt(X + 1, Y));
+				}
+				else
+				{
+					CoarseHeight = 0.5f * (HeightAt(X, Y - 1) + HeightAt(X, Y + 1));
+				}
+
+				float& Height = OutData.Heights[FTerrainMeshBuilder::GetHaloIndex(PatchSettings, X, Y)];
+				const FVector Vertex(Origin.X + X * PatchSettings.GridSize, Origin.Y + Y * PatchSettings.GridSize, Height * PatchSettings.MaxHeight);
+				const float Morph = FMath::Clamp(static_cast<float>(FVector::Dist(Vertex, CameraLocation) - MorphStartDistance) * InvMorphLength, 0.0f, 1.0f);
+				Height = FMath::Lerp(Height, CoarseHeight, Morph);
+			}
+		}
+	}
+
+	// Normals first, the vertex pass reads them for the biome weights
+	if (OutData.HeightGradientX.Num() > 0)
+	{
+		FTerrainMeshBuilder::CalculateNormalsFromGradients(PatchSettings, OutData.HeightGradientX, OutData.HeightGradientY, OutData.Normals, OutData.Tangents);
+	}
+	else
+	{
+		FTerrainMeshBuilder::CalculateNormals(PatchSettings, OutData.Heights, OutData.Normals, OutData.Tangents);
+	}
+	FTerrainMeshBuilder::GenerateVertices(PatchSettings, OutData.Heights, OutData.Normals, OutData.Vertices, OutData.UVs, OutData.VertexColors);
+
+	for (int32 Y = 0; Y < NumColumns; Y++)
+	{
+		for (int32 X = 0; X < NumColumns; X++)
+		{
+			const int32 Index = Y * NumColumns + X;
+			OutData.Vertices[Index].X += Origin.X;
+			OutData.Vertices[Index].Y += Origin.Y;
+
+			// UVs span the whole terrain like the single-mesh path
+			OutData.UVs[Index] = FVector2D(
+				static_cast<float>(X0 + X * Step) / Settings.Base.Width,
+				static_cast<float>(Y0 + Y * Step) / Settings.Base.Height);
+		}
+	}
+
+	// Skirt triangles follow the grid triangles and reference the skirt vertices appended below
+	const TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> Topology = FTerrainMeshBuilder::GenerateTriangles(PatchSettings, OutData.Triangles, ETerrainTopologyVariant::Skirted);
+	OutData.Topology = Topology;
+	OutData.CollisionMode = Settings.Base.CollisionMode;
+
+	// Skirts hang below the border and cover cracks against neighbours at other levels
+	const double SkirtDepth = Settings.SkirtDepth * Step;
+	const int32 NumBorder = Topology->BorderVertices.Num();
+	OutData.Vertices.Reserve(Topology->NumVertices);
+	OutData.Normals.Reserve(Topology->NumVertices);
+	OutData.UVs.Reserve(Topology->NumVertices);
+	OutData.VertexColors.Reserve(Topology->NumVertices);
+	OutData.Tangents.Reserve(Topology->NumVertices);
+	for (int32 BorderIndex = 0; BorderIndex < NumBorder; BorderIndex++)
+	{
+		// Copied first, TArray::Add does not accept references into the array itself
+		const int32 Source = Topology->BorderVertices[BorderIndex];
+		const FVector Vertex = OutData.Vertices[Source];
+		const FVector Normal = OutData.Normals[Source];
+		const FVector2D UV = OutData.UVs[Source];
+		const FColor Color = OutData.VertexColors[Source];
+		const FProcMeshTangent Tangent = OutData.Tangents[Source];
+
+		OutData.Vertices.Add(Vertex - FVector(0.0, 0.0, SkirtDepth));
+		OutData.Normals.Add(Normal);
+		OutData.UVs.Add(UV);
+		OutData.VertexColors.Add(Color);
+		OutData.Tangents.Add(Tangent);
+	}
+}
+
+bool FTerrainQuadtree::BuildPatches(const FTerrainLODSettings& Settings, TConstArrayView<FTerrainQuadtreeNode> Nodes, const FVector& CameraLocation, TArray<FTerrainMeshData>& OutData, const std::atomic<bool>* CancelFlag)
+{
+	TERRAFORGE_STAGE_SCOPE(LODPatches);
+
+	auto IsCancelled = [CancelFlag]()
+	{
+		return CancelFlag && CancelFlag->load(std::memory_order_relaxed);
+	};
+
+	OutData.SetNum(Nodes.Num());
+	ParallelFor(Nodes.Num(), [&](int32 Index)
+	{
+		LLM_SCOPE_BYTAG(TerraForge);
+		if (!IsCancelled())
+		{
+			BuildPatch(Settings, Nodes[Index], CameraLocation, OutData[Index]);
+		}
+	}, Settings.Base.bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	return !IsCancelled();
+}
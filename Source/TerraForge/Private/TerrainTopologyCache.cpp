@@ -0,0 +1,196 @@
+// TerraForge - Procedural World Generator
+// Terrain Topology Cache Implementation
+
+#include "TerrainTopologyCache.h"
+#include "Misc/ScopeLock.h"
+
+void FTerrainTopology::CopyIndices(TArray<int32>& OutIndices) const
+{
+	if (Is16Bit())
+	{
+		OutIndices.SetNumUninitialized(Indices16.Num());
+		for (int32 Index = 0; Index < Indices16.Num(); Index++)
+		{
+			OutIndices[Index] = Indices16[Index];
+		}
+	}
+	else
+	{
+		OutIndices = Indices32;
+	}
+}
+
+int64 FTerrainTopology::GetAllocatedSize() const
+{
+	return Indices16.GetAllocatedSize() + Indices32.GetAllocatedSize() + BorderVertices.GetAllocatedSize();
+}
+
+/** Write the grid triangles, then the skirt triangles if BorderVertices is set */
+template<typename IndexType>
+static void WriteTopologyIndices(int32 Width, int32 Height, const TArray<int32>& BorderVertices, TArray<IndexType>& OutIndices)
+{
+	const int32 NumBorder = BorderVertices.Num();
+	OutIndices.SetNumUninitialized(Width * Height * 6 + NumBorder * 6); // 2 triangles per quad, 3 indices per triangle
+	IndexType* Out = OutIndices.GetData();
+
+	for (int32 Y = 0; Y < Height; Y++)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			// Calculate vertex indices for this quad
+			const IndexType BottomLeft = static_cast<IndexType>(Y * (Width + 1) + X);
+			const IndexType BottomRight = static_cast<IndexType>(BottomLeft + 1);
+			const IndexType TopLeft = static_cast<IndexType>((Y + 1) * (Width + 1) + X);
+			const IndexType TopRight = static_cast<IndexType>(TopLeft + 1);
+
+			// First triangle (bottom-left, top-left, top-right)
+			*Out++ = BottomLeft;
+			*Out++ = TopLeft;
+			*Out++ = TopRight;
+
+			// Second triangle (bottom-left, top-right, bottom-right)
+			*Out++ = BottomLeft;
+			*Out++ = TopRight;
+			*Out++ = BottomRight;
+		}
+	}
+
+	// Skirt quads between each border edge and the skirt vertices below it
+	const int32 FirstSkirtVertex = (Width + 1) * (Height + 1);
+	for (int32 BorderIndex = 0; BorderIndex < NumBorder; BorderIndex++)
+	{
+		const int32 Next = (BorderIndex + 1) % NumBorder;
+		const IndexType Top = static_cast<IndexType>(BorderVertices[BorderIndex]);
+		const IndexType TopNext = static_cast<IndexType>(BorderVertices[Next]);
+		const IndexType Bottom = static_cast<IndexType>(FirstSkirtVertex + BorderIndex);
+		const IndexType BottomNext = static_cast<IndexType>(FirstSkirtVertex + Next);
+
+		// Same winding as the terrain triangles, facing out of the grid
+		*Out++ = Top;
+		*Out++ = TopNext;
+		*Out++ = BottomNext;
+
+		*Out++ = Top;
+		*Out++ = BottomNext;
+		*Out++ = Bottom;
+	}
+}
+
+FTerrainTopologyCache& FTerrainTopologyCache::Get()
+{
+	static FTerrainTopologyCache Instance;
+	return Instance;
+}
+
+TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> FTerrainTopologyCache::FindOrCreate(int32 Width, int32 Height, ETerrainTopologyVariant Variant)
+{
+	const FKey Key{ Width, Height, Variant };
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FEntry* Existing = Topologies.Find(Key))
+		{
+			Existing->LastUse = ++UseClock;
+			return Existing->Topology;
+		}
+	}
+
+	// Build outside the lock; if another thread got there first its copy wins
+	TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> Topology = Build(Key);
+
+	FScopeLock ScopeLock(&Lock);
+	if (FEntry* Existing = Topologies.Find(Key))
+	{
+		Existing->LastUse = ++UseClock;
+		return Existing->Topology;
+	}
+	EvictUnreferenced();
+	Topologies.Add(Key, FEntry{ Topology, ++UseClock });
+	return Topology;
+}
+
+void FTerrainTopologyCache::EvictUnreferenced()
+{
+	// References are only handed out under the lock, so a count of one cannot grow while it is held
+	int32 NumUnreferenced = 0;
+	for (const TPair<FKey, FEntry>& Pair : Topologies)
+	{
+		NumUnreferenced += Pair.Value.Topology.GetSharedReferenceCount() == 1 ? 1 : 0;
+	}
+
+	while (NumUnreferenced > MaxUnreferenced)
+	{
+		const FKey* Oldest = nullptr;
+		uint64 OldestUse = TNumericLimits<uint64>::Max();
+		for (const TPair<FKey, FEntry>& Pair : Topologies)
+		{
+			if (Pair.Value.Topology.GetSharedReferenceCount() == 1 && Pair.Value.LastUse < OldestUse)
+			{
+				Oldest = &Pair.Key;
+				OldestUse = Pair.Value.LastUse;
+			}
+		}
+		Topologies.Remove(FKey(*Oldest));
+		NumUnreferenced--;
+	}
+}
+
+void FTerrainTopologyCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Topologies.Empty();
+}
+
+int64 FTerrainTopologyCache::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	int64 Size = Topologies.GetAllocatedSize();
+	for (const TPair<FKey, FEntry>& Pair : Topologies)
+	{
+		Size += sizeof(FTerrainTopology) + Pair.Value.Topology->GetAllocatedSize();
+	}
+	return Size;
+}
+
+TSharedRef<FTerrainTopology, ESPMode::ThreadSafe> FTerrainTopologyCache::Build(const FKey& Key)
+{
+	TSharedRef<FTerrainTopology, ESPMode::ThreadSafe> Topology = MakeShared<FTerrainTopology, ESPMode::ThreadSafe>();
+	Topology->Width = Key.Width;
+	Topology->Height = Key.Height;
+
+	const int32 NumColumns = Key.Width + 1;
+	if (Key.Variant == ETerrainTopologyVariant::Skirted)
+	{
+		// Border vertices walked around the grid, each edge in the same rotational direction
+		TArray<int32>& Border = Topology->BorderVertices;
+		Border.Reserve((Key.Width + Key.Height) * 2);
+		for (int32 X = 0; X < Key.Width; X++)
+		{
+			Border.Add(X);
+		}
+		for (int32 Y = 0; Y < Key.Height; Y++)
+		{
+			Border.Add(Y * NumColumns + Key.Width);
+		}
+		for (int32 X = Key.Width; X > 0; X--)
+		{
+			Border.Add(Key.Height * NumColumns + X);
+		}
+		for (int32 Y = Key.Height; Y > 0; Y--)
+		{
+			Border.Add(Y * NumColumns);
+		}
+	}
+
+	Topology->NumVertices = NumColumns * (Key.Height + 1) + Topology->BorderVertices.Num();
+	if (Topology->NumVertices <= 65536)
+	{
+		WriteTopologyIndices(Key.Width, Key.Height, Topology->BorderVertices, Topology->Indices16);
+	}
+	else
+	{
+		WriteTopologyIndices(Key.Width, Key.Height, Topology->BorderVertices, Topology->Indices32);
+	}
+	return Topology;
+}
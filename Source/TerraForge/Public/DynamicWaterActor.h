@@ -21,6 +21,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void BeginDestroy() override;
 
 public:	
 	virtual void Tick(float DeltaTime) override;
@@ -76,4 +77,7 @@ private:
 
 	/** Current time for wave animation */
 	float CurrentTime;
+
+	/** Mesh section bytes currently counted in STAT_TerraForge_WaterMemory */
+	int64 MeshMemoryBytes = 0;
 };
@@ -5,11 +5,14 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "TerraNoiseTypes.h"
+#include "TerraNoiseSampler.h"
 #include "NoiseGenerator.generated.h"
 
 /**
  * Noise Generator class for procedural terrain generation
- * Implements Perlin and Simplex noise algorithms
+ * Implements Perlin and Simplex noise algorithms.
+ * Blueprint wrapper around FTerraNoiseSampler; copy the sampler with GetSampler() to evaluate noise off the game thread.
  */
 UCLASS(Blueprintable, BlueprintType)
 class TERRAFORGE_API UNoiseGenerator : public UObject
@@ -53,6 +56,66 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
 	float GenerateSimplexNoise2D(float X, float Y, float Scale = 1.0f);
 
+	/**
+	 * Generate multi-octave noise with any noise type and fractal mode
+	 * @param X - X coordinate
+	 * @param Y - Y coordinate
+	 * @param Params - Noise type, scale, octaves and fractal mode
+	 * @return Noise value between 0 and 1. Always evaluated with the scalar kernels, so it is identical to the same position in a
+	 *         GenerateNoiseGrid with ETerraNoiseKernel::Scalar, and within TerraNoiseVectorTolerance of a grid using the vector kernels
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
+	float GenerateFractalNoise2D(float X, float Y, const FTerraNoiseParams& Params);
+
+	/**
+	 * GeneratePerlinNoise2D plus its analytic gradient, from the same noise evaluation
+	 * @param OutGradient - Derivative of the returned value along X and Y, per world unit
+	 * @return Noise value between 0 and 1
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
+	float GeneratePerlinNoise2DWithDerivatives(float X, float Y, FVector2D& OutGradient, float Scale = 1.0f, int32 Octaves = 4, float Persistence = 0.5f, float Lacunarity = 2.0f);
+
+	/**
+	 * GenerateSimplexNoise2D plus its analytic gradient, from the same noise evaluation
+	 * @param OutGradient - Derivative of the returned value along X and Y, per world unit
+	 * @return Noise value between -1 and 1
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
+	float GenerateSimplexNoise2DWithDerivatives(float X, float Y, FVector2D& OutGradient, float Scale = 1.0f);
+
+	/**
+	 * Fill a rectangular grid of noise samples in one call.
+	 * Sample (Column, Row) is taken at Origin + (Column, Row) * Step and written to Out[Row * Width + Column].
+	 * Scale, octave and normalization setup is done once per grid instead of once per sample.
+	 * @param Origin - World position of the first sample
+	 * @param Step - Distance between neighbouring samples
+	 * @param Width - Number of samples per row
+	 * @param Height - Number of rows
+	 * @param Params - Noise parameters shared by all samples
+	 * @param Out - Destination, must hold at least Width * Height values. Values are between 0 and 1 for both noise types
+	 * @param Kernel - Scalar or vector kernels, see TerraNoiseVectorTolerance
+	 */
+	void GenerateNoiseGrid2D(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 Height, const FTerraNoiseParams& Params, TArrayView<float> Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/**
+	 * Evaluate 3D Perlin noise for a batch of points
+	 * @param Points - Sample positions
+	 * @param Scale - Scale of the noise
+	 * @param Out - Destination, must hold at least Points.Num() values between 0 and 1
+	 * @param Kernel - Scalar or vector kernels, see TerraNoiseVectorTolerance
+	 */
+	void GeneratePerlinNoise3DBatch(TConstArrayView<FVector3f> Points, float Scale, TArrayView<float> Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/** Whether ETerraNoiseKernel::Default currently resolves to the vector kernels */
+	static bool UseVectorKernels(ETerraNoiseKernel Kernel);
+
+	/**
+	 * Blueprint version of GenerateNoiseGrid2D
+	 * @param OutValues - Row-major noise values between 0 and 1
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
+	void GenerateNoiseGrid(FVector2D Origin, FVector2D Step, int32 Width, int32 Height, const FTerraNoiseParams& Params, TArray<float>& OutValues);
+
 	/**
 	 * Set the random seed for noise generation
 	 * @param NewSeed - Seed value for reproducible noise
@@ -60,22 +123,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
 	void SetSeed(int32 NewSeed);
 
+	/**
+	 * Select how lattice corners are hashed
+	 * @param NewHashMode - PermutationTable keeps the classic output, IntegerHash removes the 256-cell repeat
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise")
+	void SetHashMode(ETerraNoiseHash NewHashMode);
+
+	/** Get the current hashing backend */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "TerraForge|Noise")
+	ETerraNoiseHash GetHashMode() const { return Sampler.GetHashMode(); }
+
+	/** Get the sampler for the current seed and hash mode */
+	const FTerraNoiseSampler& GetSampler() const { return Sampler; }
+
 private:
-	// Permutation table for Perlin noise
-	TArray<int32> Permutation;
-	
-	// Random seed
-	int32 Seed;
-
-	// Helper functions for Perlin noise
-	float Fade(float T) const;
-	float Lerp(float T, float A, float B) const;
-	float Gradient(int32 Hash, float X, float Y) const;
-	float Gradient3D(int32 Hash, float X, float Y, float Z) const;
-	
-	// Initialize permutation table
-	void InitializePermutation();
-	
-	// Simplex noise helpers
-	float SimplexGradient(int32 Hash, float X, float Y) const;
+	// Sampler rebuilt whenever the seed or hash mode changes
+	FTerraNoiseSampler Sampler;
 };
@@ -7,8 +7,18 @@
 #include "GameFramework/Actor.h"
 #include "ProceduralMeshComponent.h"
 #include "NoiseGenerator.h"
+#include "TerrainMeshBuilder.h"
+#include "TerrainMeshArena.h"
+#include "TerrainHeightmapFile.h"
+#include "TerrainQuadtree.h"
+#include "TerraNoiseGraph.h"
 #include "ProceduralTerrainActor.generated.h"
 
+class AProceduralTerrainActor;
+struct FTerrainThermalErosionJob;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTerrainGenerated, AProceduralTerrainActor*, Terrain);
+
 /**
  * Actor that generates procedural terrain meshes using noise functions
  */
@@ -23,14 +33,33 @@ public:
 protected:
 	virtual void BeginPlay() override;
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
 	virtual void Tick(float DeltaTime) override;
+	virtual bool ShouldTickIfViewportsOnly() const override;
+	virtual void BeginDestroy() override;
 
 	/** Generate the terrain mesh */
 	UFUNCTION(BlueprintCallable, Category = "TerraForge|Terrain")
 	void GenerateTerrain();
 
+	/**
+	 * Build the terrain mesh on the task system and apply it on the game thread when ready.
+	 * Calling again, or calling GenerateTerrain or ClearTerrain, cancels a build still in flight.
+	 * OnTerrainGenerated fires once the new mesh is applied.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Terrain")
+	void GenerateTerrainAsync();
+
+	/** Whether an async build is still running */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "TerraForge|Terrain")
+	bool IsGeneratingAsync() const;
+
+	/** Called after a new terrain mesh has been applied */
+	UPROPERTY(BlueprintAssignable, Category = "TerraForge|Terrain")
+	FOnTerrainGenerated OnTerrainGenerated;
+
 	/** Clear the terrain mesh */
 	UFUNCTION(BlueprintCallable, Category = "TerraForge|Terrain")
 	void ClearTerrain();
@@ -39,6 +68,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UProceduralMeshComponent* ProceduralMesh;
 
+	/** Hidden mesh holding the coarse collision grid with ETerraCollisionMode::Simplified */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UProceduralMeshComponent* CollisionMesh;
+
 	/** Noise generator for terrain */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TerraForge|Terrain")
 	UNoiseGenerator* NoiseGenerator;
@@ -77,6 +110,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "1.0", ClampMax = "4.0"))
 	float Lacunarity = 2.0f;
 
+	/** How noise octaves are combined: fBm, ridged, billow or domain-warped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	ETerraFractalMode FractalMode = ETerraFractalMode::FBM;
+
+	/** Largest domain warp offset, in noise cells */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "0.0", ClampMax = "4.0", EditCondition = "FractalMode == ETerraFractalMode::DomainWarp"))
+	float WarpStrength = 1.0f;
+
+	/** Layered height generator used instead of the noise settings above when set. Noise nodes are seeded from RandomSeed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	UTerraNoiseGraph* HeightGraph = nullptr;
+
+	/** Heightmap baked by TerraBake (.tfheights) read instead of any noise when set. Tiles are paged in from the mapped file as the terrain needs them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (FilePathFilter = "tfheights"))
+	FFilePath HeightmapFile;
+
 	/** Random seed for terrain generation */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
 	int32 RandomSeed = 12345;
@@ -89,13 +138,191 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
 	bool bUseSimplexNoise = false;
 
+	/** Noise hashing backend. IntegerHash removes the repeat every 256 * NoiseScale units but changes the terrain for a given seed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	ETerraNoiseHash NoiseHashMode = ETerraNoiseHash::PermutationTable;
+
+	/** Fill the mesh buffers in row blocks across all worker threads. Output is identical to the single-threaded path */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	bool bParallelGeneration = true;
+
+	/** Shade with normals from the analytic noise gradient, computed in the same pass as the heights, instead of height differences */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	bool bAnalyticNormals = false;
+
+	/** Build on the task system when auto-generating so the game thread and editor never wait on the mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	bool bGenerateAsync = true;
+
+	// Erosion
+
+	/** Droplet erosion carving gullies and filling valleys before the mesh is built. Not applied to quadtree LOD patches */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	FTerraHydraulicErosionParams HydraulicErosion;
+
+	/** Talus erosion settling slopes steeper than TalusAngle. With bProgressive it relaxes the shown mesh over the following frames. Not applied to quadtree LOD patches */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	FTerraThermalErosionParams ThermalErosion;
+
+	// Biomes
+
+	/** Grass, rock, snow and sand weights written to the vertex colors for the terrain material to blend by */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome")
+	FTerraBiomeParams Biome;
+
+	// Collision
+
+	/** Collision cooked for the terrain. Simplified cooks a coarser grid, which is much cheaper than the full mesh, and is the same at every LOD */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision")
+	ETerraCollisionMode CollisionMode = ETerraCollisionMode::FullMesh;
+
+	/** Render quads per collision quad along each axis */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision", meta = (ClampMin = "1", ClampMax = "64", EditCondition = "CollisionMode == ETerraCollisionMode::Simplified"))
+	int32 CollisionGridStep = 4;
+
+	// Quadtree level of detail
+
+	/** Draw the terrain as quadtree patches whose resolution falls off with camera distance. The extent is rounded up to whole LODPatchQuads */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD")
+	bool bUseQuadtreeLOD = false;
+
+	/** Quads per patch side, rounded up to a power of two */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "4", ClampMax = "128"))
+	int32 LODPatchQuads = 32;
+
+	/** Number of detail levels; each level halves the resolution of the one before */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "1", ClampMax = "10"))
+	int32 LODLevels = 5;
+
+	/** Camera distance below which full resolution is used. Each coarser level doubles it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "100.0"))
+	float LODDistance = 6400.0f;
+
+	/** Depth of the skirts that hide cracks between full-resolution patches. Each coarser level doubles it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "0.0"))
+	float LODSkirtDepth = 200.0f;
+
+	/** Blend patch heights towards the next coarser level so level switches do not pop */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD")
+	bool bLODMorph = true;
+
+	/** Fraction of each level's distance range where morphing starts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "0.0", ClampMax = "0.99"))
+	float LODMorphStart = 0.7f;
+
+	/** Camera movement that triggers a new patch selection */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|LOD", meta = (ClampMin = "1.0"))
+	float LODReselectDistance = 1000.0f;
+
+	/** Number of quadtree patches currently drawn */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "TerraForge|LOD")
+	int32 GetNumLODPatches() const { return LODSections.Num(); }
+
 private:
-	/** Generate vertices for the terrain mesh */
-	void GenerateVertices(TArray<FVector>& Vertices, TArray<FVector>& Normals, TArray<FVector2D>& UVs);
+	/** Seed the noise generator and snapshot the current parameters */
+	FTerrainBuildSettings MakeBuildSettings();
+
+	/** Replace the mesh section with built mesh data */
+	void ApplyMeshData(const FTerrainMeshData& MeshData);
+
+	/** Begin progressive thermal erosion of the mesh just built with Settings, if the settings ask for it */
+	void StartThermalErosion(const FTerrainBuildSettings& Settings);
+
+	/** Stop progressive thermal erosion, leaving the mesh as it was after the last slice */
+	void StopThermalErosion();
+
+	/**
+	 * Run the next progressive thermal erosion slice on the task system. Slices only move the render vertices;
+	 * the last one applies the full mesh, cooking collision and broadcasting OnTerrainGenerated once
+	 */
+	void StepThermalErosion();
+
+	/** Update the positions, normals and colors of render section 0 from a slice, leaving its collision as it is */
+	void ApplyThermalSlice(const FTerrainMeshData& MeshData);
+
+	/** Cancel the in-flight async build and discard its result */
+	void CancelPendingBuild();
+
+	/**
+	 * Run Build on the task system, then Apply on the game thread unless a newer build superseded it
+	 * @param Build - Returns false when cancelled
+	 */
+	void RunAsyncBuild(TUniqueFunction<bool(const std::atomic<bool>&)>&& Build, TUniqueFunction<void(AProceduralTerrainActor&)>&& Apply);
+
+	/** Snapshot the quadtree settings */
+	FTerrainLODSettings MakeLODSettings();
+
+	/** Camera position in terrain space, or false if there is no player camera */
+	bool GetLODCameraLocation(FVector& OutLocation) const;
+
+	/** Select quadtree patches for the current camera and rebuild the ones that changed */
+	void UpdateLOD(bool bAsync);
+
+	/** Replace the patches that are no longer selected with newly built ones */
+	void ApplyLODPatches(const TArray<FTerrainQuadtreeNode>& SelectedNodes, const TArray<FTerrainQuadtreeNode>& BuiltNodes, const TArray<FTerrainMeshData>& BuiltPatches);
+
+	/** Forget all quadtree patch sections */
+	void ResetLODSections();
+
+	/** Remove every mesh section and forget the patch and topology bookkeeping */
+	void ClearMeshSections();
+
+	/** Move a section's buffers into the arena before the section is cleared */
+	void ReleaseSectionBuffers(int32 SectionIndex);
+
+	/** Pooled build and section buffers, created on first use */
+	FTerrainMeshArena& GetMeshArena();
+
+	/**
+	 * Create a mesh section, or update it in place when it already has the same topology.
+	 * The section carries collision when MeshData was built for ETerraCollisionMode::FullMesh
+	 * @param bUpdateUVs - Upload UVs on update; single-mesh UVs only depend on the grid size
+	 * @return True if the section was (re)created rather than updated
+	 */
+	bool ApplySection(int32 SectionIndex, const FTerrainMeshData& MeshData, bool bUpdateUVs);
+
+	/** Replace the simplified collision grid, or clear it when empty */
+	void ApplyCollision(const TArray<FVector>& Vertices, const TArray<int32>& Triangles);
+
+	/** Recount the mesh section memory reported by "stat TerraForge" */
+	void UpdateMeshMemoryStat();
+
+	// Incremented whenever a build starts or is cancelled; stale async results are dropped
+	uint32 BuildSerial = 0;
+
+	// Cancel flag shared with the in-flight async build
+	TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> PendingCancelFlag;
+
+	// Mesh section drawing each selected quadtree patch
+	TMap<FTerrainQuadtreeNode, int32> LODSections;
+
+	// Section indices freed by patches that were deselected
+	TArray<int32> FreeLODSections;
+
+	// Number of section indices handed out to patches
+	int32 NumLODSectionSlots = 0;
+
+	// Shared index buffer each mesh section was created from, to detect sections that can be updated in place
+	TArray<TSharedPtr<const FTerrainTopology, ESPMode::ThreadSafe>> SectionTopologies;
+
+	// Camera position used for the current patch selection
+	FVector LastLODCamera = FVector::ZeroVector;
+
+	// Whether CollisionMesh matches the current quadtree terrain; patch reselection leaves it alone
+	bool bLODCollisionValid = false;
+
+	// Mesh section bytes currently counted in STAT_TerraForge_TerrainMemory
+	int64 MeshMemoryBytes = 0;
+
+	// Buffers reused across regenerations; shared so in-flight async builds can still return theirs
+	TSharedPtr<FTerrainMeshArena, ESPMode::ThreadSafe> MeshArena;
+
+	// Heights being relaxed by progressive thermal erosion, shared with the slice in flight
+	TSharedPtr<FTerrainThermalErosionJob, ESPMode::ThreadSafe> ThermalJob;
 
-	/** Generate triangles for the terrain mesh */
-	void GenerateTriangles(TArray<int32>& Triangles);
+	// HeightmapFile as last opened, kept across builds so decoded tiles stay cached
+	TSharedPtr<const FTerrainHeightmapFile, ESPMode::ThreadSafe> Heightmap;
 
-	/** Calculate normals for smooth terrain shading */
-	void CalculateNormals(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, TArray<FVector>& Normals);
+	// Path Heightmap was opened from; a failed open is not retried until the path changes
+	FString OpenedHeightmapPath;
 };
@@ -0,0 +1,73 @@
+// TerraForge - Procedural World Generator
+// Headless world bake writing tiled 16-bit heightmaps
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TerrainMeshBuilder.h"
+#include "TerrainHeightmapFile.h"
+#include "TerraBakeCommandlet.generated.h"
+
+class FJsonObject;
+
+/**
+ * Bakes a square world of noise heights into tiles on every core, with no world, actor or renderer, and writes a JSON manifest next to them.
+ * Each tile holds (TileSize + 1)^2 little-endian 16-bit samples, sharing its last row and column with the next tile like landscape imports do.
+ * Tiles are written as one .r16 file each, or with -format=Tiled into a single FTerrainHeightmapFile that the terrain actors can stream from.
+ * Run headless with: UnrealEditor-Cmd TerraForge.uproject -run=TerraBake -nullrhi -unattended [-output=Dir] [-extent=16384] [-tilesize=512] [-seed=12345]
+ *   [-noise=Perlin|Simplex] [-fractal=FBM|Ridged|Billow|DomainWarp] [-hash=PermutationTable|IntegerHash] [-scale=100] [-octaves=4] [-persistence=0.5]
+ *   [-lacunarity=2] [-warp=1] [-gridsize=100] [-maxheight=2000] [-format=R16|Tiled] [-codec=None|LZ4|Oodle]
+ */
+UCLASS()
+class TERRAFORGE_API UTerraBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTerraBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Read the noise and world arguments, defaulting to the terrain actor's settings. False on an unknown enum value */
+	bool ParseSettings(const FString& Params);
+
+	/** Build settings for the tile at (TileX, TileY) */
+	FTerrainBuildSettings MakeTileSettings(int32 TileX, int32 TileY) const;
+
+	/** File name of a tile, relative to the output directory */
+	static FString GetTileFileName(int32 TileX, int32 TileY);
+
+	/** Everything needed to regenerate or load the baked tiles */
+	TSharedRef<FJsonObject> MakeManifest(double Seconds, uint64 PeakUsedPhysical) const;
+
+	// Directory the tiles and manifest are written to
+	FString OutputDirectory;
+
+	// World size in quads along each axis, rounded up to whole tiles
+	int32 ExtentQuads = 16384;
+
+	// Quads per tile along each axis
+	int32 TileQuads = 512;
+
+	// Noise seed and hashing, as on AProceduralTerrainActor
+	int32 Seed = 12345;
+	ETerraNoiseHash HashMode = ETerraNoiseHash::PermutationTable;
+
+	// Noise shared by every tile
+	FTerraNoiseParams NoiseParams;
+
+	// Grid spacing and height range the tiles are generated for
+	float GridSize = 100.0f;
+	float MaxHeight = 2000.0f;
+
+	// Seeded noise sampled by every tile
+	FTerraNoiseSampler Sampler;
+
+	// Write one FTerrainHeightmapFile instead of one .r16 file per tile
+	bool bTiledFile = false;
+
+	// Tile compression in the tiled file
+	ETerraHeightmapCodec Codec = ETerraHeightmapCodec::LZ4;
+};
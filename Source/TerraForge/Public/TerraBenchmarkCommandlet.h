@@ -0,0 +1,45 @@
+// TerraForge - Procedural World Generator
+// Headless noise and terrain benchmark with JSON output
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TerraBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Measures noise sampling cost and full terrain generation, and writes the results as JSON so runs can be diffed between revisions.
+ * Run headless with: UnrealEditor-Cmd TerraForge.uproject -run=TerraBenchmark -nullrhi -unattended [-output=Path.json] [-samples=N] [-runs=N] [-terrainruns=N]
+ */
+UCLASS()
+class TERRAFORGE_API UTerraBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTerraBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** ns/sample for the UNoiseGenerator entry points */
+	TArray<TSharedPtr<FJsonValue>> RunNoiseBenchmarks() const;
+
+	/** GenerateTerrain time and memory for one TerrainWidth x TerrainHeight grid, or nullptr if no world could be created */
+	TSharedPtr<FJsonObject> RunTerrainBenchmark(int32 GridQuads) const;
+
+	/** Hydraulic erosion grid cells/sec from an empty tile cache and thermal erosion cell updates/sec on one grid, single-threaded and on all workers */
+	TSharedPtr<FJsonObject> RunErosionBenchmark(int32 GridQuads) const;
+
+	// Noise samples per timed run
+	int32 NumSamples = 1000000;
+
+	// Timed runs per noise benchmark; the fastest is reported
+	int32 NumRuns = 5;
+
+	// GenerateTerrain calls per grid size
+	int32 NumTerrainRuns = 3;
+};
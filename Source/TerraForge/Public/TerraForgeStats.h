@@ -0,0 +1,60 @@
+// TerraForge - Procedural World Generator
+// Stats, trace, CSV and LLM instrumentation shared by the terrain and water generators
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("TerraForge"), STATGROUP_TerraForge, STATCAT_Advanced);
+
+// Generation stages, shown by "stat TerraForge"
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Terrain"), STAT_TerraForge_GenerateTerrain, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Heights"), STAT_TerraForge_Heights, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Vertices"), STAT_TerraForge_Vertices, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangles"), STAT_TerraForge_Triangles, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hydraulic Erosion"), STAT_TerraForge_HydraulicErosion, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Thermal Erosion"), STAT_TerraForge_ThermalErosion, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Normals"), STAT_TerraForge_Normals, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Grid"), STAT_TerraForge_Collision, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pack Section"), STAT_TerraForge_PackSection, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LOD Patches"), STAT_TerraForge_LODPatches, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Mesh Section"), STAT_TerraForge_MeshSection, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chunk Cache Load"), STAT_TerraForge_ChunkCacheLoad, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chunk Cache Save"), STAT_TerraForge_ChunkCacheSave, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Heightmap Tile Load"), STAT_TerraForge_HeightmapTileLoad, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Chunks"), STAT_TerraForge_ApplyChunks, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Water Mesh"), STAT_TerraForge_GenerateWaterMesh, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Water Vertices"), STAT_TerraForge_WaterVertices, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Water Triangles"), STAT_TerraForge_WaterTriangles, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Water Mesh Section"), STAT_TerraForge_WaterMeshSection, STATGROUP_TerraForge, TERRAFORGE_API);
+
+// Mesh section memory held by the components
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Terrain Mesh Memory"), STAT_TerraForge_TerrainMemory, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Chunk Mesh Memory"), STAT_TerraForge_ChunkMemory, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pooled Mesh Buffers"), STAT_TerraForge_ArenaMemory, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Water Mesh Memory"), STAT_TerraForge_WaterMemory, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Erosion Droplets"), STAT_TerraForge_ErosionDroplets, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Erosion Tiles Reused"), STAT_TerraForge_ErosionTilesReused, STATGROUP_TerraForge, TERRAFORGE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Loaded Chunks"), STAT_TerraForge_NumChunks, STATGROUP_TerraForge, TERRAFORGE_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(TERRAFORGE_API, TerraForge);
+
+LLM_DECLARE_TAG_API(TerraForge, TERRAFORGE_API);
+
+class UProceduralMeshComponent;
+
+/** CPU-side vertex and index bytes held by all sections of a procedural mesh */
+TERRAFORGE_API int64 GetMeshSectionMemoryBytes(const UProceduralMeshComponent* Mesh);
+
+/**
+ * Times one generation stage as a cycle counter, an Insights CPU event and a CSV timer, all named after Stage.
+ * Works on worker threads; the CSV and trace scopes are recorded per thread.
+ */
+#define TERRAFORGE_STAGE_SCOPE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_TerraForge_##Stage); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(TerraForge_##Stage); \
+	CSV_SCOPED_TIMING_STAT(TerraForge, Stage)
@@ -0,0 +1,189 @@
+// TerraForge - Procedural World Generator
+// Layered noise graph asset and its compiled block evaluator
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TerraNoiseSampler.h"
+#include "TerraNoiseGraph.generated.h"
+
+/**
+ * Operation performed by a noise graph node
+ */
+UENUM(BlueprintType)
+enum class ETerraNoiseNodeOp : uint8
+{
+	/** Fractal noise between 0 and 1. InputA and InputB, if set, offset the sample position along X and Y by WarpStrength times their value */
+	Noise,
+	/** Value */
+	Constant,
+	/** InputA + InputB */
+	Add,
+	/** InputA - InputB */
+	Subtract,
+	/** InputA * InputB */
+	Multiply,
+	/** Smaller of InputA and InputB */
+	Min,
+	/** Larger of InputA and InputB */
+	Max,
+	/** Absolute value of InputA */
+	Abs,
+	/** InputA raised to Exponent; negative values keep their sign */
+	Power,
+	/** InputA to InputB by InputC */
+	Lerp,
+	/** InputA mapped linearly from InputRange to OutputRange */
+	Remap,
+	/** InputA clamped to OutputRange */
+	Clamp,
+	/** InputA where InputC is below Threshold, InputB above, blended smoothly across Falloff */
+	Select
+};
+
+/**
+ * One node of a noise graph. Inputs are indices into UTerraNoiseGraph::Nodes, or -1 when unused.
+ */
+USTRUCT(BlueprintType)
+struct TERRAFORGE_API FTerraNoiseGraphNode
+{
+	GENERATED_BODY()
+
+	/** Label shown in error messages */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	ETerraNoiseNodeOp Op = ETerraNoiseNodeOp::Noise;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	int32 InputA = -1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	int32 InputB = -1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	int32 InputC = -1;
+
+	/** Noise evaluated by Noise nodes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Noise"))
+	FTerraNoiseParams Noise;
+
+	/** Added to the terrain seed so layers using the same noise settings still differ */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Noise"))
+	int32 SeedOffset = 0;
+
+	/** World units of position offset per unit of the warp inputs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Noise"))
+	float WarpStrength = 100.0f;
+
+	/** Output of Constant nodes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Constant"))
+	float Value = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Power"))
+	float Exponent = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Remap"))
+	FVector2D InputRange = FVector2D(0.0, 1.0);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Remap || Op == ETerraNoiseNodeOp::Clamp"))
+	FVector2D OutputRange = FVector2D(0.0, 1.0);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Select"))
+	float Threshold = 0.5f;
+
+	/** Width of the blend around Threshold; 0 switches sharply */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph", meta = (EditCondition = "Op == ETerraNoiseNodeOp::Select", ClampMin = "0.0"))
+	float Falloff = 0.1f;
+};
+
+/**
+ * Noise graph compiled into a flat instruction list over scratch registers.
+ * Samples are evaluated in blocks of BlockSize, and every instruction is a tight loop over the block.
+ * Immutable once compiled, so one program can be evaluated from several threads at once.
+ */
+struct TERRAFORGE_API FTerraNoiseProgram
+{
+	/** Samples evaluated per instruction */
+	static constexpr int32 BlockSize = 64;
+
+	struct FInstruction
+	{
+		ETerraNoiseNodeOp Op;
+
+		/** Register written */
+		int32 Output;
+
+		/** Registers read, -1 when unused */
+		int32 Inputs[3];
+
+		/** Op-specific constants */
+		float Params[4];
+
+		/** Index into Samplers and NoiseParams for Noise instructions */
+		int32 NoiseIndex;
+	};
+
+	TArray<FInstruction> Instructions;
+	TArray<FTerraNoiseSampler> Samplers;
+	TArray<FTerraNoiseParams> NoiseParams;
+
+	/** Scratch registers needed, each BlockSize floats */
+	int32 NumRegisters = 0;
+
+	/** Register holding the result after the last instruction */
+	int32 OutputRegister = INDEX_NONE;
+
+	bool IsValid() const { return OutputRegister != INDEX_NONE; }
+
+	/** Evaluate any number of world positions */
+	void Evaluate(const float* X, const float* Y, int32 Count, float* Out) const;
+
+	/** Evaluate rows of a grid laid out like FTerraNoiseSampler::NoiseGridRows */
+	void EvaluateGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, TArrayView<float> Out) const;
+
+private:
+	/** Run every instruction for up to BlockSize positions; returns the output register */
+	const float* EvaluateBlock(const float* X, const float* Y, int32 Count, float* Registers) const;
+};
+
+/**
+ * Data asset describing a layered height generator: noise sources combined with math, remap, select and warp nodes.
+ * Assign it to AProceduralTerrainActor::HeightGraph to replace the built-in single noise layer.
+ */
+UCLASS(BlueprintType)
+class TERRAFORGE_API UTerraNoiseGraph : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Graph nodes; inputs refer to other entries by index */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	TArray<FTerraNoiseGraphNode> Nodes;
+
+	/** Node whose value becomes the normalized terrain height */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise Graph")
+	int32 OutputNode = 0;
+
+	/**
+	 * Compile the nodes reachable from OutputNode into a program
+	 * @param Seed - Base seed, combined with each noise node's SeedOffset
+	 * @param HashMode - Hashing backend for every noise node
+	 * @param OutError - Why compilation failed, if it did
+	 * @return The program, or nullptr on a missing input or a cycle
+	 */
+	TSharedPtr<const FTerraNoiseProgram, ESPMode::ThreadSafe> Compile(int32 Seed, ETerraNoiseHash HashMode, FString* OutError = nullptr) const;
+
+	/**
+	 * Evaluate the graph at one position. Compiles on every call, so use Compile for bulk evaluation
+	 * @return Graph value, or 0 if the graph does not compile
+	 */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Noise Graph")
+	float EvaluateAt(FVector2D Position, int32 Seed = 12345) const;
+
+#if WITH_EDITOR
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
+};
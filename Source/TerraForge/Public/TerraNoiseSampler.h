@@ -0,0 +1,109 @@
+// TerraForge - Procedural World Generator
+// Thread-safe noise sampler value type
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerraNoiseTypes.h"
+
+/**
+ * Immutable noise sampler built from a seed and hash mode.
+ * Holds its own permutation table and has no UObject or global state, so copies can be
+ * evaluated concurrently from worker threads without locks.
+ */
+struct TERRAFORGE_API FTerraNoiseSampler
+{
+public:
+	/** Sampler using the standard Perlin permutation table */
+	FTerraNoiseSampler();
+
+	/**
+	 * Sampler with a permutation table shuffled from a seed
+	 * @param InSeed - Seed value for reproducible noise
+	 * @param InHashMode - How lattice corners are hashed
+	 */
+	explicit FTerraNoiseSampler(int32 InSeed, ETerraNoiseHash InHashMode = ETerraNoiseHash::PermutationTable);
+
+	/** Copy of this sampler with the same permutation table and a different hash mode */
+	FTerraNoiseSampler WithHashMode(ETerraNoiseHash InHashMode) const;
+
+	/** Multi-octave 2D Perlin noise between 0 and 1, see UNoiseGenerator::GeneratePerlinNoise2D */
+	float Perlin2D(float X, float Y, float Scale, int32 Octaves, float Persistence, float Lacunarity) const;
+
+	/** 3D Perlin noise between 0 and 1, see UNoiseGenerator::GeneratePerlinNoise3D */
+	float Perlin3D(float X, float Y, float Z, float Scale) const;
+
+	/** 2D Simplex noise between -1 and 1, see UNoiseGenerator::GenerateSimplexNoise2D */
+	float Simplex2D(float X, float Y, float Scale) const;
+
+	/**
+	 * Perlin2D plus its analytic gradient
+	 * @param OutGradient - Derivative of the returned value along X and Y, per world unit
+	 */
+	float Perlin2DWithDerivatives(float X, float Y, float Scale, int32 Octaves, float Persistence, float Lacunarity, FVector2f& OutGradient) const;
+
+	/**
+	 * Simplex2D plus its analytic gradient
+	 * @param OutGradient - Derivative of the returned value along X and Y, per world unit
+	 */
+	float Simplex2DWithDerivatives(float X, float Y, float Scale, FVector2f& OutGradient) const;
+
+	/** One sample of the fractal noise described by Params, between 0 and 1. Uses the scalar kernels, so it matches scalar grids exactly and vector grids within TerraNoiseVectorTolerance */
+	float Fractal2D(float X, float Y, const FTerraNoiseParams& Params) const;
+
+	/** Fill a grid of samples between 0 and 1, see UNoiseGenerator::GenerateNoiseGrid2D */
+	void NoiseGrid2D(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 Height, const FTerraNoiseParams& Params, TArrayView<float> Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/**
+	 * Fill rows [FirstRow, FirstRow + NumRows) of the grid described by NoiseGrid2D.
+	 * Lets callers split one grid across threads with output identical to a single NoiseGrid2D call.
+	 * @param Out - Destination for the requested rows only, must hold at least Width * NumRows values
+	 */
+	void NoiseGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, TArrayView<float> Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/**
+	 * NoiseGridRows that also writes the analytic gradient of every sample, from the same noise evaluations
+	 * @param OutDX - Derivative along X per world unit, same layout as Out
+	 * @param OutDY - Derivative along Y per world unit, same layout as Out
+	 */
+	void NoiseGridRowsWithDerivatives(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, TArrayView<float> Out, TArrayView<float> OutDX, TArrayView<float> OutDY, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/**
+	 * Fractal noise described by Params for arbitrary positions, between 0 and 1. Matches the grid functions
+	 * @param X, Y - World positions, Count of each
+	 * @param Out - Destination, Count values
+	 */
+	void FractalPoints(const FTerraNoiseParams& Params, const float* X, const float* Y, int32 Count, float* Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/** Evaluate 3D Perlin noise between 0 and 1 for a batch of points, see UNoiseGenerator::GeneratePerlinNoise3DBatch */
+	void Perlin3DBatch(TConstArrayView<FVector3f> Points, float Scale, TArrayView<float> Out, ETerraNoiseKernel Kernel = ETerraNoiseKernel::Default) const;
+
+	/**
+	 * Single-octave noise in [-1, 1] for a batch of points already divided by the noise scale
+	 * @param bVector - Use the 4-wide kernels
+	 */
+	void EvaluatePoints(ETerraNoiseType NoiseType, bool bVector, const float* X, const float* Y, int32 Count, float* Out) const;
+	void EvaluatePoints3D(bool bVector, const float* X, const float* Y, const float* Z, int32 Count, float* Out) const;
+
+	/** EvaluatePoints that also writes the derivatives along X and Y in scaled coordinates */
+	void EvaluatePointsWithDerivatives(ETerraNoiseType NoiseType, bool bVector, const float* X, const float* Y, int32 Count, float* Out, float* OutDX, float* OutDY) const;
+
+	/** Whether a kernel selection resolves to the vector kernels */
+	static bool UseVectorKernels(ETerraNoiseKernel Kernel);
+
+	int32 GetSeed() const { return Seed; }
+	ETerraNoiseHash GetHashMode() const { return HashMode; }
+
+private:
+	/** Shared row loop of NoiseGridRows and NoiseGridRowsWithDerivatives; derivatives are skipped when OutDX is null */
+	void FillGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, const FTerraNoiseParams& Params, float* Out, float* OutDX, float* OutDY, ETerraNoiseKernel Kernel) const;
+
+	// Random seed
+	int32 Seed;
+
+	// Hashing backend for lattice corners
+	ETerraNoiseHash HashMode;
+
+	// Permutation table, duplicated to 512 entries for wrapping
+	uint8 Permutation[512];
+};
@@ -0,0 +1,107 @@
+// TerraForge - Procedural World Generator
+// Shared noise parameter types
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerraNoiseTypes.generated.h"
+
+/** Upper bound on octaves evaluated by the grid noise functions */
+static constexpr int32 TerraMaxNoiseOctaves = 16;
+
+/** Octave counts up to this get a dedicated fractal kernel with the octave loop unrolled */
+static constexpr int32 TerraMaxSpecializedOctaves = 8;
+
+/**
+ * Largest difference between the vector and scalar kernels on normalized output.
+ * Both kernels use the same operation order; the tolerance covers platforms that fuse multiply-adds.
+ */
+static constexpr float TerraNoiseVectorTolerance = 1.0e-5f;
+
+/**
+ * Kernel used by the grid and batch evaluation functions
+ */
+enum class ETerraNoiseKernel : uint8
+{
+	/** Vector kernels unless disabled with TerraForge.Noise.SIMD 0 */
+	Default,
+	/** Scalar reference kernels */
+	Scalar,
+	/** 4-wide vector kernels (SSE or NEON through VectorRegister4Float) */
+	Vector
+};
+
+/**
+ * Noise algorithm used by the grid evaluation functions
+ */
+UENUM(BlueprintType)
+enum class ETerraNoiseType : uint8
+{
+	Perlin,
+	Simplex
+};
+
+/**
+ * How octaves are combined by the grid evaluation functions
+ */
+UENUM(BlueprintType)
+enum class ETerraFractalMode : uint8
+{
+	/** Fractional Brownian motion, the plain sum of octaves */
+	FBM UMETA(DisplayName = "fBm"),
+	/** Sharp ridges from inverted absolute noise, each octave weighted by the one before */
+	Ridged,
+	/** Rounded hills from absolute noise */
+	Billow,
+	/** fBm sampled at positions offset by two further fBm fields */
+	DomainWarp
+};
+
+/**
+ * How lattice corner hashes are computed
+ */
+UENUM(BlueprintType)
+enum class ETerraNoiseHash : uint8
+{
+	/** Seeded 256-entry permutation table, noise repeats every 256 cells */
+	PermutationTable,
+	/** Seeded arithmetic hash, no table and no repeat period */
+	IntegerHash
+};
+
+/**
+ * Parameters shared by every sample of a noise grid
+ */
+USTRUCT(BlueprintType)
+struct TERRAFORGE_API FTerraNoiseParams
+{
+	GENERATED_BODY()
+
+	/** Noise algorithm to evaluate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise")
+	ETerraNoiseType NoiseType = ETerraNoiseType::Perlin;
+
+	/** Scale of the noise */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise")
+	float Scale = 1.0f;
+
+	/** Number of noise octaves for detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 Octaves = 4;
+
+	/** Amplitude multiplier for each octave */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise")
+	float Persistence = 0.5f;
+
+	/** Frequency multiplier for each octave */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise")
+	float Lacunarity = 2.0f;
+
+	/** How octaves are combined */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise")
+	ETerraFractalMode FractalMode = ETerraFractalMode::FBM;
+
+	/** Largest DomainWarp offset, in noise cells */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Noise", meta = (ClampMin = "0.0", EditCondition = "FractalMode == ETerraFractalMode::DomainWarp"))
+	float WarpStrength = 1.0f;
+};
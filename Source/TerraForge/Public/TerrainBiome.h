@@ -0,0 +1,123 @@
+// TerraForge - Procedural World Generator
+// Biome classification into material splat weights
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerraNoiseSampler.h"
+#include "TerrainBiome.generated.h"
+
+/**
+ * Per-vertex material layer weights from height, slope and two low-frequency climate fields.
+ * Heights are normalized like the height grid, so 1 is MaxHeight
+ */
+USTRUCT(BlueprintType)
+struct TERRAFORGE_API FTerraBiomeParams
+{
+	GENERATED_BODY()
+
+	/**
+	 * Write grass, rock, snow and sand weights to the vertex color R, G, B and A channels, summing to 255.
+	 * When off, vertex colors hold the normalized height as gray, which materials made before biomes expect
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome")
+	bool bEnabled = false;
+
+	/** Height below which shores turn to sand */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float SandHeight = 0.08f;
+
+	/** Height over which sand blends into grass, each side of SandHeight */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "0.5", EditCondition = "bEnabled"))
+	float SandBlend = 0.03f;
+
+	/** Height of the snow line at average temperature */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float SnowHeight = 0.75f;
+
+	/** Height over which snow fades in, each side of the snow line */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "0.5", EditCondition = "bEnabled"))
+	float SnowBlend = 0.05f;
+
+	/** How far the snow line moves between the coldest and the warmest regions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float TemperatureRange = 0.2f;
+
+	/** Slope in degrees above which the ground is bare rock, whatever the height or climate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "90.0", EditCondition = "bEnabled"))
+	float RockSlope = 40.0f;
+
+	/** Slope range in degrees over which rock blends in, centred on RockSlope */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "45.0", EditCondition = "bEnabled"))
+	float RockBlend = 10.0f;
+
+	/** Moisture, between 0 and 1, below which grass gives way to sand */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float DryMoisture = 0.3f;
+
+	/** Moisture over which dry sand blends into grass, each side of DryMoisture */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "0.0", ClampMax = "0.5", EditCondition = "bEnabled"))
+	float MoistureBlend = 0.1f;
+
+	/** Scale of the moisture and temperature noise, in the same units as the terrain's noise scale */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome", meta = (ClampMin = "1.0", EditCondition = "bEnabled"))
+	float ClimateScale = 20000.0f;
+};
+
+/**
+ * Thresholds derived once per build from FTerraBiomeParams, then applied to every vertex.
+ * Holds no state between calls, so one classifier can be shared by all worker threads
+ */
+struct TERRAFORGE_API FTerrainBiomeClassifier
+{
+	explicit FTerrainBiomeClassifier(const FTerraBiomeParams& Params);
+
+	/**
+	 * Sample moisture and temperature, both between 0 and 1, for rows of a vertex grid. Takes the same grid arguments as FTerraNoiseSampler::NoiseGridRows.
+	 * Both fields come from the terrain's own seeded sampler, offset far apart so they do not follow each other or the heights
+	 */
+	void SampleClimateRows(const FTerraNoiseSampler& Sampler, const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows,
+		TArrayView<float> OutMoisture, TArrayView<float> OutTemperature) const;
+
+	/**
+	 * Splat weights of one vertex: R grass, G rock, B snow, A sand. Rock claims steep slopes first, snow covers what is left above the snow line,
+	 * and sand takes low or dry ground from the remaining grass
+	 * @param Height - Normalized height
+	 * @param NormalZ - Up component of the unit normal, the cosine of the slope
+	 */
+	FORCEINLINE FColor Classify(float Height, float NormalZ, float Moisture, float Temperature) const
+	{
+		const float Rock = 1.0f - FMath::SmoothStep(RockCosSteep, RockCosFlat, NormalZ);
+
+		// Warm regions push the snow line up, cold ones pull it down
+		const float SnowLine = SnowHeight + (Temperature - 0.5f) * TemperatureRange;
+		const float Snow = (1.0f - Rock) * FMath::SmoothStep(SnowLine - SnowBlend, SnowLine + SnowBlend, Height);
+
+		const float Shore = 1.0f - FMath::SmoothStep(SandHeight - SandBlend, SandHeight + SandBlend, Height);
+		const float Dry = 1.0f - FMath::SmoothStep(DryMoisture - MoistureBlend, DryMoisture + MoistureBlend, Moisture);
+		const float Sand = (1.0f - Rock - Snow) * FMath::Max(Shore, Dry);
+
+		// Grass takes the rest, so the channels always sum to 255
+		const int32 RockWeight = FMath::RoundToInt(Rock * 255.0f);
+		const int32 SnowWeight = FMath::RoundToInt(Snow * 255.0f);
+		const int32 SandWeight = FMath::RoundToInt(Sand * 255.0f);
+		const int32 GrassWeight = FMath::Max(255 - RockWeight - SnowWeight - SandWeight, 0);
+		return FColor(static_cast<uint8>(GrassWeight), static_cast<uint8>(RockWeight), static_cast<uint8>(SnowWeight), static_cast<uint8>(SandWeight));
+	}
+
+private:
+	// Noise shared by both climate fields
+	FTerraNoiseParams ClimateNoise;
+
+	// Cosines of the slopes where rock is complete and where it starts
+	float RockCosSteep;
+	float RockCosFlat;
+
+	float SandHeight;
+	float SandBlend;
+	float SnowHeight;
+	float SnowBlend;
+	float TemperatureRange;
+	float DryMoisture;
+	float MoistureBlend;
+};
@@ -0,0 +1,46 @@
+// TerraForge - Procedural World Generator
+// On-disk cache of generated chunk heights and normals
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainMeshBuilder.h"
+
+/**
+ * Stores the heights and normals of built chunks on disk, one file per chunk, named by a hash of every setting that affects them.
+ * Loading maps the file and validates it against the hash, so a warm start rebuilds chunks without evaluating any noise.
+ * Changing the seed or any noise parameter changes the key, so stale files are never read; they are simply left unused.
+ * Load and Save touch only the file for their key and can run on any thread.
+ */
+class TERRAFORGE_API FTerrainChunkDiskCache
+{
+public:
+	/** @param InDirectory - Folder for the chunk files, created on the first save */
+	explicit FTerrainChunkDiskCache(FString InDirectory);
+
+	/** Saved/TerraForge/ChunkCache under the project */
+	static FString GetDefaultDirectory();
+
+	/** Whether chunks built with these settings can be cached. Noise graph programs and heightmaps are not part of the key, so they are not */
+	static bool CanCache(const FTerrainBuildSettings& Settings);
+
+	/** Hash of the seed, hash mode, noise parameters, erosion parameters, grid layout and noise origin, which also identifies the chunk */
+	static uint64 MakeKey(const FTerrainBuildSettings& Settings);
+
+	/**
+	 * Read a cached chunk into OutData's Heights, Normals and Tangents, ready for FTerrainMeshBuilder::BuildFromHeightsAndNormals
+	 * @return False on a miss, or when the file does not match the key, the grid size or its payload hash
+	 */
+	bool Load(uint64 Key, const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData) const;
+
+	/** Write the heights and normals of a built chunk. Written to a temporary file and renamed, so readers never see a partial file */
+	bool Save(uint64 Key, const FTerrainBuildSettings& Settings, const FTerrainMeshData& Data) const;
+
+	const FString& GetDirectory() const { return Directory; }
+
+private:
+	FString GetChunkPath(uint64 Key) const;
+
+	// Folder holding one file per key
+	FString Directory;
+};
@@ -0,0 +1,336 @@
+// TerraForge - Procedural World Generator
+// Camera-driven streaming of terrain chunks
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProceduralMeshComponent.h"
+#include "Containers/Queue.h"
+#include "TerrainMeshBuilder.h"
+#include "TerrainMeshArena.h"
+#include "TerrainHeightfieldComponent.h"
+#include "TerrainChunkDiskCache.h"
+#include "TerrainHeightmapFile.h"
+#include "TerrainChunkManager.generated.h"
+
+/**
+ * One streamed terrain tile
+ */
+USTRUCT()
+struct FTerrainChunk
+{
+	GENERATED_BODY()
+
+	/** Mesh component showing this chunk, or only holding its collision when Heightfield draws it */
+	UPROPERTY()
+	UProceduralMeshComponent* Mesh = nullptr;
+
+	/** Compact renderer for the chunk with ATerrainChunkManager::bCompactVertices, null otherwise */
+	UPROPERTY()
+	UTerrainHeightfieldComponent* Heightfield = nullptr;
+
+	/** CPU-side mesh section memory counted against the cache cap */
+	int64 MemoryBytes = 0;
+
+	/** Frame the chunk was last inside the load radius, used for LRU eviction */
+	uint64 LastUsedFrame = 0;
+
+	/** Whether the chunk is currently inside the load radius and shown */
+	bool bVisible = false;
+
+	/** Whether the chunk currently has cooked collision */
+	bool bCollision = false;
+
+	/** Coarse collision grid, kept so collision can be recreated when a physics actor comes near. Only with ETerraCollisionMode::Simplified */
+	TArray<FVector> CollisionVertices;
+	TArray<int32> CollisionTriangles;
+};
+
+/**
+ * Divides an unbounded world into square chunks and streams them around the camera.
+ * Chunks inside LoadRadius are built on the task system and shown; chunks that leave the radius are
+ * hidden but kept as a cache until MaxCacheMemoryMB is exceeded, then evicted least recently used first.
+ */
+UCLASS(Blueprintable)
+class TERRAFORGE_API ATerrainChunkManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATerrainChunkManager();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	virtual void Tick(float DeltaTime) override;
+
+	/** Drop every chunk and rebuild around the camera, e.g. after changing noise parameters */
+	UFUNCTION(BlueprintCallable, Category = "TerraForge|Chunks")
+	void RegenerateAllChunks();
+
+	/** Number of chunks currently built, shown or cached */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "TerraForge|Chunks")
+	int32 GetNumLoadedChunks() const { return Chunks.Num(); }
+
+	/** CPU-side memory used by built chunks in megabytes */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "TerraForge|Chunks")
+	float GetChunkMemoryMB() const { return static_cast<float>(TotalChunkMemory) / (1024.0f * 1024.0f); }
+
+	/** Root the chunk meshes are attached to */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USceneComponent* Root;
+
+	// Streaming parameters
+
+	/** Actor whose location drives streaming. Uses the player pawn (the free camera) when empty */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks")
+	AActor* StreamingSource;
+
+	/** Number of quads along each side of a chunk */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (ClampMin = "4", ClampMax = "256"))
+	int32 ChunkQuads = 64;
+
+	/** Radius around the camera, in chunks, that is kept built and visible */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 LoadRadius = 6;
+
+	/** Memory cap for all built chunks. Hidden chunks are evicted least recently used first once it is exceeded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (ClampMin = "1"))
+	int32 MaxCacheMemoryMB = 256;
+
+	/** Chunk builds allowed to run on the task system at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 MaxConcurrentBuilds = 8;
+
+	/** Finished chunks handed to their mesh components per frame, to bound game thread cost */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (ClampMin = "1", ClampMax = "64"))
+	int32 MaxChunkAppliesPerFrame = 2;
+
+	/**
+	 * Draw chunks with UTerrainHeightfieldComponent, storing a 16-bit height, a packed normal and a color per vertex (8 bytes)
+	 * instead of a full procedural mesh vertex. Lets far more chunks stay resident under MaxCacheMemoryMB
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks")
+	bool bCompactVertices = false;
+
+	/** Keep generated heights and normals on disk, keyed by the seed, noise parameters and chunk, so later runs skip noise evaluation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks")
+	bool bUseDiskCache = true;
+
+	/** Folder for cached chunks. Empty uses Saved/TerraForge/ChunkCache */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks", meta = (EditCondition = "bUseDiskCache"))
+	FString DiskCacheDirectory;
+
+	// Collision parameters
+
+	/** Collision built for chunks near CollisionSources. Simplified cooks a coarser grid, which is much cheaper than the full mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision")
+	ETerraCollisionMode CollisionMode = ETerraCollisionMode::FullMesh;
+
+	/** Render quads per collision quad along each axis */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision", meta = (ClampMin = "1", ClampMax = "64", EditCondition = "CollisionMode == ETerraCollisionMode::Simplified"))
+	int32 CollisionGridStep = 4;
+
+	/** Radius in chunks around the streaming source and each of CollisionSources that gets collision. Chunks further away are never cooked */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision", meta = (ClampMin = "0", ClampMax = "64"))
+	int32 CollisionRadius = 1;
+
+	/** Physics actors besides the streaming source that need collision under them, e.g. vehicles or simulated props */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Collision")
+	TArray<AActor*> CollisionSources;
+
+	/** Material applied to every chunk */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Chunks")
+	UMaterialInterface* TerrainMaterial;
+
+	// Terrain generation parameters, matching AProceduralTerrainActor
+
+	/** Size of each grid square in Unreal units */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "1.0", ClampMax = "1000.0"))
+	float GridSize = 100.0f;
+
+	/** Maximum height of terrain features */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "0.0", ClampMax = "10000.0"))
+	float MaxHeight = 2000.0f;
+
+	/** Noise scale for terrain generation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "0.1", ClampMax = "1000.0"))
+	float NoiseScale = 100.0f;
+
+	/** Number of octaves for noise detail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 Octaves = 4;
+
+	/** Persistence of noise (amplitude multiplier per octave) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float Persistence = 0.5f;
+
+	/** Lacunarity of noise (frequency multiplier per octave) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "1.0", ClampMax = "4.0"))
+	float Lacunarity = 2.0f;
+
+	/** How noise octaves are combined: fBm, ridged, billow or domain-warped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	ETerraFractalMode FractalMode = ETerraFractalMode::FBM;
+
+	/** Largest domain warp offset, in noise cells */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (ClampMin = "0.0", ClampMax = "4.0", EditCondition = "FractalMode == ETerraFractalMode::DomainWarp"))
+	float WarpStrength = 1.0f;
+
+	/**
+	 * Heightmap baked by TerraBake (.tfheights) read instead of the noise when set. Only the tiles under chunks being built are mapped and decoded,
+	 * and the terrain is clamped to the heightmap's edge beyond its extent
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain", meta = (FilePathFilter = "tfheights"))
+	FFilePath HeightmapFile;
+
+	/** Random seed for terrain generation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	int32 RandomSeed = 12345;
+
+	/** Use Simplex noise instead of Perlin noise */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	bool bUseSimplexNoise = false;
+
+	/** Noise hashing backend. IntegerHash avoids the repeat every 256 * NoiseScale units that unbounded worlds would otherwise show */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	ETerraNoiseHash NoiseHashMode = ETerraNoiseHash::IntegerHash;
+
+	/** Shade chunks with normals from the analytic noise gradient instead of height differences */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Terrain")
+	bool bAnalyticNormals = false;
+
+	/** Droplet erosion run on each chunk as it is built. Droplets are placed by world tile, so neighbouring chunks erode their shared edges identically */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	FTerraHydraulicErosionParams HydraulicErosion;
+
+	/** Talus erosion run on each chunk after the droplets. Always settled on the build worker before the chunk appears, so bProgressive is ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	FTerraThermalErosionParams ThermalErosion;
+
+	/** Grass, rock, snow and sand weights written to the chunk vertex colors. Chunks read the climate at their world position, so biomes run on across chunk edges */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Biome")
+	FTerraBiomeParams Biome;
+
+private:
+	/** Chunk build finished on a worker thread */
+	struct FCompletedChunk
+	{
+		FIntPoint Coord;
+
+		/** Render section packed on the worker, in buffers from the arena */
+		FProcMeshSection Section;
+
+		/** Packed instead of Section with bCompactVertices */
+		TSharedPtr<FTerrainCompactMesh, ESPMode::ThreadSafe> CompactMesh;
+
+		TArray<FVector> CollisionVertices;
+		TArray<int32> CollisionTriangles;
+	};
+
+	/** State shared with in-flight builds, which may outlive the actor. Replaced when all chunks are dropped */
+	struct FChunkBuildResults
+	{
+		TQueue<FCompletedChunk, EQueueMode::Mpsc> Completed;
+		std::atomic<bool> bCancelled{ false };
+	};
+
+	/** Get the location streaming is centred on */
+	bool GetStreamingLocation(FVector& OutLocation) const;
+
+	/** Chunk containing a world location */
+	FIntPoint WorldToChunk(const FVector& WorldLocation) const;
+
+	/** Whether a chunk lies inside the load radius around a centre chunk */
+	bool IsChunkInRange(const FIntPoint& Coord, const FIntPoint& Center) const;
+
+	/** Show chunks in range, hide the rest and queue missing chunks nearest first */
+	void UpdateDesiredChunks(const FIntPoint& Center);
+
+	/** Start queued builds up to MaxConcurrentBuilds */
+	void LaunchPendingBuilds();
+
+	/** Hand finished builds to mesh components, up to MaxChunkAppliesPerFrame */
+	void ApplyCompletedChunks();
+
+	/** Evict hidden chunks least recently used first until under MaxCacheMemoryMB */
+	void EnforceMemoryCap();
+
+	/** Make a chunk visible or hidden */
+	void SetChunkVisible(FTerrainChunk& Chunk, bool bVisible);
+
+	/** Whether a visible chunk lies within CollisionRadius of a collision source */
+	bool WantsCollision(const FIntPoint& Coord, const FTerrainChunk& Chunk) const;
+
+	/** Recompute the chunks around collision sources and cook or drop collision where that changed */
+	void UpdateChunkCollision();
+
+	/** Cook or drop one chunk's collision */
+	void SetChunkCollision(FTerrainChunk& Chunk, bool bCollision);
+
+	/** Take a mesh component from the pool or create one */
+	UProceduralMeshComponent* AcquireMesh();
+
+	/** Take a heightfield component from the pool or create one */
+	UTerrainHeightfieldComponent* AcquireHeightfield();
+
+	/** Clear a chunk's mesh and return it to the pool */
+	void ReleaseChunk(FTerrainChunk& Chunk);
+
+	/** Snapshot of the settings for one chunk */
+	FTerrainBuildSettings MakeChunkSettings(const FIntPoint& Coord) const;
+
+	// Built chunks by chunk coordinate
+	UPROPERTY(Transient)
+	TMap<FIntPoint, FTerrainChunk> Chunks;
+
+	// Mesh components of evicted chunks, reused by new chunks
+	UPROPERTY(Transient)
+	TArray<UProceduralMeshComponent*> MeshPool;
+
+	// Heightfield components of evicted compact chunks
+	UPROPERTY(Transient)
+	TArray<UTerrainHeightfieldComponent*> HeightfieldPool;
+
+	// Missing chunks in range, nearest first
+	TArray<FIntPoint> RequestQueue;
+
+	// Chunks with a build in flight
+	TSet<FIntPoint> PendingChunks;
+
+	// Results of in-flight builds
+	TSharedPtr<FChunkBuildResults, ESPMode::ThreadSafe> BuildResults;
+
+	// Build and section buffers recycled between chunks, kept across regenerations
+	TSharedPtr<FTerrainMeshArena, ESPMode::ThreadSafe> MeshArena;
+
+	// Chunk files read and written by the builds, null when bUseDiskCache is off
+	TSharedPtr<const FTerrainChunkDiskCache, ESPMode::ThreadSafe> DiskCache;
+
+	// HeightmapFile opened by RegenerateAllChunks, null when none is set
+	TSharedPtr<const FTerrainHeightmapFile, ESPMode::ThreadSafe> Heightmap;
+
+	// Seeded noise shared by every chunk
+	FTerraNoiseSampler Sampler;
+
+	// Chunk the camera was in when the desired set was last updated
+	FIntPoint CenterChunk = FIntPoint(TNumericLimits<int32>::Max(), TNumericLimits<int32>::Max());
+
+	// Chunks containing the streaming source and each collision source, as of the last collision update
+	TArray<FIntPoint> CollisionCenters;
+
+	// Sum of MemoryBytes over all chunks
+	int64 TotalChunkMemory = 0;
+
+	// Whether chunk collision must be re-evaluated even if no collision source changed chunk
+	bool bCollisionDirty = true;
+
+	// Whether the desired set must be recomputed even if the camera stays in its chunk
+	bool bStreamingDirty = true;
+
+	// Whether the over-budget warning was already logged
+	bool bWarnedOverBudget = false;
+};
@@ -0,0 +1,154 @@
+// TerraForge - Procedural World Generator
+// Erosion passes over generated height grids
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainErosion.generated.h"
+
+struct FTerrainBuildSettings;
+
+/**
+ * Particle-based hydraulic erosion. Droplets run downhill, picking up sediment while they speed up and dropping it as they slow down or evaporate.
+ * Lengths and heights are measured in grid cells, so a setting erodes the same way at any GridSize and MaxHeight ratio.
+ */
+USTRUCT(BlueprintType)
+struct TERRAFORGE_API FTerraHydraulicErosionParams
+{
+	GENERATED_BODY()
+
+	/** Run the pass on every built height grid */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	bool bEnabled = false;
+
+	/** Droplets simulated per grid cell. Cost scales linearly with it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "16.0", EditCondition = "bEnabled"))
+	float DropletsPerCell = 1.0f;
+
+	/** Steps a droplet takes before it is dropped, one cell per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "1", ClampMax = "64", EditCondition = "bEnabled"))
+	int32 MaxLifetime = 30;
+
+	/** How much a droplet keeps its direction instead of following the slope */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float Inertia = 0.05f;
+
+	/** Sediment a droplet can carry per unit of speed, water and height drop */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", EditCondition = "bEnabled"))
+	float SedimentCapacity = 4.0f;
+
+	/** Capacity on flat ground, so droplets still carve shallow slopes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", EditCondition = "bEnabled"))
+	float MinSedimentCapacity = 0.01f;
+
+	/** Fraction of the free capacity eroded per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float ErodeSpeed = 0.3f;
+
+	/** Fraction of the excess sediment deposited per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float DepositSpeed = 0.3f;
+
+	/** Fraction of a droplet's water lost per step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float EvaporateSpeed = 0.01f;
+
+	/** Speed gained per cell of height drop */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", EditCondition = "bEnabled"))
+	float Gravity = 4.0f;
+
+	/** Mixed with the terrain seed and the world tile to place droplets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (EditCondition = "bEnabled"))
+	int32 Seed = 0;
+};
+
+/**
+ * Thermal erosion: material slides off every slope steeper than the talus angle onto its lower neighbours until the slopes settle.
+ * Much cheaper than droplets, it rounds off spikes and cliffs into scree slopes. Heights are compared in cell units like FTerraHydraulicErosionParams
+ */
+USTRUCT(BlueprintType)
+struct TERRAFORGE_API FTerraThermalErosionParams
+{
+	GENERATED_BODY()
+
+	/** Run the pass on every built height grid, after hydraulic erosion */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion")
+	bool bEnabled = false;
+
+	/** Relaxation steps. Material moves at most one cell per step, so longer slopes need more of them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "1", ClampMax = "1000", EditCondition = "bEnabled"))
+	int32 Iterations = 50;
+
+	/** Steepest slope that holds, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "89.0", EditCondition = "bEnabled"))
+	float TalusAngle = 35.0f;
+
+	/** Fraction of the height above the talus slope moved per step. Lower values settle more smoothly but need more steps */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bEnabled"))
+	float Rate = 0.5f;
+
+	/**
+	 * Show the mesh straight away and run the steps over the following frames on the task system, moving the render vertices after each slice
+	 * and rebuilding collision after the last one.
+	 * Only used by AProceduralTerrainActor without quadtree LOD; the result is the same as running every step up front
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (EditCondition = "bEnabled"))
+	bool bProgressive = false;
+
+	/** Time one progressive slice may spend on steps before its mesh is rebuilt */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TerraForge|Erosion", meta = (ClampMin = "0.1", ClampMax = "100.0", EditCondition = "bEnabled && bProgressive"))
+	float SliceMilliseconds = 4.0f;
+};
+
+/**
+ * Erosion passes that run on the halo height grid between FTerrainMeshBuilder::GenerateHeights and the normals.
+ * Results depend only on the settings, never on the number of worker threads.
+ */
+struct TERRAFORGE_API FTerrainErosion
+{
+	/**
+	 * Run Settings.HydraulicErosion on a halo height grid.
+	 * The world is split into tiles of 64 by 64 cells that each simulate their own droplets within a 32 cell halo around the tile, starting
+	 * from the un-eroded heights of their region. Missing tiles run in parallel, and their height changes are added up in world tile order.
+	 * Droplets are placed by world tile, so chunks that share cells erode them exactly the same way, edges included.
+	 * A grid needs every tile whose halo reaches it, up to nine for a 64 quad chunk, so the changes are kept in a process-wide cache
+	 * of the 256 most recently used tiles and each tile is simulated once rather than by every chunk around it
+	 * @return Number of droplets simulated, which leaves out the tiles taken from the cache
+	 */
+	static int32 ApplyHydraulic(const FTerrainBuildSettings& Settings, TArray<float>& Heights);
+
+	/** Drop every tile kept by ApplyHydraulic, so the next call simulates all of its tiles again */
+	static void EmptyTileCache();
+
+	/** Whether ApplyThermal can run on grids built with these settings: a positive height range and grid size */
+	static bool CanApplyThermal(const FTerrainBuildSettings& Settings);
+
+	/**
+	 * Run all of Settings.ThermalErosion on a halo height grid so that it matches any other grid over the cells they share.
+	 * Material moves at most one cell per step, so the steps run on a source grid padded by Iterations cells on each side,
+	 * sampled and hydraulically eroded like the grid itself, and only the grid's own cells are copied back. Nothing stays fixed,
+	 * so neighbouring chunks meet exactly; the cost grows with the padding, about (Width + 2 * Iterations) squared cells per step
+	 */
+	static void ApplyThermalSeamless(const FTerrainBuildSettings& Settings, TArray<float>& Heights);
+
+	/** Settings of the padded source grid that ApplyThermalSeamless relaxes for a grid built with Settings */
+	static FTerrainBuildSettings MakeThermalSourceSettings(const FTerrainBuildSettings& Settings);
+
+	/** Sample the padded source grid for Settings, with Settings.HydraulicErosion already applied */
+	static void SampleThermalSource(const FTerrainBuildSettings& Settings, TArray<float>& OutSource);
+
+	/** Copy the cells of a grid built with Settings out of its relaxed padded source grid */
+	static void CopyThermalResult(const FTerrainBuildSettings& Settings, const TArray<float>& Source, TArray<float>& Heights);
+
+	/**
+	 * Run up to MaxIterations steps of Settings.ThermalErosion on a halo height grid, usually a source grid from SampleThermalSource
+	 * relaxed with the settings from MakeThermalSourceSettings.
+	 * Each step is a stencil reading Heights and writing Scratch, after which the two swap, so no cell ever sees a half-updated neighbour.
+	 * Rows are split into bands across worker threads and each row is processed four cells at a time. Only the outer ring stays fixed,
+	 * and running the steps in several calls gives the same heights as running them in one
+	 * @param Scratch - Second buffer, resized as needed; may be kept between calls to avoid reallocating it
+	 * @param TimeBudgetSeconds - Stop after the step that uses up this much time; zero runs every step
+	 * @return Number of steps run, zero when CanApplyThermal is false. Heights always holds the result
+	 */
+	static int32 ApplyThermal(const FTerrainBuildSettings& Settings, TArray<float>& Heights, TArray<float>& Scratch, int32 MaxIterations, double TimeBudgetSeconds = 0.0);
+};
@@ -0,0 +1,38 @@
+// TerraForge - Procedural World Generator
+// Render-only component drawing a terrain grid from compact vertices
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+#include "TerrainMeshBuilder.h"
+#include "TerrainHeightfieldComponent.generated.h"
+
+/**
+ * Draws one FTerrainCompactMesh through FTerrainCompactVertexFactory, at 8 bytes per vertex instead of the
+ * full position, normal, tangent, color and UV set a procedural mesh section stores. Has no collision of its own.
+ */
+UCLASS(ClassGroup = (TerraForge), meta = (BlueprintSpawnableComponent))
+class TERRAFORGE_API UTerrainHeightfieldComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTerrainHeightfieldComponent(const FObjectInitializer& ObjectInitializer);
+
+	/** Replace the drawn mesh. The data is shared with the render thread and must not change afterwards */
+	void SetMeshData(TSharedPtr<const FTerrainCompactMesh, ESPMode::ThreadSafe> InMeshData);
+
+	/** Stop drawing and drop the mesh */
+	void ClearMeshData();
+
+	const TSharedPtr<const FTerrainCompactMesh, ESPMode::ThreadSafe>& GetMeshData() const { return MeshData; }
+
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual int32 GetNumMaterials() const override { return 1; }
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	// Mesh shared with the scene proxy
+	TSharedPtr<const FTerrainCompactMesh, ESPMode::ThreadSafe> MeshData;
+};
@@ -0,0 +1,182 @@
+// TerraForge - Procedural World Generator
+// Memory-mapped tiled heightmap files
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainTypes.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Size and placement of the tiles in a heightmap file.
+ * Tiles hold (TileQuads + 1)^2 samples and share their last row and column with the next tile, like the .r16 tiles written by TerraBake.
+ */
+struct TERRAFORGE_API FTerrainHeightmapLayout
+{
+	/** Quads per tile along each axis */
+	int32 TileQuads = 512;
+
+	/** Number of tiles along X and Y */
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+
+	/** World units between samples */
+	float GridSize = 100.0f;
+
+	/** Largest layout accepted by the reader and writer, so sample and tile counts stay well inside int32 */
+	static constexpr int32 MaxTileQuads = 4096;
+	static constexpr int32 MaxQuadsPerAxis = 1 << 20;
+	static constexpr int32 MaxTiles = 1 << 20;
+
+	int32 GetTileSamples() const { return TileQuads + 1; }
+	int32 GetNumTiles() const { return TilesX * TilesY; }
+
+	/** Whether every size is positive and within the limits above. Checked in 64 bits, so any header can be tested before its products are used */
+	bool IsValid() const
+	{
+		return TileQuads > 0 && TileQuads <= MaxTileQuads && TilesX > 0 && TilesY > 0 && GridSize > 0.0f
+			&& static_cast<int64>(TilesX) * TileQuads <= MaxQuadsPerAxis && static_cast<int64>(TilesY) * TileQuads <= MaxQuadsPerAxis
+			&& static_cast<int64>(TilesX) * TilesY <= MaxTiles;
+	}
+};
+
+/**
+ * Index entry of one tile, as stored in the file
+ */
+struct FTerrainHeightmapTileEntry
+{
+	/** Byte offset of the tile data from the start of the file */
+	uint64 Offset = 0;
+
+	/** Stored bytes, compressed or not */
+	uint32 Size = 0;
+
+	/** ETerraHeightmapCodec the tile was stored with; None when compression did not make it smaller */
+	uint32 Codec = 0;
+};
+
+/**
+ * One decoded tile. Uncompressed tiles point straight into the mapped file; compressed tiles own their decoded samples
+ */
+class TERRAFORGE_API FTerrainHeightmapTile
+{
+public:
+	FTerrainHeightmapTile() = default;
+	~FTerrainHeightmapTile();
+
+	/** Normalized heights times 65535, row by row */
+	TConstArrayView<uint16> GetSamples() const { return Samples; }
+
+private:
+	friend class FTerrainHeightmapFile;
+
+	// File the region was mapped from, kept open for as long as the tile lives. Declared first so it is released after Region
+	TSharedPtr<IMappedFileHandle, ESPMode::ThreadSafe> Handle;
+
+	// Mapping kept open for zero-copy tiles
+	TUniquePtr<IMappedFileRegion> Region;
+
+	// Storage for decompressed tiles
+	TArray<uint16> Decoded;
+
+	TConstArrayView<uint16> Samples;
+};
+
+/**
+ * Read-only view of a tiled heightmap file written by FTerrainHeightmapWriter.
+ * The file is a header, an index with the offset, size and codec of every tile, and the tiles themselves.
+ * Only the header and index are read on open; tiles are mapped and decoded the first time a sample needs them, and the most recent ones are kept.
+ * All functions can be called from any thread.
+ */
+class TERRAFORGE_API FTerrainHeightmapFile
+{
+public:
+	/**
+	 * Open and validate a heightmap file
+	 * @param MaxCachedTiles - Decoded tiles kept in memory before the least recently used one is dropped
+	 * @return Null if the file is missing or invalid
+	 */
+	static TSharedPtr<const FTerrainHeightmapFile, ESPMode::ThreadSafe> Open(const FString& Path, int32 MaxCachedTiles = 64);
+
+	~FTerrainHeightmapFile();
+
+	const FTerrainHeightmapLayout& GetLayout() const { return Layout; }
+
+	/** Tile at (TileX, TileY), mapped or decoded on a cache miss. Null if the tile is out of range or corrupt. The tile stays readable after the file is released */
+	TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> GetTile(int32 TileX, int32 TileY) const;
+
+	/** Heights between 0 and 1 at world positions, bilinear between samples and clamped at the edges. Matches FTerraNoiseProgram::Evaluate */
+	void Evaluate(const float* X, const float* Y, int32 Count, float* Out) const;
+
+	/** Heights for rows of a grid laid out like FTerraNoiseSampler::NoiseGridRows */
+	void EvaluateGridRows(const FVector2D& Origin, const FVector2D& Step, int32 Width, int32 FirstRow, int32 NumRows, TArrayView<float> Out) const;
+
+private:
+	/** Tiles fetched during one Evaluate call, so the cache lock is taken once per tile rather than per sample */
+	struct FTileLookup;
+
+	FTerrainHeightmapFile() = default;
+
+	/** Tile from the cache, loading it on a miss */
+	TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> FindOrLoadTile(int32 TileIndex) const;
+
+	/** Map and decode one tile */
+	TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe> LoadTile(int32 TileIndex) const;
+
+	/** Bilinear sample at a world position */
+	float Sample(FTileLookup& Lookup, double WorldX, double WorldY) const;
+
+	FString Path;
+	FTerrainHeightmapLayout Layout;
+	TArray<FTerrainHeightmapTileEntry> Index;
+
+	// Shared with every zero-copy tile, whose regions must be unmapped before the handle closes
+	TSharedPtr<IMappedFileHandle, ESPMode::ThreadSafe> Handle;
+
+	// Decoded tiles by index, most recently used last
+	mutable FCriticalSection CacheLock;
+	mutable TArray<TPair<int32, TSharedPtr<const FTerrainHeightmapTile, ESPMode::ThreadSafe>>> CachedTiles;
+	int32 MaxCachedTiles = 64;
+};
+
+/**
+ * Writes a tiled heightmap file. Tiles may be written in any order and from several threads at once;
+ * they are compressed on the calling thread and appended under a lock, and the index is written by Close.
+ */
+class TERRAFORGE_API FTerrainHeightmapWriter
+{
+public:
+	FTerrainHeightmapWriter() = default;
+	~FTerrainHeightmapWriter();
+
+	/** Start writing to a temporary file next to Path */
+	bool Open(const FString& InPath, const FTerrainHeightmapLayout& InLayout, ETerraHeightmapCodec InCodec);
+
+	/**
+	 * Encode and append one tile
+	 * @param Samples - GetTileSamples()^2 normalized heights times 65535, row by row
+	 */
+	bool WriteTile(int32 TileX, int32 TileY, TConstArrayView<uint16> Samples);
+
+	/** Write the header and index and move the file into place. Fails if any tile is missing */
+	bool Close();
+
+	/** Bytes of tile data written so far */
+	int64 GetTileBytes() const { return TileBytes; }
+
+private:
+	FString Path;
+	FString TempPath;
+	FTerrainHeightmapLayout Layout;
+	ETerraHeightmapCodec Codec = ETerraHeightmapCodec::None;
+	TUniquePtr<FArchive> Writer;
+
+	// Index written by Close; offsets stay zero until a tile is written
+	TArray<FTerrainHeightmapTileEntry> Index;
+
+	int64 TileBytes = 0;
+	bool bFailed = false;
+	FCriticalSection WriteLock;
+};
@@ -0,0 +1,59 @@
+// TerraForge - Procedural World Generator
+// Pooled mesh buffers reused across terrain regenerations and chunks
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+#include "TerrainMeshBuilder.h"
+
+/**
+ * Thread-safe pool of terrain build buffers and packed mesh sections.
+ * Buffers keep their allocations between uses, so once the pool is warm, rebuilding meshes of the same size does not allocate.
+ * Owned through a shared pointer so builds still in flight can return their buffers after the owner is gone.
+ */
+class TERRAFORGE_API FTerrainMeshArena : public TSharedFromThis<FTerrainMeshArena, ESPMode::ThreadSafe>
+{
+public:
+	/** @param InMaxPooled - Buffers of each kind kept for reuse; extra returns are freed */
+	explicit FTerrainMeshArena(int32 InMaxPooled);
+	~FTerrainMeshArena();
+
+	/** Build buffers that go back to the pool when the last reference is dropped, on any thread */
+	TSharedRef<FTerrainMeshData, ESPMode::ThreadSafe> AcquireMeshData();
+
+	/** Take an empty mesh section whose arrays may already have capacity */
+	FProcMeshSection AcquireSection();
+
+	/** Return a section's buffers for reuse */
+	void ReleaseSection(FProcMeshSection&& Section);
+
+	/**
+	 * Give a mesh component a packed section without copying it. The component's previous buffers for that section are
+	 * moved back into InOutSection, ready for ReleaseSection. Game thread only
+	 */
+	static void InstallSection(UProceduralMeshComponent* Mesh, int32 SectionIndex, FProcMeshSection& InOutSection);
+
+	/** Bytes held by pooled buffers */
+	int64 GetPooledBytes() const;
+
+private:
+	void ReleaseMeshData(FTerrainMeshData* Data);
+
+	static int64 GetAllocatedSize(const FTerrainMeshData& Data);
+	static int64 GetAllocatedSize(const FProcMeshSection& Section);
+
+	// Upper bound on pooled buffers of each kind
+	int32 MaxPooled;
+
+	mutable FCriticalSection Lock;
+
+	// Free build buffers, owned by the arena
+	TArray<FTerrainMeshData*> FreeMeshData;
+
+	// Free section buffers
+	TArray<FProcMeshSection> FreeSections;
+
+	// Sum of the allocations in FreeMeshData and FreeSections
+	int64 PooledBytes = 0;
+};
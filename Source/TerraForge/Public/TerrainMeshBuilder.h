@@ -0,0 +1,201 @@
+// TerraForge - Procedural World Generator
+// Thread-safe terrain mesh building
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+#include "TerraNoiseSampler.h"
+#include "TerrainTopologyCache.h"
+#include "TerrainCompactVertexFactory.h"
+#include "TerrainTypes.h"
+#include "TerrainErosion.h"
+#include "TerrainBiome.h"
+#include <atomic>
+
+struct FTerraNoiseProgram;
+class FTerrainHeightmapFile;
+
+/**
+ * Snapshot of everything needed to build one terrain mesh.
+ * Taken on the game thread so the build itself never reads the actor.
+ */
+struct TERRAFORGE_API FTerrainBuildSettings
+{
+	/** Number of quads along X */
+	int32 Width = 100;
+
+	/** Number of quads along Y */
+	int32 Height = 100;
+
+	/** Size of each grid square in Unreal units */
+	float GridSize = 100.0f;
+
+	/** Maximum height of terrain features */
+	float MaxHeight = 2000.0f;
+
+	/** World position of the first noise sample, so neighbouring meshes line up */
+	FVector2D NoiseOrigin = FVector2D::ZeroVector;
+
+	/** Noise parameters shared by all samples */
+	FTerraNoiseParams NoiseParams;
+
+	/** Seeded noise to sample */
+	FTerraNoiseSampler Sampler;
+
+	/** Compiled noise graph producing the heights instead of NoiseParams and Sampler, when set */
+	TSharedPtr<const FTerraNoiseProgram, ESPMode::ThreadSafe> HeightProgram;
+
+	/** Baked heightmap the heights are read from instead of evaluating any noise, when set. Takes precedence over HeightProgram */
+	TSharedPtr<const FTerrainHeightmapFile, ESPMode::ThreadSafe> Heightmap;
+
+	/** Fill buffers in row blocks across worker threads */
+	bool bParallel = true;
+
+	/** Collision built alongside the render mesh */
+	ETerraCollisionMode CollisionMode = ETerraCollisionMode::FullMesh;
+
+	/** Render quads per collision quad along each axis with ETerraCollisionMode::Simplified */
+	int32 CollisionGridStep = 4;
+
+	/** Take normals from the analytic noise gradient instead of height differences; also fills FTerrainMeshData::HeightGradientX/Y. Ignored with a HeightProgram or Heightmap */
+	bool bAnalyticNormals = false;
+
+	/** Droplet erosion run on the height grid before normals are calculated. Replaces analytic normals when enabled */
+	FTerraHydraulicErosionParams HydraulicErosion;
+
+	/** Talus erosion run after HydraulicErosion. Build skips it when bProgressive is set, leaving the slices to the caller */
+	FTerraThermalErosionParams ThermalErosion;
+
+	/** Material splat weights written to the vertex colors alongside the vertices */
+	FTerraBiomeParams Biome;
+};
+
+/**
+ * Mesh buffers in the layout expected by UProceduralMeshComponent::CreateMeshSection
+ */
+struct TERRAFORGE_API FTerrainMeshData
+{
+	/** Normalized heights with a one-sample halo ring, (Width + 3) * (Height + 3) samples. See FTerrainMeshBuilder::GetHaloIndex */
+	TArray<float> Heights;
+
+	/** Derivatives of Heights along X and Y per world unit, same layout. Only filled with FTerrainBuildSettings::bAnalyticNormals */
+	TArray<float> HeightGradientX;
+	TArray<float> HeightGradientY;
+
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+	TArray<FColor> VertexColors;
+	TArray<FProcMeshTangent> Tangents;
+
+	/** Coarse collision grid in the same space as Vertices. Only filled with ETerraCollisionMode::Simplified */
+	TArray<FVector> CollisionVertices;
+	TArray<int32> CollisionTriangles;
+
+	/** Shared index buffer Triangles was copied from */
+	TSharedPtr<const FTerrainTopology, ESPMode::ThreadSafe> Topology;
+
+	/** Collision mode of the settings the data was built with, so applying it never mixes in a mode changed while it was building */
+	ETerraCollisionMode CollisionMode = ETerraCollisionMode::FullMesh;
+};
+
+/**
+ * Grid mesh in the 8-byte vertex format drawn by UTerrainHeightfieldComponent.
+ * Immutable once packed, so the game thread and the render thread can share it.
+ */
+struct TERRAFORGE_API FTerrainCompactMesh
+{
+	/** One per grid vertex, row by row */
+	TArray<FTerrainCompactVertex> Vertices;
+
+	/** Grid layout passed to FTerrainCompactVertexFactory */
+	FTerrainCompactVertexFactoryParameters Layout;
+
+	/** Shared index buffer of the grid */
+	TSharedPtr<const FTerrainTopology, ESPMode::ThreadSafe> Topology;
+
+	FBox LocalBounds = FBox(ForceInit);
+
+	int32 GetNumColumns() const { return static_cast<int32>(Layout.NumColumns); }
+
+	/** Local position of a vertex, as the vertex factory reconstructs it */
+	FVector GetPosition(int32 Index) const;
+
+	/** Bytes held by the vertex array */
+	int64 GetAllocatedSize() const { return Vertices.GetAllocatedSize(); }
+};
+
+/**
+ * Builds terrain meshes from FTerrainBuildSettings.
+ * All functions only touch their arguments, so they can run on any thread.
+ */
+struct TERRAFORGE_API FTerrainMeshBuilder
+{
+	/**
+	 * Build the complete mesh
+	 * @param CancelFlag - Optional flag polled between stages; the build stops early once it is set
+	 * @return False if the build was cancelled, in which case OutData is incomplete
+	 */
+	static bool Build(const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData, const std::atomic<bool>* CancelFlag = nullptr);
+
+	/**
+	 * Build the rest of the mesh from the Heights, Normals and Tangents already in OutData, e.g. loaded from FTerrainChunkDiskCache.
+	 * Evaluates no noise
+	 * @return False if the build was cancelled
+	 */
+	static bool BuildFromHeightsAndNormals(const FTerrainBuildSettings& Settings, FTerrainMeshData& OutData, const std::atomic<bool>* CancelFlag = nullptr);
+
+	/** Index of vertex (X, Y) in a halo height grid; X and Y may be -1 or one past the last vertex */
+	static int32 GetHaloIndex(const FTerrainBuildSettings& Settings, int32 X, int32 Y)
+	{
+		return (Y + 1) * (Settings.Width + 3) + X + 1;
+	}
+
+	/**
+	 * Sample normalized heights for every vertex plus one ring around the grid, so border vertices see their neighbours
+	 * @param GradientX, GradientY - Filled with the analytic height gradient when Settings.bAnalyticNormals is set without a HeightProgram or Heightmap, emptied otherwise
+	 */
+	static void GenerateHeights(const FTerrainBuildSettings& Settings, TArray<float>& Heights, TArray<float>& GradientX, TArray<float>& GradientY);
+
+	/**
+	 * Generate vertices, UVs and vertex colors from a halo height grid and its normals in one pass.
+	 * Vertex colors hold the Settings.Biome splat weights, with the climate noise sampled a row at a time, or the normalized height as gray when biomes are off
+	 */
+	static void GenerateVertices(const FTerrainBuildSettings& Settings, const TArray<float>& Heights, const TArray<FVector>& Normals, TArray<FVector>& Vertices, TArray<FVector2D>& UVs, TArray<FColor>& VertexColors);
+
+	/**
+	 * Copy the triangles for the terrain grid from FTerrainTopologyCache
+	 * @return The shared topology the triangles came from
+	 */
+	static TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> GenerateTriangles(const FTerrainBuildSettings& Settings, TArray<int32>& Triangles, ETerrainTopologyVariant Variant = ETerrainTopologyVariant::Grid);
+
+	/**
+	 * Calculate upward normals and +X tangents by central differences on a halo height grid.
+	 * Border vertices use the halo, so neighbouring chunks and patches shade seamlessly.
+	 */
+	static void CalculateNormals(const FTerrainBuildSettings& Settings, const TArray<float>& Heights, TArray<FVector>& Normals, TArray<FProcMeshTangent>& Tangents);
+
+	/** Calculate normals and tangents from analytic height gradients in the halo layout, with no neighbour lookups */
+	static void CalculateNormalsFromGradients(const FTerrainBuildSettings& Settings, const TArray<float>& GradientX, const TArray<float>& GradientY, TArray<FVector>& Normals, TArray<FProcMeshTangent>& Tangents);
+
+	/**
+	 * Sample a collision grid every Settings.CollisionGridStep render vertices, plus the last row and column.
+	 * Without Heights the samples come straight from the noise or heightmap, so this does not need the render height grid and works for any terrain size.
+	 * @param Heights - Optional halo height grid from GenerateHeights to read instead of sampling the noise
+	 */
+	static void GenerateCollision(const FTerrainBuildSettings& Settings, TArray<FVector>& Vertices, TArray<int32>& Triangles, const TArray<float>* Heights = nullptr);
+
+	/**
+	 * Interleave built mesh data into a procedural mesh section, reusing the section's existing allocations.
+	 * Leaves bEnableCollision to the caller.
+	 */
+	static void PackSection(const FTerrainMeshData& Data, FProcMeshSection& OutSection);
+
+	/**
+	 * Quantize a built grid mesh into FTerrainCompactMesh. Heights span [0, MaxHeight] in 16 bits, the same for every chunk so shared edges match, and normals are octahedral.
+	 * Positions and UVs are dropped, since the grid implies them; skirted meshes are not supported
+	 */
+	static void PackCompact(const FTerrainBuildSettings& Settings, const FTerrainMeshData& Data, FTerrainCompactMesh& OutMesh);
+};
@@ -0,0 +1,84 @@
+// TerraForge - Procedural World Generator
+// Quadtree level-of-detail selection and patch building
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainMeshBuilder.h"
+#include <atomic>
+
+/**
+ * One quadtree node. A node at Level covers PatchQuads << Level fine quads per side
+ * and is meshed with PatchQuads quads of GridSize << Level each.
+ */
+struct FTerrainQuadtreeNode
+{
+	int32 Level = 0;
+
+	/** Position in nodes of this level, from the terrain origin */
+	FIntPoint Coord = FIntPoint::ZeroValue;
+
+	bool operator==(const FTerrainQuadtreeNode& Other) const
+	{
+		return Level == Other.Level && Coord == Other.Coord;
+	}
+
+	friend uint32 GetTypeHash(const FTerrainQuadtreeNode& Node)
+	{
+		return HashCombine(::GetTypeHash(Node.Level), ::GetTypeHash(Node.Coord));
+	}
+};
+
+/**
+ * Settings for quadtree terrain, snapshotted on the game thread
+ */
+struct TERRAFORGE_API FTerrainLODSettings
+{
+	/** Noise, height and finest grid size. Width and Height give the terrain extent in fine quads */
+	FTerrainBuildSettings Base;
+
+	/** Quads per patch side, a power of two */
+	int32 PatchQuads = 32;
+
+	/** Number of levels; level 0 is full resolution */
+	int32 NumLevels = 5;
+
+	/** Camera distance below which level 0 is used. Each coarser level doubles it */
+	float LODDistance = 6400.0f;
+
+	/** Depth of the skirt hanging from level 0 patch borders. Each coarser level doubles it */
+	float SkirtDepth = 200.0f;
+
+	/** Blend heights towards the next coarser level near the end of each level's range */
+	bool bMorph = true;
+
+	/** Fraction of a level's range where morphing starts */
+	float MorphStart = 0.7f;
+};
+
+/**
+ * Continuous distance-based quadtree LOD for heightfield terrain.
+ * Patches are joined by skirts, so neighbours at any level difference are crack-free;
+ * optional morphing removes popping when a patch switches level.
+ */
+struct TERRAFORGE_API FTerrainQuadtree
+{
+	/** Camera distance up to which Level is used */
+	static float GetLevelRange(const FTerrainLODSettings& Settings, int32 Level);
+
+	/**
+	 * Select the nodes to draw for a camera position
+	 * @param CameraLocation - Camera position in terrain space
+	 */
+	static void SelectNodes(const FTerrainLODSettings& Settings, const FVector& CameraLocation, TArray<FTerrainQuadtreeNode>& OutNodes);
+
+	/** Build the mesh for one node, in terrain space, with skirts */
+	static void BuildPatch(const FTerrainLODSettings& Settings, const FTerrainQuadtreeNode& Node, const FVector& CameraLocation, FTerrainMeshData& OutData);
+
+	/**
+	 * Build several nodes across worker threads
+	 * @param CancelFlag - Optional flag polled between patches
+	 * @return False if the build was cancelled
+	 */
+	static bool BuildPatches(const FTerrainLODSettings& Settings, TConstArrayView<FTerrainQuadtreeNode> Nodes, const FVector& CameraLocation, TArray<FTerrainMeshData>& OutData, const std::atomic<bool>* CancelFlag = nullptr);
+};
@@ -0,0 +1,111 @@
+// TerraForge - Procedural World Generator
+// Process-wide cache of terrain grid index buffers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Index layouts a terrain grid can use
+ */
+enum class ETerrainTopologyVariant : uint8
+{
+	/** Two triangles per quad */
+	Grid,
+	/** Grid plus a skirt ring hanging from the border, used by quadtree patches */
+	Skirted
+};
+
+/**
+ * Index buffer for one grid size and variant. Immutable once created and shared between meshes.
+ */
+struct TERRAFORGE_API FTerrainTopology
+{
+	/** Quads along X and Y */
+	int32 Width = 0;
+	int32 Height = 0;
+
+	/** Vertices referenced, including skirt vertices */
+	int32 NumVertices = 0;
+
+	/** For Skirted topologies, the grid vertex each skirt vertex hangs from. Skirt vertices follow the grid vertices in this order */
+	TArray<int32> BorderVertices;
+
+	/** Indices when NumVertices fits in 16 bits, halving index memory */
+	TArray<uint16> Indices16;
+
+	/** Indices otherwise */
+	TArray<int32> Indices32;
+
+	bool Is16Bit() const { return Indices32.Num() == 0; }
+	int32 GetNumIndices() const { return Is16Bit() ? Indices16.Num() : Indices32.Num(); }
+
+	/** Expand into the int32 layout taken by CreateMeshSection */
+	void CopyIndices(TArray<int32>& OutIndices) const;
+
+	/** Bytes held by the index and border arrays */
+	int64 GetAllocatedSize() const;
+};
+
+/**
+ * Thread-safe cache of terrain topologies keyed by grid size and variant.
+ * The index list depends only on the grid dimensions, so every chunk, patch or regenerate of the same size shares one copy.
+ * Topologies no mesh references any more are kept up to MaxUnreferenced, least recently used first out,
+ * so sizes passed through while dragging a slider do not stay resident
+ */
+class TERRAFORGE_API FTerrainTopologyCache
+{
+public:
+	/** Unreferenced topologies kept for reuse, on top of those still held by meshes */
+	static constexpr int32 MaxUnreferenced = 8;
+
+	/** Process-wide instance */
+	static FTerrainTopologyCache& Get();
+
+	/** Get the topology for a grid, building it on first use */
+	TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> FindOrCreate(int32 Width, int32 Height, ETerrainTopologyVariant Variant);
+
+	/** Drop all cached topologies. Meshes holding a reference keep theirs alive */
+	void Empty();
+
+	/** Bytes held by all cached topologies */
+	int64 GetAllocatedSize() const;
+
+private:
+	struct FKey
+	{
+		int32 Width;
+		int32 Height;
+		ETerrainTopologyVariant Variant;
+
+		bool operator==(const FKey& Other) const
+		{
+			return Width == Other.Width && Height == Other.Height && Variant == Other.Variant;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(HashCombine(::GetTypeHash(Key.Width), ::GetTypeHash(Key.Height)), ::GetTypeHash(static_cast<uint8>(Key.Variant)));
+		}
+	};
+
+	struct FEntry
+	{
+		TSharedRef<const FTerrainTopology, ESPMode::ThreadSafe> Topology;
+
+		// UseClock value of the last lookup
+		uint64 LastUse;
+	};
+
+	/** Build the index list for a key */
+	static TSharedRef<FTerrainTopology, ESPMode::ThreadSafe> Build(const FKey& Key);
+
+	/** Drop the least recently used topologies only the cache references, down to MaxUnreferenced. Called with Lock held */
+	void EvictUnreferenced();
+
+	// Lookups also update LastUse, so every access takes the lock exclusively; it is held for a map lookup at most
+	mutable FCriticalSection Lock;
+	TMap<FKey, FEntry> Topologies;
+	uint64 UseClock = 0;
+};
@@ -0,0 +1,35 @@
+// TerraForge - Procedural World Generator
+// Shared terrain build types
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainTypes.generated.h"
+
+/**
+ * Physics collision generated for terrain meshes
+ */
+UENUM(BlueprintType)
+enum class ETerraCollisionMode : uint8
+{
+	/** No collision */
+	None,
+	/** Trimesh over every render triangle */
+	FullMesh UMETA(DisplayName = "Full Mesh"),
+	/** Trimesh over a coarser grid taking every CollisionGridStep-th render vertex */
+	Simplified
+};
+
+/**
+ * Compression applied to the tiles of a FTerrainHeightmapFile
+ */
+UENUM(BlueprintType)
+enum class ETerraHeightmapCodec : uint8
+{
+	/** Raw 16-bit samples, read straight from the mapped file */
+	None,
+	/** Delta-filtered samples compressed with LZ4 */
+	LZ4,
+	/** Delta-filtered samples compressed with Oodle */
+	Oodle
+};
@@ -13,10 +13,11 @@ public class TerraForge : ModuleRules
 			"InputCore",
 			"ProceduralMeshComponent",
 			"RenderCore",
-			"RHI"
+			"RHI",
+			"TerraForgeShaders"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json" });
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
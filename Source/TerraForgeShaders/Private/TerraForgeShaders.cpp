@@ -0,0 +1,18 @@
+// TerraForge - Procedural World Generator
+// TerraForge Shaders Module Implementation
+
+#include "TerraForgeShaders.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
+
+void FTerraForgeShadersModule::StartupModule()
+{
+	// Shaders include each other as /TerraForge/..., which resolves to the project's Shaders directory
+	AddShaderSourceDirectoryMapping(TEXT("/TerraForge"), FPaths::Combine(FPaths::ProjectDir(), TEXT("Shaders")));
+}
+
+void FTerraForgeShadersModule::ShutdownModule()
+{
+}
+
+IMPLEMENT_MODULE(FTerraForgeShadersModule, TerraForgeShaders);
@@ -0,0 +1,87 @@
+// TerraForge - Procedural World Generator
+// Terrain Compact Vertex Factory Implementation
+
+#include "TerrainCompactVertexFactory.h"
+#include "MaterialDomain.h"
+#include "MeshBatch.h"
+#include "MeshDrawShaderBindings.h"
+#include "MeshMaterialShader.h"
+
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FTerrainCompactVertexFactoryParameters, "TerrainCompactVF");
+
+/**
+ * Binds the heightfield's grid layout to every mesh material shader using the vertex factory
+ */
+class FTerrainCompactVertexFactoryShaderParameters : public FVertexFactoryShaderParameters
+{
+	DECLARE_TYPE_LAYOUT(FTerrainCompactVertexFactoryShaderParameters, NonVirtual);
+
+public:
+	void Bind(const FShaderParameterMap& ParameterMap)
+	{
+	}
+
+	void GetElementShaderBindings(
+		const FSceneInterface* Scene,
+		const FSceneView* View,
+		const FMeshMaterialShader* Shader,
+		const EVertexInputStreamType InputStreamType,
+		ERHIFeatureLevel::Type FeatureLevel,
+		const FVertexFactory* VertexFactory,
+		const FMeshBatchElement& BatchElement,
+		FMeshDrawSingleShaderBindings& ShaderBindings,
+		FVertexInputStreamArray& VertexStreams) const
+	{
+		const FTerrainCompactVertexFactory* TerrainVertexFactory = static_cast<const FTerrainCompactVertexFactory*>(VertexFactory);
+		ShaderBindings.Add(Shader->GetUniformBufferParameter<FTerrainCompactVertexFactoryParameters>(), TerrainVertexFactory->GetUniformBuffer());
+	}
+};
+
+IMPLEMENT_TYPE_LAYOUT(FTerrainCompactVertexFactoryShaderParameters);
+
+IMPLEMENT_VERTEX_FACTORY_PARAMETER_TYPE(FTerrainCompactVertexFactory, SF_Vertex, FTerrainCompactVertexFactoryShaderParameters);
+
+IMPLEMENT_VERTEX_FACTORY_TYPE(FTerrainCompactVertexFactory, "/TerraForge/Private/TerrainCompactVertexFactory.ush",
+	EVertexFactoryFlags::UsedWithMaterials | EVertexFactoryFlags::SupportsDynamicLighting);
+
+FTerrainCompactVertexFactory::FTerrainCompactVertexFactory(ERHIFeatureLevel::Type InFeatureLevel)
+	: FVertexFactory(InFeatureLevel)
+{
+	FMemory::Memzero(Parameters);
+}
+
+bool FTerrainCompactVertexFactory::ShouldCompilePermutation(const FVertexFactoryShaderPermutationParameters& Parameters)
+{
+	// Project vertex factories cannot add a material usage flag, so chunk materials opt in with "Used with Virtual Heightfield Mesh",
+	// the engine's usage for heightfield geometry, which ordinary materials leave off. Special engine materials such as the default
+	// surface material always compile it, so chunks without a flagged material still have a fallback
+	const FMaterialShaderParameters& Material = Parameters.MaterialParameters;
+	return Material.MaterialDomain == MD_Surface && (Material.bIsUsedWithVirtualHeightfieldMesh || Material.bIsSpecialEngineMaterial)
+		&& IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+}
+
+void FTerrainCompactVertexFactory::SetData(const FVertexBuffer* InVertexBuffer, const FTerrainCompactVertexFactoryParameters& InParameters)
+{
+	check(!IsInitialized());
+	VertexBuffer = InVertexBuffer;
+	Parameters = InParameters;
+}
+
+void FTerrainCompactVertexFactory::InitRHI(FRHICommandListBase& RHICmdList)
+{
+	check(VertexBuffer);
+
+	// Height and normal read as one uint2, color as a normalized float4
+	FVertexDeclarationElementList Elements;
+	Elements.Add(AccessStreamComponent(FVertexStreamComponent(VertexBuffer, STRUCT_OFFSET(FTerrainCompactVertex, Height), sizeof(FTerrainCompactVertex), VET_UShort2), 0));
+	Elements.Add(AccessStreamComponent(FVertexStreamComponent(VertexBuffer, STRUCT_OFFSET(FTerrainCompactVertex, Color), sizeof(FTerrainCompactVertex), VET_Color), 1));
+	InitDeclaration(Elements);
+
+	UniformBuffer = TUniformBufferRef<FTerrainCompactVertexFactoryParameters>::CreateUniformBufferImmediate(Parameters, UniformBuffer_MultiFrame);
+}
+
+void FTerrainCompactVertexFactory::ReleaseRHI()
+{
+	UniformBuffer.SafeRelease();
+	FVertexFactory::ReleaseRHI();
+}
@@ -0,0 +1,15 @@
+// TerraForge - Procedural World Generator
+// Module holding TerraForge's shader types, loaded before shaders are compiled
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+class FTerraForgeShadersModule : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+};
@@ -0,0 +1,70 @@
+// TerraForge - Procedural World Generator
+// Vertex factory drawing heightfield grids from 8-byte vertices
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderResource.h"
+#include "VertexFactory.h"
+#include "ShaderParameterMacros.h"
+
+/**
+ * One heightfield vertex. X, Y and the UV follow from the vertex index in the grid, so only the height, the normal and the color are stored
+ */
+struct FTerrainCompactVertex
+{
+	/** Height quantized between FTerrainCompactVertexFactoryParameters::HeightOffset and HeightOffset + 65535 * HeightScale */
+	uint16 Height;
+
+	/** Octahedral unit normal, 8 bits per axis */
+	uint8 NormalX;
+	uint8 NormalY;
+
+	FColor Color;
+};
+static_assert(sizeof(FTerrainCompactVertex) == 8, "Compact terrain vertices are meant to be 8 bytes");
+
+/**
+ * Grid layout shared by every vertex of one heightfield
+ */
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FTerrainCompactVertexFactoryParameters, TERRAFORGESHADERS_API)
+	/** Vertices per row */
+	SHADER_PARAMETER(uint32, NumColumns)
+	/** Distance between neighbouring vertices in local units */
+	SHADER_PARAMETER(float, GridSize)
+	/** Local height per quantized height step */
+	SHADER_PARAMETER(float, HeightScale)
+	/** Local height of quantized height 0 */
+	SHADER_PARAMETER(float, HeightOffset)
+	/** UV per vertex step along X and Y */
+	SHADER_PARAMETER(FVector2f, UVScale)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+
+/**
+ * Vertex factory reading FTerrainCompactVertex from a single stream and rebuilding position, UV and tangents in the vertex shader.
+ * One instance per heightfield, since the grid layout lives in its uniform buffer.
+ */
+class TERRAFORGESHADERS_API FTerrainCompactVertexFactory : public FVertexFactory
+{
+	DECLARE_VERTEX_FACTORY_TYPE(FTerrainCompactVertexFactory);
+
+public:
+	explicit FTerrainCompactVertexFactory(ERHIFeatureLevel::Type InFeatureLevel);
+
+	static bool ShouldCompilePermutation(const FVertexFactoryShaderPermutationParameters& Parameters);
+
+	/** Set the vertex stream and grid layout. Call before InitResource */
+	void SetData(const FVertexBuffer* InVertexBuffer, const FTerrainCompactVertexFactoryParameters& InParameters);
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override;
+	virtual void ReleaseRHI() override;
+
+	FRHIUniformBuffer* GetUniformBuffer() const { return UniformBuffer.GetReference(); }
+
+private:
+	/** Stream of FTerrainCompactVertex */
+	const FVertexBuffer* VertexBuffer = nullptr;
+
+	FTerrainCompactVertexFactoryParameters Parameters;
+	TUniformBufferRef<FTerrainCompactVertexFactoryParameters> UniformBuffer;
+};
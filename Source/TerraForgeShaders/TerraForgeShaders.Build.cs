@@ -0,0 +1,17 @@
+using UnrealBuildTool;
+
+public class TerraForgeShaders : ModuleRules
+{
+	public TerraForgeShaders(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] {
+			"Core",
+			"CoreUObject",
+			"Engine",
+			"RenderCore",
+			"RHI"
+		});
+	}
+}